@@ -0,0 +1,166 @@
+// CSV parsing throughput benchmark.
+// Usage: bench_csv [size_mb=1024] [path=bench_traffic.csv]
+// Writes a synthetic traffic_density.csv of the requested size, then times the
+// legacy getline/stringstream parser against the memory-mapped zero-copy parser
+// and the multi-threaded chunked loader (1 thread and all cores), then repeats the
+// zero-copy and chunked runs on a gzip-compressed copy of the same data.
+#include <chrono>
+#include <cstdio> // For std::remove
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <zlib.h>
+#include "thread_pool.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    // Writes rows until the file reaches target_bytes; returns the bytes written.
+    std::size_t write_synthetic_csv(const std::string &path, std::size_t target_bytes)
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+        std::size_t written = 0;
+        std::string line;
+        for (long long i = 0; written < target_bytes; ++i)
+        {
+            line = std::to_string(i / 64) + "," + std::to_string(i % 64) + "," +
+                   std::to_string((i % 100) / 100.0) + "," + std::to_string(30.0 + (i % 41)) + "," +
+                   std::to_string(i % 37) + "\n";
+            out << line;
+            written += line.size();
+        }
+        return written;
+    }
+
+    // The pre-mmap implementation: getline per line, stringstream per line, string per field.
+    std::size_t legacy_parse(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::size_t rows = 0;
+        while (std::getline(file, line))
+        {
+            Utils::CsvRow row;
+            std::stringstream line_stream(line);
+            std::string field;
+            while (std::getline(line_stream, field, ','))
+            {
+                row.fields.push_back(Utils::trim_whitespace(field));
+            }
+            rows++;
+        }
+        return rows;
+    }
+
+    // Gzip-compresses `path` into `gz_path`; returns the compressed size in bytes.
+    std::size_t write_gzip_copy(const std::string &path, const std::string &gz_path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        gzFile out = gzopen(gz_path.c_str(), "wb6");
+        std::string buffer(1 << 20, '\0');
+        while (in.read(&buffer[0], buffer.size()) || in.gcount() > 0)
+        {
+            gzwrite(out, buffer.data(), static_cast<unsigned>(in.gcount()));
+        }
+        gzclose(out);
+        std::ifstream compressed(gz_path, std::ios::binary | std::ios::ate);
+        return static_cast<std::size_t>(compressed.tellg());
+    }
+
+    // Rows parsed by the single-threaded zero-copy path
+    std::size_t count_rows(const std::string &path)
+    {
+        std::size_t rows = 0;
+        TrafficDataPoint point;
+        Utils::for_each_csv_row(path, [&](const Utils::CsvFields &fields)
+                                {
+            if (Utils::parse_traffic_row(fields, point))
+                rows++; });
+        return rows;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t size_mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    std::string path = argc > 2 ? argv[2] : "bench_traffic.csv";
+
+    std::cout << "Generating " << size_mb << " MB of synthetic traffic data at " << path << "..." << std::endl;
+    std::size_t bytes = write_synthetic_csv(path, size_mb * 1024 * 1024);
+    double gigabytes = bytes / 1e9;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t legacy_rows = legacy_parse(path);
+    double legacy_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    std::size_t mapped_rows = 0;
+    long long checksum = 0;
+    TrafficDataPoint point;
+    Utils::for_each_csv_row(path, [&](const Utils::CsvFields &fields)
+                            {
+        if (Utils::parse_traffic_row(fields, point))
+        {
+            mapped_rows++;
+            checksum += point.vehicles_passed;
+        } });
+    double mapped_seconds = seconds_since(start);
+
+    std::cout << "legacy getline parser: " << legacy_rows << " rows, " << legacy_seconds << " s, "
+              << gigabytes / legacy_seconds << " GB/s" << std::endl;
+    std::cout << "mmap zero-copy parser: " << mapped_rows << " typed rows, " << mapped_seconds << " s, "
+              << gigabytes / mapped_seconds << " GB/s (checksum " << checksum << ")" << std::endl;
+    std::cout << "speedup: " << legacy_seconds / mapped_seconds << "x" << std::endl;
+
+    std::size_t cores = ThreadPool::default_thread_count();
+    for (std::size_t threads : {std::size_t(1), cores})
+    {
+        start = std::chrono::steady_clock::now();
+        std::size_t chunked_rows = 0;
+        Utils::for_each_traffic_batch(path, [&](const TrafficDataColumns &batch)
+                                      { chunked_rows += batch.size(); }, false, threads);
+        double chunked_seconds = seconds_since(start);
+        std::cout << "chunked loader, " << threads << " thread(s): " << chunked_rows << " typed rows, "
+                  << chunked_seconds << " s, " << gigabytes / chunked_seconds << " GB/s, speedup "
+                  << legacy_seconds / chunked_seconds << "x" << std::endl;
+        if (threads == cores)
+            break;
+    }
+
+    // Compressed input: throughput is measured in uncompressed bytes per second
+    std::string gz_path = path + ".gz";
+    std::size_t compressed_bytes = write_gzip_copy(path, gz_path);
+    std::cout << "gzip copy: " << compressed_bytes / 1e6 << " MB (ratio "
+              << static_cast<double>(bytes) / compressed_bytes << ":1)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::size_t plain_rows = count_rows(path);
+    double plain_seconds = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    std::size_t gzip_rows = count_rows(gz_path);
+    double gzip_seconds = seconds_since(start);
+    std::cout << "zero-copy parser, plain: " << plain_rows << " rows, " << gigabytes / plain_seconds << " GB/s" << std::endl;
+    std::cout << "zero-copy parser, gzip:  " << gzip_rows << " rows, " << gigabytes / gzip_seconds
+              << " GB/s (" << 100.0 * plain_seconds / gzip_seconds << "% of uncompressed)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::size_t chunked_gzip_rows = 0;
+    Utils::for_each_traffic_batch(gz_path, [&](const TrafficDataColumns &batch)
+                                  { chunked_gzip_rows += batch.size(); }, false, cores);
+    double chunked_gzip_seconds = seconds_since(start);
+    std::cout << "chunked loader, gzip, " << cores << " thread(s): " << chunked_gzip_rows << " rows, "
+              << gigabytes / chunked_gzip_seconds << " GB/s (" << 100.0 * plain_seconds / chunked_gzip_seconds
+              << "% of single-threaded uncompressed)" << std::endl;
+
+    std::remove(gz_path.c_str());
+    std::remove(path.c_str());
+    return 0;
+}
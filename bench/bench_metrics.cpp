@@ -0,0 +1,87 @@
+// Metrics subsystem overhead benchmark.
+// Usage: bench_metrics [vehicles=100000] [ticks=50] [grid=20]
+// Builds a grid network with bidirectional streets and a signalised intersection at
+// every node, fills it with vehicles on random routes, then ticks identical copies with
+// metrics off, on, and on while another thread takes a snapshot every millisecond.
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "network_generator.hpp"
+#include "simulation.hpp"
+
+namespace
+{
+    void setup_grid(Simulation &sim, int grid, int vehicles)
+    {
+        NetworkGenerator::install(sim, NetworkGenerator::make_grid(grid, grid));
+        NetworkGenerator::add_vehicles(sim, vehicles, 1);
+    }
+
+    double time_tick(Simulation &sim)
+    {
+        auto start = std::chrono::steady_clock::now();
+        sim.tick();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const int vehicles = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int ticks = argc > 2 ? std::atoi(argv[2]) : 50;
+    const int grid = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    Simulation off(1), on(1), on_with_reader(1);
+    setup_grid(off, grid, vehicles);
+    setup_grid(on, grid, vehicles);
+    setup_grid(on_with_reader, grid, vehicles);
+    on.set_metrics_enabled(true);
+    on_with_reader.set_metrics_enabled(true);
+
+    // Interleaved so that machine noise affects both runs alike
+    double off_seconds = 0.0, on_seconds = 0.0;
+    for (int t = 0; t < ticks; ++t)
+    {
+        off_seconds += time_tick(off) / ticks;
+        on_seconds += time_tick(on) / ticks;
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<long> snapshots(0);
+    std::shared_ptr<const SimulationMetrics> metrics = on_with_reader.get_metrics();
+    std::thread reader([&]()
+                       {
+                           while (!stop.load())
+                           {
+                               MetricsSnapshot snapshot = metrics->snapshot();
+                               snapshots.fetch_add(snapshot.edges.empty() ? 0 : 1);
+                               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                           } });
+    double reader_seconds = 0.0;
+    for (int t = 0; t < ticks; ++t)
+        reader_seconds += time_tick(on_with_reader) / ticks;
+    stop = true;
+    reader.join();
+
+    const int snapshot_repeats = 100;
+    MetricsSnapshot snapshot;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < snapshot_repeats; ++i)
+        snapshot = on.get_metrics()->snapshot();
+    const double snapshot_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / snapshot_repeats;
+
+    std::cout << vehicles << " vehicles, " << grid << "x" << grid << " grid, " << ticks << " ticks\n"
+              << "  metrics off:             " << off_seconds * 1e3 << " ms/tick\n"
+              << "  metrics on:              " << on_seconds * 1e3 << " ms/tick ("
+              << 100.0 * (on_seconds - off_seconds) / off_seconds << "% overhead)\n"
+              << "  on, snapshots every 1ms: " << reader_seconds * 1e3 << " ms/tick (" << snapshots
+              << " snapshots taken meanwhile)\n"
+              << "  snapshot of " << snapshot.edges.size() << " edges: " << snapshot_seconds * 1e6 << " us\n"
+              << "  trips completed " << snapshot.trips_completed << ", mean travel time "
+              << snapshot.mean_travel_time << " ticks" << std::endl;
+    return 0;
+}
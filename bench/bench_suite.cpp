@@ -0,0 +1,278 @@
+// Benchmark suite for regression tracking.
+// Usage: bench_suite [--quick] [--max-vehicles N] [--json path]
+// Micro benchmarks time the hot core operations (shortest paths, edge lookups, signal
+// updates, CSV parsing) on synthetic grid and random geometric networks. Macro
+// benchmarks time Simulation::tick() with 1k, 10k, 100k and 1M vehicles (capped by
+// --max-vehicles; 100k with --quick) spread over 4096 shared routes. Progress goes to stderr; the results are written as JSON to stdout,
+// or to the --json file.
+#include <algorithm> // For std::shuffle
+#include <chrono>
+#include <cstdio> // For std::remove
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "network_generator.hpp"
+#include "simulation.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double seconds_since(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // One result object; fields are kept in insertion order
+    class JsonResult
+    {
+    public:
+        JsonResult &add(const std::string &key, const std::string &value)
+        {
+            fields_.emplace_back(key, "\"" + value + "\"");
+            return *this;
+        }
+        JsonResult &add(const std::string &key, long value)
+        {
+            fields_.emplace_back(key, std::to_string(value));
+            return *this;
+        }
+        JsonResult &add(const std::string &key, double value)
+        {
+            std::ostringstream number;
+            number.precision(6);
+            number << value;
+            fields_.emplace_back(key, number.str());
+            return *this;
+        }
+        std::string to_json() const
+        {
+            std::string out = "{";
+            for (std::size_t i = 0; i < fields_.size(); ++i)
+            {
+                out += (i ? ", \"" : "\"") + fields_[i].first + "\": " + fields_[i].second;
+            }
+            return out + "}";
+        }
+
+    private:
+        std::vector<std::pair<std::string, std::string>> fields_;
+    };
+
+    // Calls op(i) with i = 0, 1, ... in growing batches until min_seconds have passed.
+    // Returns {iterations, ns per iteration}.
+    std::pair<long, double> time_operation(double min_seconds, const std::function<void(long)> &op)
+    {
+        long iterations = 0;
+        long batch = 16;
+        auto start = Clock::now();
+        double elapsed = 0.0;
+        while (elapsed < min_seconds)
+        {
+            for (long i = 0; i < batch; ++i)
+                op(iterations + i);
+            iterations += batch;
+            batch *= 2;
+            elapsed = seconds_since(start);
+        }
+        return {iterations, elapsed * 1e9 / iterations};
+    }
+
+    volatile long sink; // Keeps benchmarked results alive
+
+    JsonResult bench_shortest_path(const std::string &network_name, const Graph &graph, double min_seconds)
+    {
+        std::vector<int> nodes;
+        for (const auto &pair : graph.get_all_nodes())
+            nodes.push_back(pair.first);
+        std::mt19937 rng(7);
+        std::vector<std::pair<int, int>> queries(256);
+        for (auto &query : queries)
+            query = {nodes[rng() % nodes.size()], nodes[rng() % nodes.size()]};
+        long path_nodes = 0;
+        auto timing = time_operation(min_seconds, [&](long i)
+                                     {
+                                         const auto &query = queries[i % queries.size()];
+                                         path_nodes += static_cast<long>(graph.find_shortest_path(query.first, query.second).size()); });
+        sink = path_nodes;
+        return JsonResult().add("name", "find_shortest_path").add("network", network_name)
+            .add("nodes", static_cast<long>(nodes.size())).add("iterations", timing.first)
+            .add("ns_per_op", timing.second);
+    }
+
+    JsonResult bench_edge_lookup(const std::string &network_name, const Graph &graph, double min_seconds)
+    {
+        std::vector<std::pair<int, int>> queries;
+        for (const auto &pair : graph.get_all_edges())
+            queries.emplace_back(pair.second.from_node_id, pair.second.to_node_id);
+        std::shuffle(queries.begin(), queries.end(), std::mt19937(7));
+        long found = 0;
+        auto timing = time_operation(min_seconds, [&](long i)
+                                     {
+                                         const auto &query = queries[i % queries.size()];
+                                         found += graph.get_edge_between(query.first, query.second) != nullptr; });
+        sink = found;
+        return JsonResult().add("name", "get_edge_between").add("network", network_name)
+            .add("edges", static_cast<long>(queries.size())).add("iterations", timing.first)
+            .add("ns_per_op", timing.second);
+    }
+
+    JsonResult bench_signal_update(const std::string &network_name, const GeneratedNetwork &network,
+                                   double min_seconds)
+    {
+        std::vector<Intersection> intersections = network.intersections;
+        auto timing = time_operation(min_seconds, [&](long i)
+                                     { intersections[i % intersections.size()].update_signal_state(); });
+        return JsonResult().add("name", "update_signal_state").add("network", network_name)
+            .add("intersections", static_cast<long>(intersections.size()))
+            .add("iterations", timing.first).add("ns_per_op", timing.second);
+    }
+
+    JsonResult bench_parse_csv(std::size_t rows, double min_seconds)
+    {
+        const std::string path = "bench_suite_traffic.csv";
+        std::size_t bytes = 0;
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                std::string line = std::to_string(i / 64) + "," + std::to_string(i % 64) + "," +
+                                   std::to_string((i % 100) / 100.0) + "," + std::to_string(30.0 + (i % 41)) + "," +
+                                   std::to_string(i % 37) + "\n";
+                out << line;
+                bytes += line.size();
+            }
+        }
+        long parsed = 0;
+        auto timing = time_operation(min_seconds, [&](long)
+                                     { parsed += static_cast<long>(Utils::parse_csv(path).size()); });
+        sink = parsed;
+        std::remove(path.c_str());
+        return JsonResult().add("name", "parse_csv").add("rows", static_cast<long>(rows))
+            .add("iterations", timing.first).add("ns_per_row", timing.second / rows)
+            .add("mb_per_sec", bytes / (timing.second / 1e9) / 1e6);
+    }
+
+    // Ticks fresh forks of one populated simulation, TICKS_PER_RUN ticks each, until
+    // min_seconds of ticking have been timed. Short runs keep the population close to
+    // the requested size (the first trips end after a few ticks); forking is not timed.
+    JsonResult bench_tick(const std::string &network_name, const GeneratedNetwork &network, int vehicles,
+                          double min_seconds)
+    {
+        const int TICKS_PER_RUN = 20;
+        const int ROUTES = 4096;
+        auto setup_start = Clock::now();
+        Simulation base(1);
+        NetworkGenerator::install(base, network);
+        int added = NetworkGenerator::add_vehicles(base, vehicles, 1, 1000000, ROUTES);
+        base.tick(); // Starts every journey
+        double setup_seconds = seconds_since(setup_start);
+
+        long vehicle_updates = 0;
+        long ticks = 0;
+        double elapsed = 0.0;
+        while (ticks < TICKS_PER_RUN || elapsed < min_seconds)
+        {
+            Simulation sim = base.fork();
+            for (int t = 0; t < TICKS_PER_RUN; ++t)
+            {
+                vehicle_updates += static_cast<long>(sim.get_vehicles().size());
+                auto start = Clock::now();
+                sim.tick();
+                elapsed += seconds_since(start);
+            }
+            ticks += TICKS_PER_RUN;
+        }
+        return JsonResult().add("name", "tick").add("network", network_name).add("vehicles", static_cast<long>(added))
+            .add("routes", static_cast<long>(ROUTES)).add("ticks", ticks).add("ms_per_tick", elapsed * 1e3 / ticks)
+            .add("ticks_per_sec", ticks / elapsed).add("vehicle_updates_per_sec", vehicle_updates / elapsed)
+            .add("setup_seconds", setup_seconds);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool quick = false;
+    int max_vehicles = -1; // Default: 1M, or 100k with --quick
+    std::string json_path;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--quick")
+            quick = true;
+        else if (arg == "--max-vehicles" && i + 1 < argc)
+            max_vehicles = std::atoi(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else
+        {
+            std::cerr << "Usage: bench_suite [--quick] [--max-vehicles N] [--json path]" << std::endl;
+            return 2;
+        }
+    }
+    if (max_vehicles < 0)
+        max_vehicles = quick ? 100000 : 1000000;
+    const double micro_seconds = quick ? 0.05 : 0.5;
+    const double macro_seconds = quick ? 0.2 : 2.0;
+
+    std::vector<JsonResult> results;
+    auto run = [&](JsonResult result)
+    {
+        std::cerr << "  " << result.to_json() << std::endl;
+        results.push_back(std::move(result));
+    };
+
+    std::cerr << "Generating networks..." << std::endl;
+    const GeneratedNetwork grid = NetworkGenerator::make_grid(32, 32);
+    const GeneratedNetwork geometric = NetworkGenerator::make_random_geometric(1024, 6.0, 1);
+
+    std::cerr << "Micro benchmarks:" << std::endl;
+    run(bench_shortest_path("grid_32x32", grid.graph, micro_seconds));
+    run(bench_shortest_path("geometric_1024", geometric.graph, micro_seconds));
+    run(bench_edge_lookup("grid_32x32", grid.graph, micro_seconds));
+    run(bench_edge_lookup("geometric_1024", geometric.graph, micro_seconds));
+    run(bench_signal_update("grid_32x32", grid, micro_seconds));
+    run(bench_parse_csv(quick ? 20000 : 200000, micro_seconds));
+
+    std::cerr << "Macro benchmarks:" << std::endl;
+    const GeneratedNetwork tick_grid = NetworkGenerator::make_grid(20, 20);
+    for (int vehicles : {1000, 10000, 100000, 1000000})
+    {
+        if (vehicles <= max_vehicles)
+            run(bench_tick("grid_20x20", tick_grid, vehicles, macro_seconds));
+    }
+    if (10000 <= max_vehicles)
+        run(bench_tick("geometric_1024", geometric, 10000, macro_seconds));
+
+    std::string json = "{\n  \"suite\": \"bench_suite\",\n  \"quick\": ";
+    json += quick ? "true" : "false";
+    json += ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        json += "    " + results[i].to_json() + (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json += "  ]\n}\n";
+    if (json_path.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream out(json_path);
+        out << json;
+        if (!out)
+        {
+            std::cerr << "Error: Could not write '" << json_path << "'." << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
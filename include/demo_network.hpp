@@ -0,0 +1,11 @@
+#ifndef DEMO_NETWORK_HPP
+#define DEMO_NETWORK_HPP
+
+class Simulation;
+
+// The 3x3 demo city drawn by traffic_sim: nine signalised intersections joined by
+// two-way streets (edge id "ab" runs from node a to node b). Shared by the windowed
+// and the headless runner, so both simulate the same network.
+void setup_demo_network(Simulation &sim);
+
+#endif // DEMO_NETWORK_HPP
@@ -0,0 +1,75 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "metrics.hpp"
+#include "route_cache.hpp"
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+
+// Mean of one outcome over the replicas of an ensemble, with its 95% confidence interval
+// (Student t, two-sided): mean - ci_half_width .. mean + ci_half_width.
+struct EnsembleStatistic
+{
+    std::string name;
+    int samples = 0;
+    double mean = 0.0;
+    double stddev = 0.0; // Sample standard deviation
+    double ci_half_width = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Outcome of one replica
+struct ReplicaResult
+{
+    unsigned int seed = 0;
+    MetricsSnapshot metrics;
+    TripDistributions distributions;
+    std::size_t vehicles_at_end = 0;
+    double seconds = 0.0; // Wall time of the replica's ticks
+};
+
+struct EnsembleResult
+{
+    std::vector<ReplicaResult> replicas; // Ascending seed
+    // One entry per outcome: vehicles_spawned, trips_completed, trips_aborted,
+    // mean_travel_time, p50_travel_time, p95_travel_time, mean_trip_delay,
+    // mean_queued_vehicles (summed over approaches) and vehicles_at_end
+    std::vector<EnsembleStatistic> statistics;
+    TripDistributions distributions; // Merged over all replicas
+    double seconds = 0.0;            // Wall time of the whole ensemble
+
+    const EnsembleStatistic *find(const std::string &name) const; // nullptr if unknown
+    // Table of the statistics
+    std::string to_string() const;
+};
+
+// Runs independent replicas of a simulation with different seeds in parallel, to
+// separate the effect of a change from the noise of stochastic spawning.
+//
+// Replicas are forks of the prototype, so they share its immutable graph and the paths
+// of its vehicles without copying them. They also share one RouteCache, so every
+// origin-destination pair is routed once for the whole ensemble. A replica behaves
+// exactly like prototype.fork(seed) ticked on its own, whatever the thread count.
+class EnsembleRunner
+{
+public:
+    // Copies (forks) the prototype; num_threads == 0 uses every core.
+    explicit EnsembleRunner(const Simulation &prototype, std::size_t num_threads = 0);
+
+    // Runs `replicas` replicas of `ticks` ticks each, replica k seeded with base_seed + k.
+    EnsembleResult run(int replicas, int ticks, unsigned int base_seed = 1);
+
+    const RouteCache &get_route_cache() const;
+
+private:
+    Simulation prototype_;
+    std::shared_ptr<RouteCache> route_cache_;
+    ThreadPool pool_;
+};
+
+#endif // ENSEMBLE_HPP
@@ -0,0 +1,105 @@
+#ifndef ENVIRONMENT_HPP
+#define ENVIRONMENT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+
+// Reinforcement-learning style wrapper around a Simulation for signal control.
+//
+// Intersections are ordered by ascending intersection_id. Each intersection has
+// max_approaches() observation slots for approach queues, where max_approaches() is
+// the largest approach count in the prototype.
+//
+// Observation layout (float32). One environment writes observation_size() floats:
+//   for each intersection i, at offset i * (max_approaches() + 3):
+//     [0, max_approaches())  queue length per approach, in the intersection's approach
+//                            order; unused slots are 0
+//     [max_approaches()]     index of the current green approach
+//     [max_approaches() + 1] phase: 0 = not started, 1 = GREEN, 2 = YELLOW
+//     [max_approaches() + 2] ticks elapsed in the current phase
+//
+// Actions (int32). There are action_size() actions, one per intersection in the same order:
+//   0 = keep following the timing plan
+//   1 = end the current green now, see Intersection::request_phase_switch()
+//
+// Reward (float32) = -(vehicles queued at all intersections) after the step.
+class TrafficEnvironment
+{
+public:
+    // The prototype is forked on every reset() and must outlive the environment.
+    explicit TrafficEnvironment(const Simulation &prototype, int ticks_per_step = 1);
+    // A copy continues from the same state on its own simulation (see bind_intersections)
+    TrafficEnvironment(const TrafficEnvironment &other);
+    TrafficEnvironment &operator=(const TrafficEnvironment &) = delete;
+
+    // Restarts from the prototype with a new random seed and writes the first observation.
+    void reset(unsigned int seed, float *observation);
+
+    // Applies actions, advances ticks_per_step ticks, writes the observation and returns
+    // the reward. Does not allocate beyond what Simulation::tick() itself needs.
+    float step(const int *actions, float *observation);
+
+    void write_observation(float *observation) const;
+    float compute_reward() const;
+
+    std::size_t observation_size() const;
+    std::size_t action_size() const;
+    int max_approaches() const;
+    const Simulation &get_simulation() const;
+
+private:
+    // Points intersections_ at the intersections of this environment's own sim_
+    void bind_intersections();
+
+    const Simulation &prototype_;
+    Simulation sim_;
+    int ticks_per_step_;
+    int max_approaches_;
+    std::vector<int> intersection_ids_;           // Fixed observation/action order
+    std::vector<Intersection *> intersections_; // Rebound after every reset()
+};
+
+// N independent environments stepped in lockstep on a thread pool. Buffers are
+// caller-owned and contiguous: environment e uses
+//   observations[e * observation_size() .. (e + 1) * observation_size())
+//   actions[e * action_size() .. (e + 1) * action_size())
+//   rewards[e]
+class BatchEnvironment
+{
+public:
+    BatchEnvironment(const Simulation &prototype, std::size_t num_envs, int ticks_per_step = 1,
+                     std::size_t num_threads = 0);
+
+    // step_body_ captures `this`, so a copied or moved batch would step the original's envs
+    BatchEnvironment(const BatchEnvironment &) = delete;
+    BatchEnvironment &operator=(const BatchEnvironment &) = delete;
+    BatchEnvironment(BatchEnvironment &&) = delete;
+    BatchEnvironment &operator=(BatchEnvironment &&) = delete;
+
+    // Resets every environment; environment e is seeded with base_seed + e.
+    void reset(unsigned int base_seed, float *observations);
+    // Resets a single environment (e.g. at the end of its episode).
+    void reset_env(std::size_t env_index, unsigned int seed, float *observations);
+
+    void step(const int *actions, float *observations, float *rewards);
+
+    std::size_t num_envs() const;
+    std::size_t observation_size() const; // Per environment
+    std::size_t action_size() const;      // Per environment
+    const TrafficEnvironment &get_env(std::size_t env_index) const;
+
+private:
+    std::vector<TrafficEnvironment> envs_;
+    ThreadPool pool_;
+
+    // Buffers of the step in flight, read by step_body_ (built once so stepping does not allocate)
+    const int *step_actions_;
+    float *step_observations_;
+    float *step_rewards_;
+    std::function<void(std::size_t)> step_body_;
+};
+
+#endif // ENVIRONMENT_HPP
@@ -0,0 +1,132 @@
+#ifndef FRAME_RENDERER_HPP
+#define FRAME_RENDERER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "render_style.hpp"
+#include "simulation_thread.hpp"
+#include "spatial_grid.hpp"
+#include "thread_pool.hpp"
+
+// RGB image in memory: 3 bytes per pixel, rows top to bottom
+struct Framebuffer
+{
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels;
+
+    void resize(int new_width, int new_height); // Contents undefined afterwards
+    const std::uint8_t *pixel(int x, int y) const;
+};
+
+// Write one frame as a binary PPM (P6) or an 8-bit RGB PNG. Return false on I/O errors.
+bool write_ppm(const std::string &path, const Framebuffer &frame);
+bool write_png(const std::string &path, const Framebuffer &frame);
+
+// Stream of headerless RGB24 frames, one after another, for a video encoder, e.g.
+//   ffmpeg -f rawvideo -pixel_format rgb24 -video_size 1920x1080 -framerate 60 -i run.rgb run.mp4
+class RawVideoWriter
+{
+public:
+    RawVideoWriter() = default;
+    ~RawVideoWriter(); // Calls close()
+    RawVideoWriter(const RawVideoWriter &) = delete;
+    RawVideoWriter &operator=(const RawVideoWriter &) = delete;
+
+    // "-" streams to standard output (to pipe into the encoder)
+    bool open(const std::string &path);
+    // Every frame must have the size of the first. False on a size mismatch or I/O error.
+    bool write(const Framebuffer &frame);
+    // False if anything failed to reach the file
+    bool close();
+    bool is_open() const;
+    long get_frames_written() const;
+
+private:
+    std::FILE *file_ = nullptr;
+    bool owns_file_ = false;
+    bool failed_ = false;
+    long frames_written_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+};
+
+// Off-screen CPU renderer of the scene the Visualizer draws (roads, nodes, intersections
+// colored by signal state, vehicles, and the density map when zoomed out; see
+// render_style.hpp), for machines without a GPU or display.
+//
+// Each frame, the shapes in view are turned into pixel-space primitives and binned into
+// square tiles; tiles are then rasterized in parallel on a thread pool, each drawing its
+// primitives in scene order, so the image does not depend on the thread count. The
+// framebuffer, bins and primitive storage are reused between frames.
+class FrameRenderer
+{
+public:
+    // num_threads == 0 uses every core
+    FrameRenderer(const Graph &graph, int width, int height, std::size_t num_threads = 0);
+
+    // Shows `area` (graph coordinates), centred and widened to the frame's aspect ratio
+    void set_view(const BoundingBox &area);
+    // Shows the whole network (the default)
+    void fit_view();
+
+    // Renders the snapshot into the framebuffer and returns it; valid until the next render
+    const Framebuffer &render(const StateSnapshot &snapshot);
+    const Framebuffer &get_frame() const;
+
+private:
+    enum class PrimitiveKind
+    {
+        SEGMENT, // Road: centre line (x0, y0)-(x1, y1), half width `size`
+        DISK,    // Centre (x0, y0), radius `size`
+        RING,    // Centre (x0, y0), from radius x1 out to radius `size`
+        RECT     // [x0, x1) x [y0, y1)
+    };
+    // Graph coordinates of an edge's end nodes (valid is false if a node is missing)
+    struct RoadEnds
+    {
+        double x0, y0, x1, y1;
+        bool valid;
+    };
+    // In pixel coordinates
+    struct Primitive
+    {
+        PrimitiveKind kind;
+        float x0, y0, x1, y1;
+        float size;
+        Rgba color;
+        // Pixel bounding box, inclusive
+        int min_x, min_y, max_x, max_y;
+    };
+
+    float to_pixel_x(double x) const;
+    float to_pixel_y(double y) const;
+    void add_primitive(Primitive primitive);
+    void add_road(int edge_index, float half_width, Rgba color);
+    void build_scene(const StateSnapshot &snapshot);
+    void rasterize_tile(std::size_t tile);
+
+    const Graph &graph_;
+    SpatialGrid grid_;
+    ThreadPool pool_;
+    Framebuffer frame_;
+    // View: pixel = (graph coordinate - origin) * scale
+    double origin_x_;
+    double origin_y_;
+    double scale_;
+
+    std::vector<RoadEnds> roads_; // By edge index
+    std::vector<Primitive> primitives_; // Scene order (back to front)
+    int tile_columns_;
+    int tile_rows_;
+    std::vector<std::vector<int>> tile_bins_; // Primitive indices per tile, ascending
+    std::vector<int> visible_edges_;
+    std::vector<int> visible_nodes_;
+    std::vector<int> edge_loads_; // Vehicles per edge index for the density map; all zero between frames
+};
+
+#endif // FRAME_RENDERER_HPP
@@ -51,7 +51,14 @@ public:
     std::vector<int> find_shortest_path(int start_node_id, int end_node_id) const;
 
     // Utility
+    // Loads a map file, replacing the current contents. Format, one entry per line:
+    //   N <node_id> [<x> <y>]
+    //   E <edge_id> <from_node_id> <to_node_id> <weight>
+    // Blank lines and '#' comments are ignored. The file may be gzip (or zstd) compressed.
+    // Nodes without coordinates are laid out on a circle of UNPLACED_LAYOUT_RADIUS.
+    // On any error the graph is left empty and false is returned.
     bool load_from_file(const std::string &filepath);
+    static constexpr double UNPLACED_LAYOUT_RADIUS = 200.0;
     void clear();
 
 private:
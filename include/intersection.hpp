@@ -5,6 +5,7 @@
 #include <vector>
 #include <queue>  // For std::queue
 #include <string> // For approach names/IDs if needed, or just use int
+#include "timing_plan.hpp"
 
 // Define traffic light states
 enum class LightState
@@ -53,6 +54,34 @@ public:
     // Returns vehicle_id or -1 if empty
     int pop_vehicle_from_queue(int approach_id);
 
+    // Appends the vehicles queued on an approach to `out`, front of the queue first.
+    // Appends nothing for unknown approaches.
+    void append_queued_vehicle_ids(int approach_id, std::vector<int> &out) const;
+
+    // Replaces the default fixed cycle (GREEN_DURATION per approach) with a timing plan.
+    // Approaches missing from the plan keep GREEN_DURATION. The plan's offset is applied
+    // when the signal first starts cycling, so set plans before the first update.
+    void set_timing_plan(const SignalTimingPlan &plan);
+
+    // Ends the current green early: the green approach turns YELLOW on this call and the
+    // cycle continues from there. Does nothing during YELLOW or before the first update.
+    void request_phase_switch();
+
+    // Phase inspection (used by controllers and observers)
+    int get_current_green_approach_index() const; // -1 if there are no approaches
+    LightState get_phase_state() const;           // RED until the first update, then GREEN or YELLOW
+    int get_ticks_in_current_state() const;
+
+    // Puts the signal into a previously observed phase (e.g. when replaying a recorded
+    // run): approach `green_approach_index` shows `phase`, every other approach RED.
+    // Out-of-range indices are ignored. A pending plan offset is dropped, since the
+    // restored phase already includes it.
+    void restore_phase(int green_approach_index, LightState phase, int ticks_in_state);
+
+    // Green ticks currently configured for an approach, and the yellow interval
+    int get_green_duration(int approach_id) const;
+    int get_yellow_duration() const;
+
 private:
     int id_;
     std::map<int, LightState> current_signals_;     // Key: approach_id
@@ -63,6 +92,9 @@ private:
     int ticks_in_current_state_;       // Counter for how long current signal phase has been active
 
     // Red duration is implied by other phases
+    std::map<int, int> green_durations_; // Key: approach_id; missing entries use GREEN_DURATION
+    int yellow_duration_;
+    int pending_offset_; // Ticks to fast-forward when the cycle starts
 
     // Internal state for signal cycling
     LightState phase_state_; // Is the current phase GREEN or YELLOW
@@ -0,0 +1,165 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory> // For std::unique_ptr
+#include <mutex>
+#include <unordered_map>
+#include <utility> // For std::pair
+#include <vector>
+#include "graph.hpp"
+#include "quantile_sketch.hpp"
+
+// Metrics of one edge as of a snapshot. Queues are keyed by the edge a vehicle waits to
+// enter (Intersection approach ids are outgoing edge ids), so the approach metrics of
+// an intersection are the queue fields of its approach edges.
+struct EdgeMetrics
+{
+    int edge_id = 0;
+
+    // Vehicles travelling on the edge
+    std::int64_t vehicles_entered = 0;
+    std::int64_t vehicles_exited = 0;
+    std::int64_t occupancy = 0;     // Vehicles on the edge now
+    std::int64_t max_occupancy = 0;
+    double mean_occupancy = 0.0;    // Averaged over the observed ticks
+
+    // Vehicles queued at the intersection to enter the edge
+    std::int64_t vehicles_queued = 0;
+    std::int64_t vehicles_discharged = 0;
+    std::int64_t queue_length = 0;
+    std::int64_t max_queue_length = 0;
+    double mean_queue_length = 0.0;
+    std::int64_t delay_sum = 0;     // Ticks waited by the discharged vehicles
+    std::int64_t max_delay = 0;
+    double mean_delay = 0.0;        // Per discharged vehicle
+};
+
+// Network-wide metrics plus every edge, copied out by SimulationMetrics::snapshot().
+struct MetricsSnapshot
+{
+    int tick = 0;          // Last tick the simulation started
+    int ticks_observed = 0; // Ticks since metrics were enabled
+
+    std::int64_t vehicles_spawned = 0;
+    std::int64_t trips_completed = 0; // Vehicles that reached their destination
+    std::int64_t trips_aborted = 0;   // Vehicles removed because of a routing error
+    std::int64_t travel_time_sum = 0; // Ticks from departure to arrival, completed trips
+    std::int64_t max_travel_time = 0;
+    double mean_travel_time = 0.0;
+    std::int64_t trip_delay_sum = 0;  // Ticks completed trips spent queued
+    double mean_trip_delay = 0.0;
+
+    std::vector<EdgeMetrics> edges; // Ascending edge id
+    const EdgeMetrics *find_edge(int edge_id) const; // nullptr if unknown
+};
+
+// Distributions of per-vehicle outcomes, one fixed-size quantile sketch per key, for
+// p50/p95/p99 over arbitrarily long runs without keeping trip records.
+struct TripDistributions
+{
+    // Ticks from departure to arrival of completed trips. Key: (source node, destination node)
+    std::map<std::pair<int, int>, TDigest> travel_time_by_od;
+    // Ticks each vehicle waited in the queue before being discharged. Key: approach (edge) id
+    std::map<int, TDigest> delay_by_approach;
+
+    // Combines distributions of independent runs (e.g. replicas with different seeds)
+    void merge(const TripDistributions &other);
+    // Travel times of all OD pairs together
+    TDigest get_network_travel_time() const;
+};
+
+// Performance metrics of a running Simulation, updated incrementally by tick() with
+// O(1) work per vehicle event (spawn, edge entry/exit, queue join/discharge, arrival).
+//
+// Written only by the simulation thread; snapshot() may be called from any thread at
+// any time and never blocks the simulation. Every counter is a single-writer relaxed
+// atomic, which costs the same as a plain integer on the writer side. Each value in a
+// snapshot is exact, but values may come from different moments within the tick being
+// simulated while the snapshot was taken.
+//
+// Time-averaged values (mean occupancy, mean queue length) are kept as areas under
+// the curve, accumulated whenever the value changes, so no per-tick pass is needed.
+//
+// Travel time and delay distributions (TripDistributions) can't be kept in atomics.
+// Their samples are buffered during the tick and folded into the sketches at the end
+// of it, under a mutex that the simulation thread only ever try-locks: if a reader is
+// copying the distributions at that moment, the samples wait for the next tick.
+class SimulationMetrics
+{
+public:
+    // Prepares counters for every edge of `graph`; events for other edges are ignored.
+    // `sketch_compression` sets the size/accuracy of every distribution sketch.
+    SimulationMetrics(const Graph &graph, int start_tick,
+                      double sketch_compression = TDigest::DEFAULT_COMPRESSION);
+
+    SimulationMetrics(const SimulationMetrics &) = delete;
+    SimulationMetrics &operator=(const SimulationMetrics &) = delete;
+
+    // --- Event hooks, called by Simulation::tick() ---
+    void on_tick(int tick);
+    void on_spawn();
+    void on_edge_enter(int edge_id);
+    void on_edge_exit(int edge_id);
+    void on_queue_join(int edge_id);
+    void on_queue_discharge(int edge_id, int waited_ticks);
+    void on_trip_complete(int source_node_id, int destination_node_id, int travel_ticks, int delay_ticks);
+    void on_trip_aborted();
+    void on_tick_end();
+    // Counts vehicles already on an edge, or already queued to enter it, when the metrics
+    // start mid-run, as if they had entered or joined at the start tick. Without them,
+    // their exits and discharges would drive occupancy and queue length negative.
+    void on_initial_vehicles(int edge_id, std::int64_t on_edge, std::int64_t queued);
+
+    // Copies all metrics out. Thread-safe and lock-free.
+    MetricsSnapshot snapshot() const;
+    // Copies the distributions out. Thread-safe; samples of the tick in progress are
+    // not included yet.
+    TripDistributions get_distributions() const;
+
+private:
+    using Counter = std::atomic<std::int64_t>;
+
+    struct EdgeCounters
+    {
+        Counter entered{0}, exited{0}, max_occupancy{0}, occupancy_area{0}, occupancy_changed_tick{0};
+        Counter queued{0}, discharged{0}, max_queue{0}, queue_area{0}, queue_changed_tick{0};
+        Counter delay_sum{0}, max_delay{0};
+    };
+
+    // Dense index of edge_id, or -1
+    long find_index(int edge_id) const;
+    // Adds value * (ticks since it last changed) to the area, then restarts the interval
+    void advance_area(Counter &area, Counter &changed_tick, std::int64_t value);
+
+    int start_tick_;
+    Counter tick_;
+    std::vector<int> edge_ids_;                   // Ascending
+    std::unordered_map<int, std::size_t> index_; // Key: edge id
+    std::unique_ptr<EdgeCounters[]> edges_;
+
+    Counter spawned_, completed_, aborted_;
+    Counter travel_time_sum_, max_travel_time_, trip_delay_sum_;
+
+    // Distribution samples, buffered by the simulation thread until on_tick_end()
+    struct TravelTimeSample
+    {
+        std::pair<int, int> od;
+        int ticks;
+    };
+    struct DelaySample
+    {
+        int approach_id;
+        int ticks;
+    };
+    std::vector<TravelTimeSample> pending_travel_times_;
+    std::vector<DelaySample> pending_delays_;
+    double sketch_compression_;
+    mutable std::mutex distributions_mutex_;
+    TripDistributions distributions_;
+};
+
+#endif // METRICS_HPP
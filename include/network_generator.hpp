@@ -0,0 +1,48 @@
+#ifndef NETWORK_GENERATOR_HPP
+#define NETWORK_GENERATOR_HPP
+
+#include <vector>
+#include "graph.hpp"
+#include "intersection.hpp"
+
+class Simulation;
+
+// A synthetic road network: nodes with coordinates, two-way streets (one edge per
+// direction) and a signalised intersection at every node whose approaches are its
+// outgoing edges.
+struct GeneratedNetwork
+{
+    Graph graph;
+    std::vector<Intersection> intersections;
+};
+
+// Synthetic networks and demand for benchmarks, regression runs and stress tests.
+// Everything is deterministic for a given seed.
+namespace NetworkGenerator
+{
+    // rows x cols grid, `spacing` apart; every street takes `travel_ticks` ticks.
+    // Node ids are row * cols + col + 1.
+    GeneratedNetwork make_grid(int rows, int cols, double spacing = 50.0, int travel_ticks = 5);
+
+    // Random geometric graph: `node_count` nodes uniformly placed in an `extent` x
+    // `extent` square, with a street between every pair closer than the radius that
+    // gives the requested mean degree. Travel ticks are proportional to length (at
+    // least 1). Sparse settings can leave the network disconnected; vehicles are only
+    // placed on routable pairs (see add_vehicles).
+    GeneratedNetwork make_random_geometric(int node_count, double mean_degree, unsigned int seed,
+                                           double extent = 1000.0, double distance_per_tick = 10.0);
+
+    // Hands the network to the simulation (graph and intersections).
+    void install(Simulation &sim, const GeneratedNetwork &network);
+
+    // Adds `count` vehicles between random node pairs, ids starting at first_vehicle_id
+    // (clear of the ids the simulation's own spawning uses). Routes are planned once per
+    // origin-destination pair and shared between vehicles through Vehicle::set_route.
+    // Unroutable pairs are redrawn. With route_count > 0, vehicles are spread over that
+    // many random routable pairs instead, which bounds route planning for very large
+    // populations. Returns the number of vehicles added.
+    int add_vehicles(Simulation &sim, int count, unsigned int seed, int first_vehicle_id = 1000000,
+                     int route_count = 0);
+}
+
+#endif // NETWORK_GENERATOR_HPP
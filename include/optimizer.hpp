@@ -3,17 +3,39 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <cstddef>
 #include "graph.hpp" // For Node and Edge structures if needed
 #include "intersection.hpp" // For Intersection states
+#include "signal_search.hpp"
+#include "timing_plan.hpp"
+#include "traffic_data.hpp"
+#include "traffic_feed.hpp"
+#include "traffic_store.hpp"
 
-// Structure to hold traffic data points.
-// This could be expanded to include more detailed metrics.
-struct TrafficDataPoint {
-    int timestamp;          // Simulation tick or real-world time
-    int edge_id;            // Edge for which data is recorded
-    double density;         // Vehicle density (e.g., vehicles per unit length)
-    double average_speed;   // Average speed of vehicles on this edge
-    int vehicles_passed;    // Number of vehicles that passed a point on the edge
+// Running totals for one approach (edge_id), accumulated row by row so the raw
+// history never has to be held in memory.
+struct ApproachFlow {
+    long long vehicles_passed = 0; // Sum of vehicles_passed over all samples
+    long long samples = 0;         // Number of data rows seen for this edge
+    double density_sum = 0.0;
+
+    // Mean vehicles per sample interval
+    double mean_flow() const { return samples > 0 ? static_cast<double>(vehicles_passed) / samples : 0.0; }
+};
+
+// Tuning knobs for Webster's optimal cycle computation.
+// Times are in simulation ticks, flows in vehicles per tick.
+struct WebsterParameters {
+    double saturation_flow = 1.0;     // Discharge rate of a queued approach during green
+    double ticks_per_sample = 1.0;    // Length of the interval one TrafficDataPoint row covers
+    int lost_time_per_phase = 2;      // Start-up plus clearance lost time per phase
+    int yellow_duration = Intersection::YELLOW_DURATION;
+    int min_green = 5;
+    int min_cycle = 20;
+    int max_cycle = 180;
+    double max_flow_ratio_sum = 0.95; // Caps Y so oversaturated intersections still get a finite cycle
+    std::size_t num_threads = 0;      // Worker threads; 0 = hardware concurrency
 };
 
 // Class to manage traffic optimization strategies
@@ -25,23 +47,69 @@ public:
     // This might read from a file like traffic_density.csv or be fed data by the simulation
     void load_traffic_data(const std::vector<TrafficDataPoint>& data);
 
+    // Streams a traffic_density.csv-style file row by row into the per-approach flow totals.
+    // Rows are only kept (in the compressed history store) if store_history is true.
+    // Comment ('#') and non-numeric lines are skipped. Returns false if the file could not be opened.
+    bool load_traffic_data_file(const std::string& filepath, bool store_history = false);
+
+    // Folds a single observation into the per-approach flow totals.
+    void accumulate_flow(const TrafficDataPoint& point);
+
+    // Live feed update: folds the row into the flow totals and records the edge's
+    // sliding-window aggregates. No history is kept.
+    void ingest_live_sample(const TrafficDataPoint& point, const EdgeWindowStats& window);
+
+    // Routes every row of a followed feed into ingest_live_sample(). If the feed polls on
+    // a background thread, the optimizer must not be used concurrently from elsewhere.
+    void follow_feed(TrafficFeedFollower& feed);
+
+    // Latest sliding-window aggregates per edge from the live feed (Key: edge_id)
+    const std::map<int, EdgeWindowStats>& get_live_conditions() const;
+
+    // Computes a Webster optimal cycle and green split for every intersection from the
+    // accumulated approach flows. Intersections are processed in parallel.
+    std::map<int, SignalTimingPlan> compute_webster_timings(const std::map<int, Intersection>& intersections,
+                                                            const WebsterParameters& params = WebsterParameters()) const;
+
+    // Webster plan for a single intersection given approach flow totals.
+    static SignalTimingPlan compute_webster_plan(const Intersection& intersection,
+                                                 const std::map<int, ApproachFlow>& flows,
+                                                 const WebsterParameters& params);
+
     // Method to analyze current simulation state for optimization
     // Takes the current graph, intersections, and vehicles (not directly used here but could be)
     void analyze_current_conditions(const Graph& graph, const std::map<int, Intersection>& intersections /*, const std::map<int, Vehicle>& vehicles */);
 
-    // Example optimization strategy: Adjust signal timings for a specific intersection
-    // This is a placeholder for a more complex algorithm.
-    // It might return new timing parameters or directly suggest changes.
+    // Runs a parallel genetic search over green splits and offsets, scoring plans with
+    // headless rollouts of `base`. If approach flows have been loaded, the Webster plan
+    // seeds the first generation. The best plan set is kept for suggest_new_signal_timings().
+    TimingSearchResult search_signal_timings(const Simulation& base,
+                                             const TimingSearchParameters& params = TimingSearchParameters());
+
+    // Suggested green duration per approach ({approach_id, green_ticks}) for an intersection,
+    // taken from the last search_signal_timings() run. Empty if no search has covered it.
     std::map<int, int> suggest_new_signal_timings(int intersection_id);
 
-    // Retrieves all loaded traffic data
-    const std::vector<TrafficDataPoint>& get_traffic_data() const;
+    // Full plan set from the last search (Key: intersection_id)
+    const std::map<int, SignalTimingPlan>& get_suggested_plans() const;
+
+    // Retrieves all loaded traffic data, decoded from the history store (edge by edge, in time order)
+    std::vector<TrafficDataPoint> get_traffic_data() const;
+
+    // Indexed history for per-edge range queries, rolling statistics and downsampling
+    const TrafficHistoryStore& get_history() const;
+
+    // Per-approach totals accumulated so far (Key: edge_id)
+    const std::map<int, ApproachFlow>& get_approach_flows() const;
 
 private:
-    std::vector<TrafficDataPoint> historical_data_;
+    TrafficHistoryStore historical_data_;
+    std::map<int, ApproachFlow> approach_flows_; // Key: edge_id
+    std::map<int, EdgeWindowStats> live_conditions_; // Key: edge_id, from the live feed
     // Internal state for the optimizer, e.g., models, current analysis results
     // For example, a map to store current congestion levels per edge:
     std::map<int, double> current_congestion_levels_; // Key: edge_id, Value: congestion metric
+    std::map<int, SignalTimingPlan> suggested_plans_; // Best plans from the last timing search
 };
 
 #endif // OPTIMIZER_HPP
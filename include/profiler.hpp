@@ -0,0 +1,173 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility> // For std::pair
+#include <vector>
+
+// Latency histogram with HDR-style log-linear buckets: values below 32 get a bucket
+// each, and every power of two above is split into 32 equal sub-buckets, so any
+// recorded value is reported within 1/32 (~3%) of itself over the whole range (up to
+// ~9 minutes in nanoseconds; larger values land in the top bucket). Memory is fixed
+// (~9 KB) no matter how many values are recorded.
+//
+// Single writer: record() must only be called by one thread at a time, but the
+// accessors may read concurrently (buckets are relaxed atomics).
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram &other);
+    LatencyHistogram &operator=(const LatencyHistogram &other);
+
+    void record(std::uint64_t value);
+    // Adds every value recorded by `other`
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    std::uint64_t get_count() const;
+    std::uint64_t get_total() const; // Sum of the recorded values
+    std::uint64_t get_min() const;   // Exact; 0 if empty
+    std::uint64_t get_max() const;   // Exact; 0 if empty
+    double get_mean() const;
+    // Value at quantile q (clamped to [0, 1]), within the bucket precision; 0 if empty
+    std::uint64_t percentile(double q) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 39; // Values >= 2^40 are counted in the top bucket
+    static const int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+    static int bucket_index(std::uint64_t value);
+    // Midpoint of the values falling into the bucket
+    static std::uint64_t bucket_value(int index);
+
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<std::uint64_t> count_, total_, min_, max_;
+};
+
+// Phases of Simulation::tick(), in execution order
+enum class TickPhase
+{
+    SIGNALS,    // Intersection signal updates
+    SPAWNING,   // Vehicle spawning, including route planning
+    MOVEMENT,   // Vehicle movement, queueing and discharge
+    DESPAWNING, // Removal of arrived vehicles
+    COUNT
+};
+
+// Work counters of Simulation::tick()
+enum class ProfileCounter
+{
+    ROUTES_COMPUTED,  // Shortest path searches
+    QUEUE_OPERATIONS, // Intersection queue pushes, pops and front checks
+    MAP_LOOKUPS,      // Intersection and edge lookups by id
+    COUNT
+};
+
+const char *to_string(TickPhase phase);
+const char *to_string(ProfileCounter counter);
+
+// Latency distribution of one phase (or of the whole tick), in nanoseconds
+struct PhaseProfile
+{
+    std::string name;
+    std::uint64_t samples = 0;
+    std::uint64_t total_ns = 0;
+    double mean_ns = 0.0;
+    std::uint64_t min_ns = 0;
+    std::uint64_t p50_ns = 0;
+    std::uint64_t p90_ns = 0;
+    std::uint64_t p99_ns = 0;
+    std::uint64_t max_ns = 0;
+};
+
+struct ProfileReport
+{
+    std::uint64_t ticks = 0;
+    std::vector<PhaseProfile> phases; // In TickPhase order
+    PhaseProfile tick;                // Whole tick, including metrics and frame capture bookkeeping
+    std::vector<std::pair<std::string, std::uint64_t>> counters; // In ProfileCounter order
+
+    // Human-readable table: one line per phase (share of tick time and latency
+    // percentiles in microseconds), then the counters with per-tick averages
+    std::string to_string() const;
+};
+
+// Per-phase timers and work counters for Simulation::tick(). Phases are timed as a
+// chain: begin_tick() takes a timestamp and every end_phase() charges the time since
+// the previous timestamp to that phase, so one clock read per phase is all it costs.
+// Times come from std::chrono::steady_clock (a vDSO call, ~20 ns), which needs no
+// calibration and stays correct when the thread migrates between cores.
+//
+// Written only by the simulation thread; report() may be called from any thread.
+class TickProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TickProfiler();
+
+    void begin_tick();
+    void end_phase(TickPhase phase);
+    void end_tick();
+    void count(ProfileCounter counter, std::uint64_t amount = 1)
+    {
+        std::atomic<std::uint64_t> &value = counters_[static_cast<std::size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    ProfileReport report() const;
+    void reset();
+
+private:
+    Clock::time_point tick_start_;
+    Clock::time_point phase_start_;
+    std::array<LatencyHistogram, static_cast<std::size_t>(TickPhase::COUNT)> phases_;
+    LatencyHistogram tick_;
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(ProfileCounter::COUNT)> counters_;
+};
+
+// Instrumentation points for the simulation core. `profiler` is a (smart) pointer
+// that is null while profiling is off at run time. Building without
+// TRAFFICSIM_PROFILING (`make PROFILING=0`) expands them to no-ops, removing even
+// the null checks from release builds.
+#ifdef TRAFFICSIM_PROFILING
+#define PROFILE_TICK_BEGIN(profiler) \
+    do                               \
+    {                                \
+        if (profiler)                \
+            (profiler)->begin_tick(); \
+    } while (0)
+#define PROFILE_PHASE_END(profiler, phase) \
+    do                                     \
+    {                                      \
+        if (profiler)                      \
+            (profiler)->end_phase(phase);  \
+    } while (0)
+#define PROFILE_TICK_END(profiler) \
+    do                             \
+    {                              \
+        if (profiler)              \
+            (profiler)->end_tick(); \
+    } while (0)
+#define PROFILE_COUNT(profiler, counter, amount) \
+    do                                           \
+    {                                            \
+        if (profiler)                            \
+            (profiler)->count(counter, amount);  \
+    } while (0)
+#else
+#define PROFILE_TICK_BEGIN(profiler) ((void)(profiler))
+#define PROFILE_PHASE_END(profiler, phase) ((void)(profiler))
+#define PROFILE_TICK_END(profiler) ((void)(profiler))
+#define PROFILE_COUNT(profiler, counter, amount) ((void)(profiler))
+#endif
+
+#endif // PROFILER_HPP
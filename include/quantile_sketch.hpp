@@ -0,0 +1,56 @@
+#ifndef QUANTILE_SKETCH_HPP
+#define QUANTILE_SKETCH_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Streaming quantile estimator (merging t-digest, Dunning & Ertl).
+//
+// Values are summarised by weighted centroids that are small near the tails and large
+// near the median, so extreme quantiles (p95, p99) stay accurate while the memory per
+// digest is bounded by the compression parameter: at most about `compression`
+// centroids plus an insertion buffer of 2 * `compression` values, however many values
+// are added. Digests are mergeable: merging digests of disjoint samples gives a digest
+// of the union, so per-replica or per-thread digests can be combined afterwards.
+class TDigest
+{
+public:
+    static constexpr double DEFAULT_COMPRESSION = 100.0;
+
+    explicit TDigest(double compression = DEFAULT_COMPRESSION);
+
+    void add(double value, double weight = 1.0);
+    // Adds every value summarised by `other`
+    void merge(const TDigest &other);
+
+    // Estimated value at quantile q (clamped to [0, 1]); 0 for an empty digest.
+    // The minimum and maximum are exact.
+    double quantile(double q) const;
+
+    bool empty() const;
+    double get_count() const; // Total weight added
+    double get_min() const;
+    double get_max() const;
+    double get_compression() const;
+    std::size_t get_centroid_count() const; // After folding in the insertion buffer
+
+    // Folds the insertion buffer into the centroids. Called automatically when the
+    // buffer fills up and before quantiles are computed.
+    void compress();
+
+private:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    double compression_;
+    std::vector<Centroid> centroids_; // Sorted by mean
+    std::vector<Centroid> buffer_;    // Unsorted, not yet merged
+    double count_;
+    double min_;
+    double max_;
+};
+
+#endif // QUANTILE_SKETCH_HPP
@@ -0,0 +1,67 @@
+#ifndef RENDER_STYLE_HPP
+#define RENDER_STYLE_HPP
+
+#include <algorithm> // For std::min, std::max
+#include <cstdint>
+#include "simulation_thread.hpp"
+
+// 8-bit color with alpha (255 is opaque)
+struct Rgba
+{
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+    std::uint8_t a;
+};
+
+// How the scene looks, shared by the windowed Visualizer and the headless FrameRenderer
+// so both draw the same picture. Sizes are in graph units unless named in pixels.
+namespace RenderStyle
+{
+    const float ROAD_THICKNESS = 8.f;
+    const float NODE_RADIUS = 10.f;
+    const float INTERSECTION_RADIUS = 15.f;
+    const float SIGNAL_RING_THICKNESS = 3.f; // Outside INTERSECTION_RADIUS
+    const float VEHICLE_HALF_SIZE = 5.f;     // Vehicles are squares
+
+    // Shapes smaller than this on screen are not drawn individually
+    const float MIN_DETAIL_PIXELS = 1.5f;
+    // Narrowest a road is drawn in the density map, so it stays visible zoomed out
+    const float MIN_DENSITY_ROAD_PIXELS = 2.f;
+    // Road length a vehicle takes up in a jam: density 1 (red) is bumper to bumper
+    const float JAM_SPACING = 2.f * VEHICLE_HALF_SIZE + 2.f;
+
+    const Rgba BACKGROUND_COLOR = {25, 30, 50, 255};
+    const Rgba ROAD_COLOR = {60, 60, 70, 255};         // Darker road color
+    const Rgba NODE_COLOR = {120, 120, 120, 255};      // Darker grey
+    const Rgba INTERSECTION_COLOR = {40, 40, 50, 255}; // Fill with dark color
+    const Rgba VEHICLE_COLOR = {255, 180, 0, 255};     // A nice orange/yellow
+
+    // Ring color of an intersection: the state of its first approach
+    inline Rgba signal_color(const StateSnapshot::SignalLight &light)
+    {
+        if (!light.has_approaches)
+            return Rgba{150, 150, 150, 255};
+        switch (light.state)
+        {
+        case LightState::GREEN:
+            return Rgba{0, 255, 0, 200};
+        case LightState::YELLOW:
+            return Rgba{255, 255, 0, 200};
+        case LightState::RED:
+            break;
+        }
+        return Rgba{255, 0, 0, 200};
+    }
+
+    // Green (empty) through yellow to red (jammed)
+    inline Rgba density_color(float density)
+    {
+        density = std::max(0.f, std::min(1.f, density));
+        if (density < 0.5f)
+            return Rgba{static_cast<std::uint8_t>(510.f * density), 200, 0, 255};
+        return Rgba{255, static_cast<std::uint8_t>(200.f * (2.f - 2.f * density)), 0, 255};
+    }
+}
+
+#endif // RENDER_STYLE_HPP
@@ -0,0 +1,56 @@
+#ifndef ROUTE_CACHE_HPP
+#define ROUTE_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "graph.hpp"
+
+// Shortest paths of one immutable graph, planned once per origin-destination pair and
+// shared by every simulation that uses the cache (e.g. the replicas of an ensemble).
+// Cached paths are the ones Vehicle::plan_route would compute, so a simulation behaves
+// identically with or without a cache.
+//
+// Thread-safe. The table is split into shards, each behind its own mutex, and paths are
+// planned outside the lock. Two threads missing the same pair at once may both plan it;
+// the first result stored wins. Entries are never evicted: memory grows with the number
+// of distinct pairs requested.
+class RouteCache
+{
+public:
+    explicit RouteCache(std::shared_ptr<const Graph> graph);
+
+    RouteCache(const RouteCache &) = delete;
+    RouteCache &operator=(const RouteCache &) = delete;
+
+    // Path from source to destination (empty if unreachable). `planned`, if given, is
+    // set to whether this call ran the shortest-path search.
+    std::shared_ptr<const std::vector<int>> find_or_plan(int source_node_id, int destination_node_id,
+                                                         bool *planned = nullptr);
+
+    const Graph &get_graph() const;
+    std::size_t size() const;
+    std::uint64_t get_hits() const;
+    std::uint64_t get_misses() const;
+
+private:
+    static const std::size_t SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::shared_ptr<const std::vector<int>>> paths;
+    };
+
+    std::shared_ptr<const Graph> graph_;
+    std::array<Shard, SHARD_COUNT> shards_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+};
+
+#endif // ROUTE_CACHE_HPP
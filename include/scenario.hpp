@@ -0,0 +1,58 @@
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "simulation.hpp"
+#include "timing_plan.hpp"
+
+// A complete run description: network, signals, timing plans, demand, seed and length.
+// Loaded from a scenario file, so runs can be swept from scripts without recompiling.
+//
+// Scenario files are plain text, one directive per line ('#' starts a comment). Relative
+// paths are resolved against the scenario file's directory.
+//   map <path>                         Road network in Graph::load_from_file format
+//   grid <rows> <cols> [<spacing> <travel_ticks>]
+//                                      ... or a generated grid (NetworkGenerator::make_grid)
+//   geometric <nodes> <mean_degree> <seed>
+//                                      ... or a random geometric network
+//   intersection <node_id> <approach_edge_id>...
+//                                      Signalised intersection; without any of these lines
+//                                      every node with outgoing edges gets one whose
+//                                      approaches are those edges
+//   plans <path>                       Timing plans (load_timing_plans format)
+//   demand <start_tick> <spawn_interval>
+//                                      Demand profile period (Simulation::set_demand_profile);
+//                                      an interval of 0 stops spawning
+//   vehicles <count> [<routes>]        Vehicles placed before the first tick, on random
+//                                      routes (NetworkGenerator::add_vehicles)
+//   seed <n>                           Random seed (default 1)
+//   ticks <n>                          Run length (default 1000)
+// Exactly one of map, grid and geometric is required.
+struct Scenario
+{
+    std::string name; // File name without directory and extension
+    std::shared_ptr<const Graph> graph;
+    std::vector<Intersection> intersections; // Sorted by id
+    std::map<int, SignalTimingPlan> timing_plans;
+    std::vector<DemandPeriod> demand; // Empty: the simulation's default spawn interval
+    int initial_vehicles = 0;
+    int vehicle_routes = 0; // 0: one route per vehicle's origin-destination pair
+    unsigned int seed = 1;
+    int ticks = 1000;
+};
+
+// Parses a scenario file and builds its network. On any error the problem is reported
+// on stderr with its line number and false is returned (out_scenario is left unchanged).
+bool load_scenario(const std::string &filepath, Scenario &out_scenario);
+
+// Sets `sim` up to run the scenario: shares the scenario's graph (no copy, so many
+// simulations built from one loaded scenario share it), adds the intersections, applies
+// the timing plans and demand, seeds the random engine and places the initial vehicles.
+// `sim` should be freshly constructed.
+void apply_scenario(Simulation &sim, const Scenario &scenario);
+
+#endif // SCENARIO_HPP
@@ -0,0 +1,98 @@
+#ifndef SIGNAL_SEARCH_HPP
+#define SIGNAL_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "intersection.hpp"
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+#include "timing_plan.hpp"
+
+// Settings for the genetic search over per-intersection green splits and offsets.
+struct TimingSearchParameters
+{
+    int population_size = 24;
+    int generations = 10;
+    int elite_count = 2;         // Best plans copied unchanged into the next generation
+    int tournament_size = 3;
+    double mutation_rate = 0.2;  // Per-gene probability of a mutation
+    int mutation_step = 4;       // Max ticks a mutation moves a green duration or offset
+    int min_green = 5;
+    int max_green = 60;
+    int yellow_duration = Intersection::YELLOW_DURATION;
+
+    // Fitness = mean over rollout_seeds of the waiting vehicle-ticks per simulated tick
+    // in a headless rollout of rollout_ticks ticks. Lower is better.
+    int rollout_ticks = 600;
+    std::vector<unsigned int> rollout_seeds = {1, 2, 3, 4};
+
+    unsigned int search_seed = 12345; // Seeds selection, crossover and mutation
+    std::size_t num_threads = 0;      // Worker threads; 0 = hardware concurrency
+};
+
+struct TimingSearchResult
+{
+    std::map<int, SignalTimingPlan> best_plans; // Key: intersection_id
+    double best_fitness = 0.0;
+    std::vector<double> best_fitness_per_generation;
+    int evaluations = 0; // Distinct plan sets simulated
+    int cache_hits = 0;  // Plan sets whose fitness came from the cache
+    bool offsets_searched = true; // False if the base had already ticked (best_plans have offset 0)
+};
+
+// Black-box genetic algorithm that scores plan sets by running short headless
+// copies of a base Simulation in parallel. Fitness is memoized by plan hash, so
+// elites and duplicate offspring are never simulated twice.
+//
+// A plan's offset only takes effect when a signal first starts cycling (see
+// Intersection::set_timing_plan), so offsets are searched only if the base has not
+// ticked yet. Otherwise every plan keeps offset 0 and only green splits are searched.
+class SignalTimingSearch
+{
+public:
+    SignalTimingSearch(const Simulation &base, const TimingSearchParameters &params = TimingSearchParameters());
+
+    // Runs the search. initial_plans (e.g. Webster timings) seed the first generation;
+    // the rest of the population is the default fixed cycle plus random plans.
+    TimingSearchResult run(const std::vector<std::map<int, SignalTimingPlan>> &initial_plans = {});
+
+    // Fitness of one plan set (cached).
+    double evaluate(const std::map<int, SignalTimingPlan> &plans);
+
+    // Hash over every field of a plan set, in intersection/approach order.
+    static std::uint64_t hash_plans(const std::map<int, SignalTimingPlan> &plans);
+
+    std::size_t cache_size() const;
+
+private:
+    using PlanSet = std::map<int, SignalTimingPlan>;
+
+    // Scores every plan not yet in the cache, running all (plan, seed) rollouts in parallel.
+    void evaluate_population(const std::vector<PlanSet> &population, std::vector<double> &fitness);
+    double rollout(const PlanSet &plans, unsigned int seed) const;
+
+    PlanSet default_plan_set() const;
+    PlanSet random_plan_set();
+    const PlanSet &tournament_select(const std::vector<PlanSet> &population, const std::vector<double> &fitness);
+    PlanSet crossover(const PlanSet &a, const PlanSet &b);
+    void mutate(PlanSet &plans);
+    void clamp(SignalTimingPlan &plan) const;
+
+    const Simulation &base_;
+    TimingSearchParameters params_;
+    std::mt19937 rng_;
+    ThreadPool pool_;
+
+    mutable std::mutex cache_mutex_;
+    std::unordered_map<std::uint64_t, double> fitness_cache_; // Key: hash_plans()
+    int evaluations_;
+    int cache_hits_;
+    bool offsets_searched_; // The base is at tick 0, so rollouts apply offsets
+};
+
+#endif // SIGNAL_SEARCH_HPP
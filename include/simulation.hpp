@@ -2,38 +2,128 @@
 #define SIMULATION_HPP
 
 #include <map>
+#include <memory> // For std::shared_ptr
 #include <vector>
 #include <random> // For random number generation
+#include <string>
 #include "graph.hpp"
 #include "vehicle.hpp"
 #include "intersection.hpp"
+#include "trajectory.hpp"
+#include "simulation_view.hpp"
+#include "metrics.hpp"
+#include "profiler.hpp"
 
-class Simulation {
+class RouteCache;
+
+// One period of a demand profile: from start_tick on, the simulation spawns a vehicle
+// between two random nodes every spawn_interval ticks (0: no spawning).
+struct DemandPeriod {
+    int start_tick;
+    int spawn_interval;
+};
+
+class Simulation : public SimulationView {
 public:
     Simulation();
+    // Seeds vehicle spawning deterministically, e.g. for reproducible headless rollouts
+    explicit Simulation(unsigned int seed);
+
+    // A copy never shares the original's metrics or profiler (it starts with both off):
+    // ticked on its own, it would otherwise write into the original's counters. Moves
+    // keep them.
+    Simulation(const Simulation& other);
+    Simulation& operator=(const Simulation& other);
+    Simulation(Simulation&& other) = default;
+    Simulation& operator=(Simulation&& other) = default;
 
     // Setup methods
+    // The graph is immutable once handed to the simulation: the copy made here is
+    // shared by every fork() instead of being duplicated.
     void set_graph(const Graph& graph);
+    // Shares an existing graph without copying it
+    void set_graph(std::shared_ptr<const Graph> graph);
+    // Spawned vehicles take their paths from `cache` (shared with other simulations, see
+    // route_cache.hpp) instead of planning each one. Returns false, leaving routing
+    // unchanged, unless the cache was built for this simulation's graph; set_graph()
+    // drops the cache. Forks share it. nullptr goes back to planning every route.
+    bool set_route_cache(std::shared_ptr<RouteCache> cache);
     // Note: We store copies of vehicles and intersections.
     // Consider using smart pointers if complex ownership or polymorphism is needed later.
     void add_vehicle(const Vehicle& vehicle);
     void add_intersection(const Intersection& intersection);
 
+    // Applies signal timing plans (keyed by intersection_id) to the matching intersections.
+    // Plans for unknown intersections are ignored.
+    void apply_timing_plans(const std::map<int, SignalTimingPlan>& plans);
+    // Loads a plan set written by save_timing_plans() and applies it. Returns false on I/O or parse errors.
+    bool load_timing_plans(const std::string& filepath);
+
+    // Reseeds the spawn random engine
+    void set_random_seed(unsigned int seed);
+
+    // Spawns a vehicle every `ticks` ticks from now on (0 disables spawning); replaces
+    // any demand profile. The default is DEFAULT_SPAWN_INTERVAL.
+    void set_spawn_interval(int ticks);
+    // Time-varying demand: a period governs the ticks after its start_tick, so its first
+    // vehicle spawns on tick start_tick + spawn_interval. Periods are sorted by start_tick
+    // here; until the first one starts, the current interval stays in effect.
+    void set_demand_profile(const std::vector<DemandPeriod>& periods);
+    int get_spawn_interval() const;
+    static const int DEFAULT_SPAWN_INTERVAL = 20;
+
     // Core simulation step
     void tick();
 
+    // Cheap copy for look-ahead ("what happens in the next N ticks if ..."). The fork
+    // shares the graph and every vehicle's planned path with this simulation and owns
+    // its own copy of the small mutable state (vehicle positions, signal phases,
+    // queues, tick counter and random engine), so it can be ticked on another thread
+    // without affecting this one.
+    Simulation fork() const;
+    // Same, but reseeds the fork's random engine so branches can diverge in spawning
+    Simulation fork(unsigned int seed) const;
+
+    // Copies the current state into a trajectory frame (reusing the frame's capacity)
+    void capture_frame(TrajectoryFrame& frame) const;
+
+    // When enabled, tick() also captures the state it ends with into an internal frame
+    // while it is already walking the vehicles, which is far cheaper than a separate
+    // capture_frame() pass over a large vehicle map. Forks start with capture disabled.
+    void set_frame_capture(bool enabled);
+    // Frame captured by the last tick(), or nullptr if capture is off or no tick has
+    // run since it was enabled.
+    const TrajectoryFrame* get_tick_frame() const;
+
+    // Turns the metrics subsystem on, with fresh counters starting at the current tick,
+    // or off. Forks start with metrics off. Vehicles already on an edge or queued when
+    // metrics are enabled count as entering the edge or joining the queue at that tick.
+    void set_metrics_enabled(bool enabled);
+    // Live metrics (nullptr while disabled). Shared so another thread can keep calling
+    // snapshot() on them while the simulation ticks, even across set_metrics_enabled().
+    std::shared_ptr<const SimulationMetrics> get_metrics() const;
+
+    // Turns per-phase tick timing and work counters on (fresh, empty profile) or off.
+    // Forks start with profiling off. Builds without TRAFFICSIM_PROFILING compile the
+    // instrumentation out of tick(), so the profile stays empty there.
+    void set_profiling_enabled(bool enabled);
+    // Live profiler (nullptr while disabled); report() may be called from any thread.
+    std::shared_ptr<const TickProfiler> get_profiler() const;
+
     // Accessors
-    int get_current_tick() const;
+    int get_current_tick() const override;
     const Graph& get_graph() const;
-    const std::map<int, Vehicle>& get_vehicles() const;
-    const std::map<int, Intersection>& get_intersections() const;
+    std::shared_ptr<const Graph> get_shared_graph() const;
+    const std::map<int, Vehicle>& get_vehicles() const override;
+    const std::map<int, Intersection>& get_intersections() const override;
     // Mutable accessors might be needed for internal operations or testing
     Vehicle* get_vehicle_by_id(int vehicle_id); // Returns nullptr if not found
     Intersection* get_intersection_by_id(int intersection_id); // Returns nullptr if not found
 
 
 private:
-    Graph graph_;
+    std::shared_ptr<const Graph> graph_; // Shared, never mutated after set_graph()
+    std::shared_ptr<RouteCache> route_cache_; // Null: spawned vehicles plan their own routes
     std::map<int, Vehicle> vehicles_; // Key: vehicle_id
     std::map<int, Intersection> intersections_; // Key: intersection_id (node_id from graph)
     int current_tick_;
@@ -41,10 +131,24 @@ private:
     // For vehicle spawning
     int last_vehicle_id_;
     int spawn_timer_;
-    const int SPAWN_INTERVAL = 20; // Spawn a vehicle every 20 ticks (example)
+    int spawn_interval_ = DEFAULT_SPAWN_INTERVAL;
+    std::vector<DemandPeriod> demand_profile_;
+    std::size_t next_demand_period_ = 0; // First period of demand_profile_ not yet in effect
 
     // Random number generation (C++11 method)
     std::mt19937 random_engine_;
+
+    // Per-tick state capture (see set_frame_capture)
+    bool capture_enabled_ = false;
+    bool tick_frame_valid_ = false;
+    TrajectoryFrame tick_frame_;
+
+    std::shared_ptr<SimulationMetrics> metrics_; // Null while metrics are disabled
+    std::shared_ptr<TickProfiler> profiler_;     // Null while profiling is disabled
+
+    // Scratch buffers reused by tick() to avoid per-tick allocations
+    std::vector<int> spawn_node_ids_;
+    std::vector<int> arrived_vehicle_ids_;
 };
 
 #endif // SIMULATION_HPP
@@ -0,0 +1,107 @@
+#ifndef SIMULATION_THREAD_HPP
+#define SIMULATION_THREAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "graph.hpp"
+#include "simulation.hpp"
+#include "simulation_view.hpp"
+#include "triple_buffer.hpp"
+
+class StateServer;
+
+// Compact, self-contained picture of a run at one tick: what a renderer needs and
+// nothing more. Positions are in graph coordinates.
+struct StateSnapshot
+{
+    struct VehiclePosition
+    {
+        int vehicle_id;
+        int edge_id; // Edge the vehicle is on
+        float x;
+        float y;
+    };
+    struct SignalLight
+    {
+        int intersection_id;
+        float x;
+        float y;
+        bool has_approaches;
+        LightState state; // Of the first approach, when there is one
+    };
+    struct QueueLength
+    {
+        int approach_id; // Edge leading into the intersection
+        int length;      // Vehicles waiting on it
+    };
+
+    int tick = 0;
+    std::uint64_t published_ns = 0; // steady_clock time the snapshot was taken
+    std::size_t vehicle_count = 0;  // Every vehicle, including queued ones
+    std::vector<VehiclePosition> vehicles; // Vehicles on an edge, ascending id
+    std::vector<SignalLight> signals;      // Intersections on a graph node, ascending id
+    std::vector<QueueLength> queues;       // Every approach of every intersection, ascending id
+
+    // Fills the snapshot from `view` (reusing the vectors' capacity); vehicles are placed
+    // along their current edge by progress.
+    void capture(const SimulationView &view, const Graph &graph);
+};
+
+// Runs a Simulation on its own thread, decoupled from rendering, and publishes a
+// StateSnapshot after every tick through a TripleBuffer. The renderer takes the latest
+// snapshot lock-free whenever it draws; a slow frame never stalls the simulation, and
+// ticks faster than the frame rate are simply not drawn.
+//
+// The simulation belongs to the thread while it runs; only the graph, which is
+// immutable, may be read from other threads.
+class SimulationThread
+{
+public:
+    // Speed that set_ticks_per_second() treats as unbounded
+    static constexpr double UNBOUNDED = 0.0;
+
+    // Takes over the simulation. `max_ticks` > 0 stops ticking at that tick (the last
+    // snapshot stays published).
+    explicit SimulationThread(Simulation simulation, int max_ticks = 0);
+    ~SimulationThread(); // Calls stop()
+
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    void start();
+    // Stops and joins the thread. The simulation can be inspected afterwards.
+    void stop();
+
+    // Target rate, any time from any thread: ticks per second of wall time, or UNBOUNDED
+    // to tick as fast as possible. A thread that falls far behind does not try to
+    // catch up in a burst.
+    void set_ticks_per_second(double ticks_per_second);
+    double get_ticks_per_second() const;
+    void set_paused(bool paused);
+    bool is_paused() const;
+
+    // Also hands every snapshot to `server` (nullptr detaches). Only while stopped.
+    void set_state_server(StateServer *server);
+
+    // Reader side of the snapshot channel, for exactly one consumer thread
+    TripleBuffer<StateSnapshot> &get_snapshots();
+    const Graph &get_graph() const;
+    // Only while the thread is stopped
+    const Simulation &get_simulation() const;
+
+private:
+    void run();
+
+    Simulation simulation_;
+    int max_ticks_;
+    TripleBuffer<StateSnapshot> snapshots_;
+    StateServer *state_server_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+    std::atomic<double> ticks_per_second_;
+    std::atomic<bool> paused_;
+};
+
+#endif // SIMULATION_THREAD_HPP
@@ -0,0 +1,20 @@
+#ifndef SIMULATION_VIEW_HPP
+#define SIMULATION_VIEW_HPP
+
+#include <map>
+#include "vehicle.hpp"
+#include "intersection.hpp"
+
+// Read-only state of a run at one tick: what the Visualizer and analysis code consume.
+// Implemented by Simulation (live runs) and TrajectoryReplay (recorded runs).
+class SimulationView
+{
+public:
+    virtual ~SimulationView() = default;
+
+    virtual int get_current_tick() const = 0;
+    virtual const std::map<int, Vehicle> &get_vehicles() const = 0;
+    virtual const std::map<int, Intersection> &get_intersections() const = 0;
+};
+
+#endif // SIMULATION_VIEW_HPP
@@ -0,0 +1,80 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "graph.hpp"
+
+// Axis-aligned rectangle in graph coordinates (bounds inclusive)
+struct BoundingBox
+{
+    double min_x = 0.0;
+    double min_y = 0.0;
+    double max_x = 0.0;
+    double max_y = 0.0;
+
+    bool intersects(const BoundingBox &other) const;
+    bool contains(const BoundingBox &other) const;
+};
+
+// Uniform grid over the nodes and the edge bounding boxes of a graph, for finding what
+// lies in a rectangle (e.g. the part of the map on screen) without looking at the rest.
+//
+// Nodes and edges are referred to by dense index: their position in
+// Graph::get_all_nodes() / get_all_edges() order. Cells are sized for a few items
+// each, so a query costs about the number of cells it covers plus what it returns.
+// Immutable after construction; queries may run concurrently.
+class SpatialGrid
+{
+public:
+    // Indexes the graph as it is now (later changes to the graph are not seen)
+    explicit SpatialGrid(const Graph &graph);
+
+    // Replace the contents of `out` with the indices of the edges whose bounding box
+    // intersects / the nodes that lie in `area`, each once, in no particular order.
+    void query_edges(const BoundingBox &area, std::vector<int> &out) const;
+    void query_nodes(const BoundingBox &area, std::vector<int> &out) const;
+
+    std::size_t edge_count() const;
+    std::size_t node_count() const;
+    int get_edge_id(int edge_index) const;
+    int get_node_id(int node_index) const;
+    int find_edge_index(int edge_id) const; // -1 if unknown
+    int find_node_index(int node_id) const; // -1 if unknown
+    const BoundingBox &get_edge_bounds(int edge_index) const;
+
+    // Of every node and edge (all zero for an empty graph)
+    const BoundingBox &get_bounds() const;
+    double get_cell_size() const;
+
+private:
+    // Items stored compactly per cell: cell c holds items[starts[c] .. starts[c + 1])
+    struct CellLists
+    {
+        std::vector<int> starts;
+        std::vector<int> items;
+    };
+
+    int cell_column(double x) const; // Clamped to the grid
+    int cell_row(double y) const;
+    // Fills `lists` with every item i whose box (boxes[i]) overlaps a cell
+    void fill_cells(const std::vector<BoundingBox> &boxes, CellLists &lists) const;
+    void query(const BoundingBox &area, const std::vector<BoundingBox> &boxes, const CellLists &lists,
+               std::vector<int> &out) const;
+
+    std::vector<int> edge_ids_;
+    std::vector<int> node_ids_;
+    std::unordered_map<int, int> edge_index_; // Key: edge id
+    std::unordered_map<int, int> node_index_; // Key: node id
+    std::vector<BoundingBox> edge_bounds_;
+    std::vector<BoundingBox> node_bounds_; // Points: min == max
+    BoundingBox bounds_;
+    double cell_size_;
+    int columns_;
+    int rows_;
+    CellLists edge_cells_;
+    CellLists node_cells_;
+};
+
+#endif // SPATIAL_GRID_HPP
@@ -0,0 +1,93 @@
+#ifndef STATE_SERVER_HPP
+#define STATE_SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "graph.hpp"
+#include "simulation_thread.hpp"
+#include "simulation_view.hpp"
+#include "triple_buffer.hpp"
+
+// Streams live simulation state to local clients (dashboards, loggers) over a Unix
+// domain socket, in the format of state_stream.hpp: a KEY update on connect, then
+// DELTA updates with the vehicles, signals and queues that changed since the update
+// last sent to that client.
+//
+// publish() runs on the simulation thread and only copies the state into a
+// TripleBuffer; a server thread takes the latest state at most max_updates_per_second
+// times a second and writes to the clients with non-blocking sockets. Each client has
+// at most one update in flight: while the previous one has not drained into its
+// socket, newer states are skipped for that client (and counted), and its next update
+// is a delta against what it last received. A slow or stalled client therefore costs
+// the simulation nothing and never holds back the other clients.
+class StateServer
+{
+public:
+    static constexpr double DEFAULT_MAX_UPDATES_PER_SECOND = 30.0;
+
+    StateServer();
+    ~StateServer(); // Calls stop()
+
+    StateServer(const StateServer &) = delete;
+    StateServer &operator=(const StateServer &) = delete;
+
+    // Listens on `socket_path` (replacing a stale socket file there) and starts the server
+    // thread. Returns false if the socket can't be created.
+    bool start(const std::string &socket_path, double max_updates_per_second = DEFAULT_MAX_UPDATES_PER_SECOND);
+    // Disconnects every client, stops the thread and removes the socket file
+    void stop();
+    bool is_running() const;
+
+    // --- Writer side, one thread (the simulation's) ---
+    // Hands over the state after a tick. Never blocks.
+    void publish(const StateSnapshot &snapshot);
+    // Captures the state from `view` first (see StateSnapshot::capture)
+    void publish(const SimulationView &view, const Graph &graph);
+
+    std::size_t get_client_count() const;
+    std::uint64_t get_updates_sent() const;    // Over all clients
+    std::uint64_t get_updates_skipped() const; // States a busy client did not get
+    std::uint64_t get_bytes_sent() const;
+
+private:
+    struct Client
+    {
+        int fd; // -1 once disconnected
+        bool has_state = false; // `sent` holds what the client has been sent
+        StateSnapshot sent;
+        std::vector<std::uint8_t> output; // Update in flight
+        std::size_t output_offset = 0;    // Bytes of it already written
+    };
+
+    void serve();
+    void accept_clients();
+    // Writes what the socket takes; returns false if the client is gone
+    bool flush_client(Client &client);
+    // Sends `snapshot` to every client not still busy with its previous update
+    void send_latest(const StateSnapshot &snapshot, bool is_new);
+    void disconnect(Client &client);
+    void close_clients();
+
+    std::string socket_path_;
+    int listen_fd_;
+    double max_updates_per_second_;
+    TripleBuffer<StateSnapshot> snapshots_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+
+    // Server thread only
+    std::vector<Client> clients_;
+    bool has_snapshot_; // Something has been published
+    std::vector<std::uint8_t> scratch_; // Discarded client input
+
+    std::atomic<std::size_t> client_count_;
+    std::atomic<std::uint64_t> updates_sent_;
+    std::atomic<std::uint64_t> updates_skipped_;
+    std::atomic<std::uint64_t> bytes_sent_;
+};
+
+#endif // STATE_SERVER_HPP
@@ -0,0 +1,75 @@
+#ifndef STATE_STREAM_HPP
+#define STATE_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "simulation_thread.hpp"
+
+// Live state stream layout, as sent by StateServer to each client (integers are LEB128
+// varints, signed ones zigzag-mapped; floats are IEEE 754 float32, little endian):
+//
+//   header   MAGIC (8 bytes), sent once on connect
+//   update*  type byte, payload size, payload
+//
+// Update payload: tick, vehicle count (including vehicles not on an edge), then three
+// sections - vehicles, signals, queues - each holding
+//
+//   changed count, then per entry: id (delta to the previous entry's id), fields
+//   removed count, then the removed ids (delta coded the same way)
+//
+// Vehicle fields are edge id, x, y; signal fields are a state byte (LightState as an
+// integer, or SIGNAL_NO_APPROACHES), x, y; queue fields are the queue length. Ids are
+// vehicle ids, intersection ids and approach (edge) ids.
+//
+// A KEY update lists every entry and replaces the client's state; a DELTA update lists
+// only the entries that changed or appeared since the previous update sent to the same
+// client, plus those that disappeared. Updates a client was too slow to take are never
+// sent, so a client only ever sees complete states, possibly with gaps in ticks.
+namespace StateStreamFormat
+{
+    const char MAGIC[8] = {'T', 'R', 'A', 'F', 'S', 'T', 'M', '1'};
+
+    const std::uint8_t UPDATE_KEY = 1;
+    const std::uint8_t UPDATE_DELTA = 2;
+
+    const std::uint8_t SIGNAL_NO_APPROACHES = 3;
+}
+
+// Appends one update (type, size, payload) turning `previous` into `current` to `out`.
+// With `key`, `previous` is ignored and the whole of `current` is sent.
+void encode_state_update(const StateSnapshot &previous, const StateSnapshot &current, bool key,
+                         std::vector<std::uint8_t> &out);
+
+// Client side: rebuilds the server's state from the bytes of a stream as they arrive.
+class StateStreamDecoder
+{
+public:
+    StateStreamDecoder();
+
+    // Consumes received bytes, in any chunks, and applies every complete update. Returns
+    // false once the stream is malformed (bad header, corrupt update, or a DELTA before
+    // the first KEY); the decoder then ignores further input until reset().
+    bool feed(const std::uint8_t *data, std::size_t size);
+    void reset();
+
+    // State after the last complete update (published_ns is not sent and stays 0)
+    const StateSnapshot &get_state() const;
+    long get_updates_decoded() const;
+    bool has_state() const; // A KEY update has been decoded
+
+private:
+    bool decode_update(std::uint8_t type, const std::uint8_t *cursor, const std::uint8_t *end);
+
+    std::vector<std::uint8_t> pending_; // Received bytes not yet decoded
+    bool has_header_;
+    bool has_state_;
+    bool failed_;
+    long updates_decoded_;
+    StateSnapshot state_;
+    StateSnapshot changes_;   // Entries listed by the update being decoded
+    StateSnapshot merged_;    // state_ with the update applied, then swapped with it
+    std::vector<int> removed_; // Removed ids of the section being decoded
+};
+
+#endif // STATE_STREAM_HPP
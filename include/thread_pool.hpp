@@ -0,0 +1,75 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads shared by the parallel parts of the simulator
+// (optimizer passes, rollouts, batched environments, ...).
+class ThreadPool
+{
+public:
+    // num_threads == 0 picks default_thread_count().
+    explicit ThreadPool(std::size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Queues a single task and returns a future for its result.
+    template <typename F>
+    auto submit(F &&task) -> std::future<decltype(task())>
+    {
+        using ResultType = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(task));
+        std::future<ResultType> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push([packaged]()
+                        { (*packaged)(); });
+        }
+        work_available_.notify_one();
+        return result;
+    }
+
+    // Runs body(i) for every i in [0, count) across the workers and the calling thread,
+    // returning once all indices are done. Does not allocate per call; the first
+    // exception thrown by body is rethrown here.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)> &body);
+
+    std::size_t size() const;
+
+    // Hardware concurrency, never less than 1.
+    static std::size_t default_thread_count();
+
+private:
+    void worker_loop();
+    void run_batch_indices();
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    bool stopping_;
+
+    // State of the parallel_for batch currently in flight (at most one at a time).
+    std::mutex batch_mutex_;
+    std::condition_variable batch_done_;
+    const std::function<void(std::size_t)> *batch_body_;
+    std::size_t batch_count_;
+    std::atomic<std::size_t> batch_next_index_;
+    std::size_t batch_active_workers_;
+    unsigned long batch_generation_;
+    std::exception_ptr batch_error_;
+};
+
+#endif // THREAD_POOL_HPP
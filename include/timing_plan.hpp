@@ -0,0 +1,29 @@
+#ifndef TIMING_PLAN_HPP
+#define TIMING_PLAN_HPP
+
+#include <map>
+#include <string>
+
+// Fixed-time signal plan for one intersection.
+// Each approach (outgoing edge ID, as used by Intersection) gets its own green phase,
+// followed by a yellow interval; phases run in the intersection's approach order.
+struct SignalTimingPlan
+{
+    int intersection_id = -1;
+    int offset = 0;                     // Ticks the cycle is shifted by, relative to tick 0
+    int yellow_duration = 3;            // Ticks of yellow after every green phase
+    std::map<int, int> green_durations; // Key: approach_id, Value: green ticks
+
+    // Sum of all green and yellow intervals.
+    int cycle_length() const;
+};
+
+// Reads/writes a plan set in the plain-text format used by data/ files:
+//   # comment
+//   P <intersection_id> <offset> <yellow_duration>
+//   G <approach_id> <green_duration>      (applies to the preceding P line)
+// Returns false if the file could not be opened or a line is malformed.
+bool save_timing_plans(const std::string &filepath, const std::map<int, SignalTimingPlan> &plans);
+bool load_timing_plans(const std::string &filepath, std::map<int, SignalTimingPlan> &out_plans);
+
+#endif // TIMING_PLAN_HPP
@@ -0,0 +1,107 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing in the Chrome trace event format, for chrome://tracing and
+// ui.perfetto.dev: which thread ran what, when, and where the parallel paths stall.
+//
+// Every thread appends its events to its own buffer of fixed-size chunks without
+// locks or atomic read-modify-writes; a chunk's event count is published with a
+// release store, so stop() can collect from threads that are still running. A thread
+// takes a mutex once, the first time it records, to register its buffer.
+//
+// Recording is off until start(). While off, a TRACE_* scope costs one relaxed load
+// and a branch; building without TRAFFICSIM_TRACING (`make TRACING=0`) removes the
+// scopes entirely.
+namespace Tracing
+{
+    // Starts recording; the events are written to `filepath` by stop(), or at process
+    // exit if stop() is never called. Returns false if tracing is already on.
+    bool start(const std::string &filepath);
+    // Stops recording and writes the events recorded since start() as Chrome trace
+    // JSON. Returns false if tracing was off or the file could not be written.
+    bool stop();
+    bool is_enabled();
+
+    // Names the calling thread in the trace (shown instead of its number). `name` must
+    // outlive the process, e.g. a string literal. Cheap enough to call unconditionally.
+    void set_thread_name(const char *name);
+
+    // Nanoseconds on the trace clock
+    std::uint64_t now_ns();
+
+    // Records one complete event. `name` and `arg_name` must be string literals (they
+    // are stored by pointer); `arg_name` may be null for an event without an argument.
+    void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns,
+                const char *arg_name = nullptr, std::int64_t arg_value = 0);
+
+    // Records the time from construction to destruction, or to each next()
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name, const char *arg_name = nullptr, std::int64_t arg_value = 0)
+            : name_(nullptr)
+        {
+            if (is_enabled())
+                begin(name, arg_name, arg_value);
+        }
+        ~Scope() { end(); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        // Ends the current event and starts the next one, for consecutive phases of
+        // straight-line code
+        void next(const char *name)
+        {
+            end();
+            if (is_enabled())
+                begin(name, nullptr, 0);
+        }
+
+    private:
+        void begin(const char *name, const char *arg_name, std::int64_t arg_value)
+        {
+            name_ = name;
+            arg_name_ = arg_name;
+            arg_value_ = arg_value;
+            start_ns_ = now_ns();
+        }
+        void end()
+        {
+            if (name_)
+                record(name_, start_ns_, now_ns(), arg_name_, arg_value_);
+            name_ = nullptr;
+        }
+
+        const char *name_;
+        const char *arg_name_;
+        std::int64_t arg_value_;
+        std::uint64_t start_ns_;
+    };
+}
+
+#ifdef TRAFFICSIM_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+// Traces the enclosing scope as an event called `name`
+#define TRACE_SCOPE(name) Tracing::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+// Same, with one integer argument shown in the event details
+#define TRACE_SCOPE_ARG(name, arg_name, arg_value) \
+    Tracing::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name, arg_name, static_cast<std::int64_t>(arg_value))
+// Consecutive phases: TRACE_PHASES(var, "first"); ... TRACE_PHASE_NEXT(var, "second"); ...
+#define TRACE_PHASES(var, name) Tracing::Scope var(name)
+#define TRACE_PHASE_NEXT(var, name) var.next(name)
+#define TRACE_THREAD_NAME(name) Tracing::set_thread_name(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARG(name, arg_name, arg_value) ((void)0)
+#define TRACE_PHASES(var, name) ((void)0)
+#define TRACE_PHASE_NEXT(var, name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACE_HPP
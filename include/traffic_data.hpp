@@ -0,0 +1,65 @@
+#ifndef TRAFFIC_DATA_HPP
+#define TRAFFIC_DATA_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Structure to hold traffic data points.
+// This could be expanded to include more detailed metrics.
+struct TrafficDataPoint {
+    int timestamp;          // Simulation tick or real-world time
+    int edge_id;            // Edge for which data is recorded
+    double density;         // Vehicle density (e.g., vehicles per unit length)
+    double average_speed;   // Average speed of vehicles on this edge
+    int vehicles_passed;    // Number of vehicles that passed a point on the edge
+};
+
+// The same fields stored column by column, as produced by the bulk CSV loaders.
+struct TrafficDataColumns {
+    std::vector<int> timestamp;
+    std::vector<int> edge_id;
+    std::vector<double> density;
+    std::vector<double> average_speed;
+    std::vector<int> vehicles_passed;
+
+    std::size_t size() const { return timestamp.size(); }
+    bool empty() const { return timestamp.empty(); }
+
+    void clear() {
+        timestamp.clear();
+        edge_id.clear();
+        density.clear();
+        average_speed.clear();
+        vehicles_passed.clear();
+    }
+
+    void reserve(std::size_t rows) {
+        timestamp.reserve(rows);
+        edge_id.reserve(rows);
+        density.reserve(rows);
+        average_speed.reserve(rows);
+        vehicles_passed.reserve(rows);
+    }
+
+    void push_back(const TrafficDataPoint& point) {
+        timestamp.push_back(point.timestamp);
+        edge_id.push_back(point.edge_id);
+        density.push_back(point.density);
+        average_speed.push_back(point.average_speed);
+        vehicles_passed.push_back(point.vehicles_passed);
+    }
+
+    void append(const TrafficDataColumns& other) {
+        timestamp.insert(timestamp.end(), other.timestamp.begin(), other.timestamp.end());
+        edge_id.insert(edge_id.end(), other.edge_id.begin(), other.edge_id.end());
+        density.insert(density.end(), other.density.begin(), other.density.end());
+        average_speed.insert(average_speed.end(), other.average_speed.begin(), other.average_speed.end());
+        vehicles_passed.insert(vehicles_passed.end(), other.vehicles_passed.begin(), other.vehicles_passed.end());
+    }
+
+    TrafficDataPoint row(std::size_t index) const {
+        return {timestamp[index], edge_id[index], density[index], average_speed[index], vehicles_passed[index]};
+    }
+};
+
+#endif // TRAFFIC_DATA_HPP
@@ -0,0 +1,126 @@
+#ifndef TRAFFIC_FEED_HPP
+#define TRAFFIC_FEED_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "traffic_data.hpp"
+
+// Aggregates over the most recent samples of one edge
+struct EdgeWindowStats
+{
+    std::size_t count = 0;       // Samples currently in the window
+    double mean_density = 0.0;
+    double mean_speed = 0.0;
+    long long vehicles_passed = 0; // Sum over the window
+    int last_timestamp = 0;
+};
+
+// Keeps the last window_size samples of every edge in a fixed ring buffer with running
+// sums, so memory is bounded by (edges x window_size) however long the feed runs. The
+// floating-point sums are recomputed from the samples once per pass over the ring.
+class SlidingWindowAggregator
+{
+public:
+    explicit SlidingWindowAggregator(std::size_t window_size = 60);
+
+    // Adds a sample, evicting the oldest one of that edge once the window is full
+    const EdgeWindowStats &add(const TrafficDataPoint &point);
+    void clear();
+
+    std::size_t get_window_size() const;
+    bool get_stats(int edge_id, EdgeWindowStats &out_stats) const;
+    std::map<int, EdgeWindowStats> get_all_stats() const;
+
+private:
+    struct Sample
+    {
+        double density;
+        double average_speed;
+        int vehicles_passed;
+    };
+
+    struct EdgeWindow
+    {
+        std::vector<Sample> samples; // Ring buffer, grows up to window_size_ once
+        std::size_t next_slot = 0;
+        double density_sum = 0.0;
+        double speed_sum = 0.0;
+        EdgeWindowStats stats;
+    };
+
+    std::size_t window_size_;
+    std::map<int, EdgeWindow> windows_; // Key: edge_id
+};
+
+// Follows a traffic_density.csv-style file that is being appended to (like `tail -f`).
+// Each poll() reads only the bytes added since the previous poll, parses the complete
+// lines and carries a trailing partial line over to the next poll. Every valid row
+// updates the per-edge sliding window and is passed to the update callback.
+// If the file shrinks (truncated or replaced), following restarts from its beginning.
+class TrafficFeedFollower
+{
+public:
+    using UpdateCallback = std::function<void(const TrafficDataPoint &, const EdgeWindowStats &)>;
+
+    static const std::size_t READ_CHUNK_BYTES = 1 << 20;
+    static const std::size_t MAX_LINE_BYTES = 1 << 16; // Longer partial lines are discarded
+
+    // With start_at_end the rows already in the file are skipped.
+    explicit TrafficFeedFollower(const std::string &filepath, std::size_t window_size = 60,
+                                 bool start_at_end = false, char delimiter = ',');
+    ~TrafficFeedFollower();
+
+    TrafficFeedFollower(const TrafficFeedFollower &) = delete;
+    TrafficFeedFollower &operator=(const TrafficFeedFollower &) = delete;
+
+    // Called for every ingested row. Set before polling starts; with start() it runs
+    // on the background thread.
+    void set_update_callback(UpdateCallback callback);
+
+    // Reads and ingests whatever has been appended since the last poll.
+    // Returns the number of rows ingested (0 if the file is missing or unchanged).
+    std::size_t poll();
+
+    // Polls on a background thread every poll_interval_ms until stop() (or destruction).
+    void start(int poll_interval_ms = 500);
+    void stop();
+    bool is_running() const;
+
+    // Thread-safe snapshots of the window aggregates
+    bool get_stats(int edge_id, EdgeWindowStats &out_stats) const;
+    std::map<int, EdgeWindowStats> get_all_stats() const;
+
+    std::size_t get_rows_ingested() const;
+    std::size_t get_offset() const; // Bytes of the file consumed so far
+
+private:
+    std::size_t ingest_bytes(const char *data, std::size_t size);
+    bool ingest_line(const char *data, std::size_t size);
+
+    std::string filepath_;
+    char delimiter_;
+    bool skip_existing_;
+    std::size_t offset_;
+    std::string partial_line_;
+    bool discarding_line_; // Inside an over-long line; skip until the next newline
+    std::vector<char> read_buffer_;
+
+    mutable std::mutex mutex_; // Guards everything poll() touches
+    SlidingWindowAggregator aggregator_;
+    std::size_t rows_ingested_;
+    UpdateCallback on_update_;
+
+    std::thread worker_;
+    std::atomic<bool> running_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_requested_;
+};
+
+#endif // TRAFFIC_FEED_HPP
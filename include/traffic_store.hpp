@@ -0,0 +1,112 @@
+#ifndef TRAFFIC_STORE_HPP
+#define TRAFFIC_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+#include "traffic_data.hpp"
+
+// Which column of a TrafficDataPoint a statistic is computed over
+enum class TrafficMetric
+{
+    DENSITY,
+    AVERAGE_SPEED,
+    VEHICLES_PASSED
+};
+
+// One value of a derived time series (e.g. a rolling mean)
+struct TrafficSeriesPoint
+{
+    int timestamp;
+    double value;
+};
+
+// Aggregate of all samples of one edge that fall into a downsampling bucket
+struct TrafficBucket
+{
+    int start_timestamp;   // Inclusive; buckets cover [start, start + width)
+    int sample_count;
+    double mean_density;
+    double mean_speed;
+    long long vehicles_passed; // Sum over the bucket
+};
+
+// Columnar, compressed store for TrafficDataPoint history.
+//
+// Rows are grouped per edge into blocks of at most BLOCK_SIZE rows. Within a block,
+// timestamps are stored as a zigzag varint delta chain, vehicles_passed as zigzag
+// varints, and density/speed as plain double columns, so every row reads back exactly
+// as it was appended. Each block keeps its min/max timestamp, so time-range queries
+// only decode the blocks that overlap the range. Per-edge queries never touch other
+// edges' data.
+//
+// Rows are returned in timestamp order. Exports are normally appended in time order;
+// out-of-order rows are accepted and sorted at query time.
+class TrafficHistoryStore
+{
+public:
+    static const std::size_t BLOCK_SIZE = 1024; // Rows per compressed block
+
+    TrafficHistoryStore();
+
+    void append(const TrafficDataPoint &point);
+    void clear();
+
+    std::size_t size() const; // Total rows
+    std::vector<int> get_edge_ids() const;
+    std::size_t get_row_count(int edge_id) const;
+    // Approximate heap bytes used by the encoded columns
+    std::size_t memory_bytes() const;
+
+    // Rows of one edge with from_timestamp <= timestamp <= to_timestamp, in time order
+    std::vector<TrafficDataPoint> query_range(int edge_id, int from_timestamp, int to_timestamp) const;
+    void for_each_in_range(int edge_id, int from_timestamp, int to_timestamp,
+                           const std::function<void(const TrafficDataPoint &)> &callback) const;
+    // Every row of every edge, edge by edge
+    void for_each(const std::function<void(const TrafficDataPoint &)> &callback) const;
+
+    // For every row in the range: mean of `metric` over that edge's rows with
+    // timestamp in (row.timestamp - window, row.timestamp]
+    std::vector<TrafficSeriesPoint> rolling_mean(int edge_id, TrafficMetric metric, int window,
+                                                 int from_timestamp, int to_timestamp) const;
+
+    // Nearest-rank percentile (0-100) of `metric` over the range; returns false if it is empty
+    bool percentile(int edge_id, TrafficMetric metric, double percent,
+                    int from_timestamp, int to_timestamp, double &out_value) const;
+
+    // Fixed-width time buckets aligned to multiples of bucket_width; empty buckets are omitted
+    std::vector<TrafficBucket> downsample(int edge_id, int bucket_width,
+                                          int from_timestamp, int to_timestamp) const;
+
+    static double metric_value(const TrafficDataPoint &point, TrafficMetric metric);
+
+private:
+    struct Block
+    {
+        int min_timestamp;
+        int max_timestamp;
+        int last_timestamp; // Delta base for the next appended row
+        std::size_t row_count;
+        std::vector<std::uint8_t> timestamps; // Zigzag varint deltas (first is absolute)
+        std::vector<std::uint8_t> vehicles_passed; // Zigzag varints
+        std::vector<double> density;
+        std::vector<double> average_speed;
+    };
+
+    struct EdgeSeries
+    {
+        std::vector<Block> blocks;
+        std::size_t row_count = 0;
+        int last_timestamp = 0;
+        bool in_time_order = true;
+    };
+
+    static void decode_block(int edge_id, const Block &block, std::vector<TrafficDataPoint> &out);
+
+    std::map<int, EdgeSeries> series_; // Key: edge_id
+    std::size_t row_count_;
+};
+
+#endif // TRAFFIC_STORE_HPP
@@ -0,0 +1,115 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// State of a whole simulation at one tick, stored column by column. Vehicles and
+// intersections are in ascending id order (the order of the Simulation's maps).
+struct TrajectoryFrame
+{
+    int tick = 0;
+
+    // One entry per vehicle
+    std::vector<int> vehicle_ids;
+    std::vector<std::uint8_t> vehicle_states; // VehicleState as an integer
+    std::vector<int> current_nodes;
+    std::vector<int> next_nodes;
+    std::vector<int> progress_ticks;
+    std::vector<int> total_ticks;
+    std::vector<int> destinations;
+
+    // One entry per intersection
+    std::vector<int> intersection_ids;
+    std::vector<int> green_indices;
+    std::vector<std::uint8_t> phases; // LightState as an integer
+    std::vector<int> ticks_in_state;
+    std::vector<int> approach_counts;
+
+    // One entry per approach, intersections one after another
+    std::vector<int> approach_ids;
+    std::vector<int> queue_lengths;
+
+    // Queued vehicle ids of every approach, front first, approaches one after another
+    std::vector<int> queued_vehicle_ids;
+
+    void clear();
+    void clear_intersections(); // Everything but the vehicle columns and tick
+};
+
+// Binary trajectory log layout (all integers are LEB128 varints, signed ones zigzag-mapped):
+//
+//   header   MAGIC (8 bytes), keyframe interval
+//   frame*   type byte, payload size, payload
+//   index    an INDEX frame listing (tick, file offset) of every key frame
+//   trailer  file offset of the index frame (8 bytes, little endian), TRAILER_MAGIC (8 bytes)
+//
+// Frame payload: tick, vehicle count, then one column per vehicle field, then the
+// intersection columns. Vehicle ids are delta coded within the frame. In a KEY frame
+// the other vehicle fields are stored as-is; in a DELTA frame each is stored as the
+// difference to the same vehicle's value in the previous frame (0 for new vehicles),
+// so a vehicle that just advances one tick costs a few bytes. Intersection columns are
+// small and always stored as-is. The tick of a DELTA frame is relative to the previous frame.
+//
+// The index and trailer are written when recording finishes cleanly; a log without them
+// can still be read front to back.
+namespace TrajectoryFormat
+{
+    const char MAGIC[8] = {'T', 'R', 'A', 'J', 'L', 'O', 'G', '1'};
+    const char TRAILER_MAGIC[8] = {'T', 'R', 'A', 'J', 'I', 'D', 'X', '1'};
+    const std::size_t TRAILER_SIZE = 16;
+
+    const std::uint8_t FRAME_KEY = 1;
+    const std::uint8_t FRAME_DELTA = 2;
+    const std::uint8_t FRAME_INDEX = 3;
+}
+
+// Turns frames into encoded log frames, deciding which ones are key frames.
+class TrajectoryEncoder
+{
+public:
+    explicit TrajectoryEncoder(int keyframe_interval = 64);
+
+    // Appends the encoded frame (type, size, payload) to out. Returns true for a key frame.
+    bool encode(const TrajectoryFrame &frame, std::vector<std::uint8_t> &out);
+    // The next frame will be a key frame
+    void reset();
+
+    int get_keyframe_interval() const;
+
+private:
+    int keyframe_interval_;
+    int frames_since_key_;
+    bool has_previous_;
+    TrajectoryFrame previous_;
+    std::vector<int> reference_index_; // Per vehicle: index in previous_, or -1
+    std::vector<std::uint8_t> payload_;
+};
+
+// Reverses TrajectoryEncoder. Delta frames are decoded against the last frame this
+// decoder produced, so frames must be fed in log order starting at a key frame.
+class TrajectoryDecoder
+{
+public:
+    TrajectoryDecoder();
+
+    // Reads one frame at `cursor` and advances past it. INDEX frames are skipped over and
+    // reported through frame_type without touching `out`. Returns false on malformed
+    // input or on a DELTA frame with no preceding key frame.
+    bool decode(const std::uint8_t *&cursor, const std::uint8_t *end, TrajectoryFrame &out,
+                std::uint8_t &frame_type);
+    void reset();
+
+private:
+    bool has_previous_;
+    TrajectoryFrame previous_;
+    std::vector<int> reference_index_;
+};
+
+// Fills reference[i] with the index of frame.vehicle_ids[i] in previous.vehicle_ids, or -1.
+// Both id columns are sorted, so this is a single merge pass.
+void match_vehicle_references(const std::vector<int> &previous_ids, const std::vector<int> &ids,
+                              std::vector<int> &reference);
+
+#endif // TRAJECTORY_HPP
@@ -0,0 +1,81 @@
+#ifndef TRAJECTORY_RECORDER_HPP
+#define TRAJECTORY_RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation.hpp"
+#include "trajectory.hpp"
+
+// Records per-tick simulation state into a binary trajectory log (see trajectory.hpp).
+//
+// record() runs on the simulation thread and only copies the state into a preallocated
+// slot of a single-producer/single-consumer ring. A background writer thread encodes
+// the slots and writes them to disk, so the simulation never waits for I/O. If the
+// writer falls behind and the ring is full, the frame is dropped and counted instead
+// of blocking; later delta frames are encoded against the last frame actually written,
+// so the log stays consistent and only has a gap in ticks.
+class TrajectoryRecorder
+{
+public:
+    static const std::size_t DEFAULT_RING_CAPACITY = 8;
+    static const int DEFAULT_KEYFRAME_INTERVAL = 64;
+
+    TrajectoryRecorder();
+    ~TrajectoryRecorder(); // Calls close()
+
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+    // Creates the log and starts the writer thread. Returns false if the file can't be created.
+    bool open(const std::string &filepath, int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL,
+              std::size_t ring_capacity = DEFAULT_RING_CAPACITY);
+
+    // Captures the current state of `simulation`. Returns false if the frame was dropped
+    // (ring full) or the recorder is not open. Call from one thread only, after tick().
+    // If the simulation has frame capture enabled (Simulation::set_frame_capture), the
+    // frame tick() captured is copied instead of walking the vehicles again.
+    bool record(const Simulation &simulation);
+
+    // Waits for queued frames to be written, appends the key-frame index and closes the file.
+    void close();
+
+    bool is_open() const;
+    bool has_write_error() const;
+    std::size_t get_frames_written() const;
+    std::size_t get_frames_dropped() const;
+    std::size_t get_bytes_written() const;
+
+private:
+    static const std::size_t WRITE_BUFFER_BYTES = 1 << 20;
+
+    void writer_loop();
+    void flush_output();
+
+    std::ofstream file_;
+    bool is_open_;
+
+    // Ring of preallocated frames. head_ counts frames published by record(), tail_
+    // frames consumed by the writer; slot = count % capacity.
+    std::vector<TrajectoryFrame> slots_;
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+    std::atomic<bool> stopping_;
+
+    // Writer thread state
+    std::thread writer_;
+    TrajectoryEncoder encoder_;
+    std::vector<std::uint8_t> output_;
+    std::vector<std::pair<int, std::uint64_t>> keyframe_index_; // (tick, file offset)
+
+    std::atomic<std::size_t> frames_written_;
+    std::atomic<std::size_t> frames_dropped_;
+    std::atomic<std::uint64_t> bytes_written_;
+    std::atomic<bool> write_error_;
+};
+
+#endif // TRAJECTORY_RECORDER_HPP
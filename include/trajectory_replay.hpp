@@ -0,0 +1,100 @@
+#ifndef TRAJECTORY_REPLAY_HPP
+#define TRAJECTORY_REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "simulation_view.hpp"
+#include "trajectory.hpp"
+#include "utils.hpp"
+
+// Plays back a log written by TrajectoryRecorder without re-simulating.
+//
+// The log is memory-mapped and never copied. Seeking uses the key-frame index from the
+// log's trailer (or, for a log whose recording did not finish cleanly, an index built
+// by scanning the frames once on open): seek() jumps to the last key frame at or before
+// the requested tick and decodes at most one key-frame interval of delta frames from
+// there. Stepping forward from the current position never goes back to a key frame.
+//
+// The replayed state is exposed through the same read-only accessors as Simulation, so
+// the Visualizer and analysis code can draw or inspect a recorded run. Replayed vehicles
+// and intersections carry only what the log records: vehicle position, state and
+// destination, signal phase and queue contents. Planned paths and timing plans are not
+// recorded, so the corresponding accessors return defaults.
+class TrajectoryReplay : public SimulationView
+{
+public:
+    TrajectoryReplay();
+
+    // Maps the log and positions the replay at its first frame. Returns false if the
+    // file can't be opened, is not a trajectory log, or contains no readable frame.
+    bool open(const std::string &filepath);
+    void close();
+    bool is_open() const;
+
+    // Moves to the last recorded frame with tick <= `tick` (the first frame if `tick` is
+    // before it). Frames after a corrupt spot in the log are unreachable; returns false
+    // only if the key frame to start from can't be decoded.
+    bool seek(int tick);
+    // Moves to the next recorded frame. Returns false at the end of the log.
+    bool step();
+
+    int get_first_tick() const;
+    int get_last_tick() const;
+    int get_keyframe_interval() const;
+    std::size_t get_keyframe_count() const;
+    // False when the log had no index (e.g. the recorder was not closed) and one was
+    // rebuilt by scanning
+    bool has_stored_index() const;
+
+    // Current frame as recorded; cheaper than the map accessors for column-wise analysis
+    const TrajectoryFrame &get_frame() const;
+
+    // SimulationView. The maps are rebuilt from the current frame on first access after
+    // a move, so scrubbing without drawing costs only the decoding.
+    int get_current_tick() const override;
+    const std::map<int, Vehicle> &get_vehicles() const override;
+    const std::map<int, Intersection> &get_intersections() const override;
+
+private:
+    struct KeyframeEntry
+    {
+        int tick;
+        std::size_t offset;
+    };
+
+    bool read_stored_index();
+    bool build_index_by_scanning();
+    // Decodes the frame at cursor_ into `out`, skipping INDEX frames. False at the end of the log.
+    bool decode_next(TrajectoryFrame &out);
+    bool restart_at(std::size_t keyframe);
+    // Makes sure lookahead_ holds the frame after current_. False at the end of the log.
+    bool fill_lookahead();
+
+    Utils::MappedFile file_;
+    const std::uint8_t *begin_;
+    const std::uint8_t *frames_begin_;
+    const std::uint8_t *end_; // End of the readable frames (start of the index, if any)
+    int keyframe_interval_;
+    bool has_stored_index_;
+    std::vector<KeyframeEntry> keyframes_; // Ascending by tick and offset
+    int last_tick_;
+
+    TrajectoryDecoder decoder_;
+    const std::uint8_t *cursor_; // Just past the last frame the decoder consumed
+    TrajectoryFrame current_;
+    // A frame decoded past the seek target, kept so the next step() or forward seek
+    // doesn't have to decode it again (the decoder has already moved past it)
+    TrajectoryFrame lookahead_;
+    bool has_lookahead_;
+    bool has_frame_;
+
+    mutable bool vehicles_valid_;
+    mutable bool intersections_valid_;
+    mutable std::map<int, Vehicle> vehicles_;
+    mutable std::map<int, Intersection> intersections_;
+};
+
+#endif // TRAJECTORY_REPLAY_HPP
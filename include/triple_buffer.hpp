@@ -0,0 +1,57 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+// Lock-free hand-over of the latest value from one writer thread to one reader thread.
+//
+// Three buffers rotate between the roles back (being written), middle (latest published)
+// and front (being read). publish() swaps back and middle; update() swaps front and
+// middle if something new was published. Neither side ever waits for the other, the
+// writer never overwrites the buffer being read, and the reader always sees a complete
+// value. Intermediate values are dropped when the writer is faster than the reader.
+// Buffers are reused, so a T with vectors stops allocating once their capacity settles.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // --- Writer thread ---
+    // Buffer to fill; it holds whatever value was last written into it (not the latest).
+    T &write_buffer()
+    {
+        return buffers_[back_];
+    }
+    // Makes the write buffer the latest value and hands the writer a free buffer.
+    void publish()
+    {
+        back_ = middle_.exchange(back_ | NEW_VALUE, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // --- Reader thread ---
+    // Takes the latest published value, if there is one the reader has not seen. Returns
+    // true if read_buffer() changed.
+    bool update()
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & NEW_VALUE))
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    // Value taken by the last update() (default-constructed before the first); stays
+    // valid and unchanged until the next update().
+    const T &read_buffer() const
+    {
+        return buffers_[front_];
+    }
+
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned NEW_VALUE = 4; // Set in middle_ by publish(), cleared by update()
+
+    T buffers_[3];
+    alignas(64) unsigned back_ = 0;  // Writer only
+    alignas(64) std::atomic<unsigned> middle_{1};
+    alignas(64) unsigned front_ = 2; // Reader only
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <functional>
+#include <cstddef>
 #include <sstream> // Required for std::stringstream
 #include <fstream> // Required for std::ifstream
+#include "traffic_data.hpp"
 
 // Namespace for utility functions
 namespace Utils
@@ -19,6 +23,9 @@ namespace Utils
 
     // Parses a CSV file into a vector of CsvRow objects
     // Each CsvRow contains a vector of strings (fields)
+    // Every line is a row, including blank lines (no fields) and '#' lines; a trailing
+    // delimiter adds no empty field. Compressed files are read as in for_each_line().
+    // Use for_each_csv_row() to skip comments and blank lines without copying fields.
     std::vector<CsvRow> parse_csv(const std::string &filepath, char delimiter = ',');
 
     // Helper function to trim whitespace from both ends of a string
@@ -32,6 +39,127 @@ namespace Utils
     // Returns true on success, false on failure. Value is stored in out_value.
     bool string_to_double(const std::string &str, double &out_value);
 
+    // --- Compressed input ---
+
+    enum class Compression
+    {
+        NONE,
+        GZIP,
+        ZSTD // Readable only when built with TRAFFICSIM_HAVE_ZSTD
+    };
+
+    // Detected from the file's magic bytes, so the file name does not matter.
+    Compression detect_compression(const std::string &filepath);
+
+    // Decompressed bytes handed to the parser per block (blocks grow if a single line is longer).
+    const std::size_t DECOMPRESS_BLOCK_BYTES = 16 << 20;
+
+    using LineBlockCallback = std::function<void(std::string_view)>;
+
+    // Calls on_block with consecutive pieces of the file contents, each ending just after
+    // a '\n' (the last piece may lack one). Plain files are memory-mapped and passed as a
+    // single piece; gzip and zstd files are streamed through the decompressor in blocks of
+    // about DECOMPRESS_BLOCK_BYTES. Returns false if the file could not be opened or is
+    // corrupt (blocks before the corruption have already been delivered).
+    bool for_each_line_block(const std::string &filepath, const LineBlockCallback &on_block);
+
+    // Calls on_line for every line (without its '\n'); same input handling as for_each_line_block.
+    bool for_each_line(const std::string &filepath, const std::function<void(std::string_view)> &on_line);
+
+    // --- Zero-copy CSV parsing ---
+
+    // Read-only view of a whole file. Memory-mapped where the platform supports it,
+    // otherwise read into an owned buffer.
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        explicit MappedFile(const std::string &filepath);
+        ~MappedFile();
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool open(const std::string &filepath);
+        void close();
+        bool is_open() const;
+        std::string_view data() const;
+        std::size_t size() const;
+
+    private:
+        const char *data_;
+        std::size_t size_;
+        bool is_open_;
+        bool is_mapped_;
+        std::string fallback_buffer_;
+    };
+
+    // Fields of the current row; views point into the parsed buffer and are only
+    // valid until the next row is produced.
+    using CsvFields = std::vector<std::string_view>;
+    using CsvRowCallback = std::function<void(const CsvFields &)>;
+
+    // Pull-style row iterator over an in-memory buffer. Fields are trimmed, '#' comment
+    // lines and blank lines are skipped, and both \n and \r\n line endings are accepted.
+    class CsvCursor
+    {
+    public:
+        explicit CsvCursor(std::string_view buffer, char delimiter = ',');
+
+        // Fills `fields` with the next row; returns false at the end of the buffer.
+        bool next(CsvFields &fields);
+
+        // Byte offset of the first unconsumed character in the buffer
+        std::size_t position() const;
+
+    private:
+        std::string_view buffer_;
+        std::size_t position_;
+        char delimiter_;
+    };
+
+    // Calls on_row for every row of an in-memory buffer (same rules as CsvCursor).
+    void parse_csv_buffer(std::string_view buffer, const CsvRowCallback &on_row, char delimiter = ',');
+
+    // Calls on_row for every row of a file without copying fields. Plain files are
+    // memory-mapped; compressed files are decompressed on the fly (see for_each_line_block).
+    // Returns false if the file could not be opened or decompressed.
+    bool for_each_csv_row(const std::string &filepath, const CsvRowCallback &on_row, char delimiter = ',');
+
+    // Whitespace trimming and number parsing on views (std::from_chars, no allocation).
+    // The whole trimmed field must be a number for the parse to succeed.
+    std::string_view trim_view(std::string_view str);
+    bool parse_int(std::string_view str, int &out_value);
+    bool parse_double(std::string_view str, double &out_value);
+
+    // Parses a timestamp,edge_id,density,average_speed,vehicles_passed row.
+    bool parse_traffic_row(const CsvFields &fields, TrafficDataPoint &out_point);
+
+    // --- Parallel traffic data ingestion ---
+
+    // Splits a buffer into at most max_chunks pieces of roughly equal size. Every piece
+    // except possibly the last ends just after a '\n', so no row straddles two pieces.
+    std::vector<std::string_view> split_line_chunks(std::string_view buffer, std::size_t max_chunks);
+
+    // Parses every valid traffic row of a buffer (header and malformed rows are skipped).
+    void parse_traffic_columns(std::string_view buffer, TrafficDataColumns &out, char delimiter = ',');
+
+    using TrafficBatchCallback = std::function<void(const TrafficDataColumns &)>;
+
+    // Reads a (possibly compressed) traffic export and parses newline-aligned chunks in parallel
+    // (num_threads == 0 uses every core). Each chunk becomes one batch passed to on_batch.
+    // With ordered == true batches arrive in file order; otherwise they arrive as soon as
+    // they are parsed. Calls to on_batch are never concurrent. Only a bounded number of
+    // chunks is held in memory at once, so files larger than RAM can be streamed.
+    // Returns false if the file could not be opened.
+    bool for_each_traffic_batch(const std::string &filepath, const TrafficBatchCallback &on_batch,
+                                bool ordered = true, std::size_t num_threads = 0, char delimiter = ',');
+
+    // Loads a whole traffic export into columns, in file order.
+    bool load_traffic_columns(const std::string &filepath, TrafficDataColumns &out,
+                              std::size_t num_threads = 0, char delimiter = ',');
+
 } // namespace Utils
 
-#endif // UTILS_HPP
\ No newline at end of file
+#endif // UTILS_HPP
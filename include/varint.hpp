@@ -0,0 +1,67 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <cstdint>
+#include <vector>
+
+// LEB128-style variable-length integers with zigzag mapping for signed values.
+// Used by the compact binary encodings (traffic history columns, trajectory logs).
+namespace Varint
+{
+
+    inline std::uint64_t zigzag_encode(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    inline std::int64_t zigzag_decode(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    inline void append_unsigned(std::vector<std::uint8_t> &out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    inline void append_signed(std::vector<std::uint8_t> &out, std::int64_t value)
+    {
+        append_unsigned(out, zigzag_encode(value));
+    }
+
+    // Decodes one value at `cursor` and advances it. Returns false on truncated input.
+    inline bool read_unsigned(const std::uint8_t *&cursor, const std::uint8_t *end, std::uint64_t &out_value)
+    {
+        std::uint64_t result = 0;
+        int shift = 0;
+        while (cursor < end && shift < 64)
+        {
+            std::uint8_t byte = *cursor++;
+            result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                out_value = result;
+                return true;
+            }
+            shift += 7;
+        }
+        return false;
+    }
+
+    inline bool read_signed(const std::uint8_t *&cursor, const std::uint8_t *end, std::int64_t &out_value)
+    {
+        std::uint64_t raw = 0;
+        if (!read_unsigned(cursor, end, raw))
+            return false;
+        out_value = zigzag_decode(raw);
+        return true;
+    }
+
+} // namespace Varint
+
+#endif // VARINT_HPP
@@ -2,6 +2,7 @@
 #define VEHICLE_HPP
 
 #include <vector>
+#include <memory> // For std::shared_ptr
 #include <string> // For potential string state representation
 #include "graph.hpp" // Needs graph to plan routes
 
@@ -28,31 +29,52 @@ public:
     int get_source_node_id() const;
     int get_destination_node_id() const;
     const std::vector<int>& get_current_path() const;
+    // The path is immutable once planned, so copies of a vehicle (e.g. in a forked
+    // Simulation) share it instead of duplicating the vector.
+    const std::shared_ptr<const std::vector<int>>& get_shared_path() const;
     VehicleState get_state() const;
     int get_current_node_id() const; // Last passed intersection or current if waiting
     int get_next_node_id() const;    // Next intersection in the path
     int get_current_edge_progress_ticks() const;
     int get_current_edge_total_ticks() const;
+    int get_current_edge_id() const; // Edge being travelled, -1 when not on an edge
+    // Trip bookkeeping kept by Simulation for metrics: the tick the vehicle entered the
+    // simulation (-1 until then), the tick it joined its current intersection queue,
+    // and the ticks it has spent queued so far
+    int get_departure_tick() const;
+    int get_queue_entry_tick() const;
+    int get_delay_ticks() const;
 
     // Mutators (to be called by Simulation class)
+    // Uses an already planned (possibly shared) path instead of calling plan_route
+    void set_route(std::shared_ptr<const std::vector<int>> path);
     void set_state(VehicleState new_state);
     void set_current_node_id(int node_id);
     void set_next_node_id(int node_id); // Typically set when starting a new edge
     void set_current_edge_ticks(int progress, int total);
+    void set_current_edge_id(int edge_id);
     void increment_edge_progress_ticks();
+    void set_departure_tick(int tick);
+    void set_queue_entry_tick(int tick);
+    void add_delay_ticks(int ticks);
 
 
 private:
     int id_;
     int source_node_id_;
     int destination_node_id_;
-    std::vector<int> current_path_;
+    std::shared_ptr<const std::vector<int>> current_path_; // Null when no route is planned
 
     VehicleState state_;
     int current_node_id_; // Represents the start node of the current edge, or current intersection if waiting.
     int next_node_id_;    // Represents the end node of the current edge.
     int current_edge_progress_ticks_; // Ticks spent on the current edge.
     int current_edge_total_ticks_;    // Total ticks required for the current edge.
+    int current_edge_id_;             // Edge being travelled, -1 if none.
+
+    int departure_tick_;
+    int queue_entry_tick_;
+    int delay_ticks_;
 };
 
 #endif // VEHICLE_HPP
@@ -0,0 +1,158 @@
+#include "ensemble.hpp"
+#include "trace.hpp"
+
+#include <algorithm> // For std::min, std::max
+#include <chrono>
+#include <cmath> // For std::sqrt
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    // Two-sided 95% critical values of Student's t distribution for 1..30 degrees of freedom
+    const double T_CRITICAL_95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+    double t_critical_95(int degrees_of_freedom)
+    {
+        if (degrees_of_freedom <= 30)
+            return T_CRITICAL_95[degrees_of_freedom - 1];
+        if (degrees_of_freedom <= 40)
+            return 2.021;
+        if (degrees_of_freedom <= 60)
+            return 2.000;
+        if (degrees_of_freedom <= 120)
+            return 1.980;
+        return 1.960;
+    }
+
+    EnsembleStatistic summarize(const std::string &name, const std::vector<double> &values)
+    {
+        EnsembleStatistic statistic;
+        statistic.name = name;
+        statistic.samples = static_cast<int>(values.size());
+        if (values.empty())
+            return statistic;
+        double sum = 0.0;
+        statistic.min = statistic.max = values.front();
+        for (double value : values)
+        {
+            sum += value;
+            statistic.min = std::min(statistic.min, value);
+            statistic.max = std::max(statistic.max, value);
+        }
+        statistic.mean = sum / values.size();
+        if (values.size() > 1)
+        {
+            double squares = 0.0;
+            for (double value : values)
+                squares += (value - statistic.mean) * (value - statistic.mean);
+            statistic.stddev = std::sqrt(squares / (values.size() - 1));
+            statistic.ci_half_width = t_critical_95(statistic.samples - 1) * statistic.stddev /
+                                      std::sqrt(static_cast<double>(values.size()));
+        }
+        return statistic;
+    }
+
+    double mean_queued_vehicles(const MetricsSnapshot &metrics)
+    {
+        double queued = 0.0;
+        for (const EdgeMetrics &edge : metrics.edges)
+            queued += edge.mean_queue_length;
+        return queued;
+    }
+
+    double travel_time_quantile(const TripDistributions &distributions, double q)
+    {
+        TDigest travel_time = distributions.get_network_travel_time();
+        return travel_time.empty() ? 0.0 : travel_time.quantile(q);
+    }
+}
+
+const EnsembleStatistic *EnsembleResult::find(const std::string &name) const
+{
+    for (const EnsembleStatistic &statistic : statistics)
+    {
+        if (statistic.name == name)
+            return &statistic;
+    }
+    return nullptr;
+}
+
+std::string EnsembleResult::to_string() const
+{
+    std::ostringstream out;
+    out << "Ensemble of " << replicas.size() << " replicas in " << std::fixed << std::setprecision(2) << seconds
+        << " s (95% confidence intervals)\n";
+    out << std::left << std::setw(22) << "outcome" << std::right << std::setw(12) << "mean" << std::setw(12) << "+/-"
+        << std::setw(12) << "stddev" << std::setw(12) << "min" << std::setw(12) << "max" << "\n";
+    for (const EnsembleStatistic &statistic : statistics)
+    {
+        out << std::left << std::setw(22) << statistic.name << std::right << std::setw(12) << statistic.mean
+            << std::setw(12) << statistic.ci_half_width << std::setw(12) << statistic.stddev << std::setw(12)
+            << statistic.min << std::setw(12) << statistic.max << "\n";
+    }
+    return out.str();
+}
+
+EnsembleRunner::EnsembleRunner(const Simulation &prototype, std::size_t num_threads)
+    : prototype_(prototype.fork()),
+      route_cache_(std::make_shared<RouteCache>(prototype.get_shared_graph())),
+      pool_(num_threads)
+{
+    prototype_.set_route_cache(route_cache_);
+}
+
+EnsembleResult EnsembleRunner::run(int replicas, int ticks, unsigned int base_seed)
+{
+    TRACE_SCOPE_ARG("ensemble", "replicas", replicas);
+    EnsembleResult result;
+    if (replicas <= 0)
+        return result;
+    auto start = std::chrono::steady_clock::now();
+    result.replicas.resize(static_cast<std::size_t>(replicas));
+    pool_.parallel_for(result.replicas.size(), [&](std::size_t k)
+                       {
+                           TRACE_SCOPE_ARG("replica", "index", static_cast<std::int64_t>(k));
+                           ReplicaResult &replica = result.replicas[k];
+                           replica.seed = base_seed + static_cast<unsigned int>(k);
+                           Simulation sim = prototype_.fork(replica.seed); // Shares the route cache
+                           sim.set_metrics_enabled(true);
+                           auto replica_start = std::chrono::steady_clock::now();
+                           for (int t = 0; t < ticks; ++t)
+                               sim.tick();
+                           replica.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replica_start).count();
+                           replica.metrics = sim.get_metrics()->snapshot();
+                           replica.distributions = sim.get_metrics()->get_distributions();
+                           replica.vehicles_at_end = sim.get_vehicles().size(); });
+
+    // Merged in seed order, so the result does not depend on scheduling
+    std::vector<std::vector<double>> columns(9);
+    for (const ReplicaResult &replica : result.replicas)
+    {
+        const MetricsSnapshot &metrics = replica.metrics;
+        result.distributions.merge(replica.distributions);
+        columns[0].push_back(static_cast<double>(metrics.vehicles_spawned));
+        columns[1].push_back(static_cast<double>(metrics.trips_completed));
+        columns[2].push_back(static_cast<double>(metrics.trips_aborted));
+        columns[3].push_back(metrics.mean_travel_time);
+        columns[4].push_back(travel_time_quantile(replica.distributions, 0.50));
+        columns[5].push_back(travel_time_quantile(replica.distributions, 0.95));
+        columns[6].push_back(metrics.mean_trip_delay);
+        columns[7].push_back(mean_queued_vehicles(metrics));
+        columns[8].push_back(static_cast<double>(replica.vehicles_at_end));
+    }
+    const char *names[] = {"vehicles_spawned", "trips_completed", "trips_aborted", "mean_travel_time",
+                           "p50_travel_time", "p95_travel_time", "mean_trip_delay", "mean_queued_vehicles",
+                           "vehicles_at_end"};
+    for (std::size_t i = 0; i < columns.size(); ++i)
+        result.statistics.push_back(summarize(names[i], columns[i]));
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+const RouteCache &EnsembleRunner::get_route_cache() const
+{
+    return *route_cache_;
+}
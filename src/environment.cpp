@@ -0,0 +1,181 @@
+#include "environment.hpp"
+
+#include <algorithm> // For std::max, std::fill
+
+TrafficEnvironment::TrafficEnvironment(const Simulation &prototype, int ticks_per_step)
+    : prototype_(prototype),
+      sim_(prototype.fork()),
+      ticks_per_step_(std::max(1, ticks_per_step)),
+      max_approaches_(0)
+{
+    for (const auto &pair : prototype_.get_intersections())
+    {
+        intersection_ids_.push_back(pair.first);
+        max_approaches_ = std::max(max_approaches_, static_cast<int>(pair.second.get_approach_ids().size()));
+    }
+    bind_intersections();
+}
+
+TrafficEnvironment::TrafficEnvironment(const TrafficEnvironment &other)
+    : prototype_(other.prototype_),
+      sim_(other.sim_),
+      ticks_per_step_(other.ticks_per_step_),
+      max_approaches_(other.max_approaches_),
+      intersection_ids_(other.intersection_ids_)
+{
+    bind_intersections(); // other's pointers lead into other.sim_
+}
+
+void TrafficEnvironment::bind_intersections()
+{
+    intersections_.clear();
+    for (int intersection_id : intersection_ids_)
+    {
+        intersections_.push_back(sim_.get_intersection_by_id(intersection_id));
+    }
+}
+
+void TrafficEnvironment::reset(unsigned int seed, float *observation)
+{
+    sim_ = prototype_.fork(seed);
+    bind_intersections();
+    write_observation(observation);
+}
+
+float TrafficEnvironment::step(const int *actions, float *observation)
+{
+    for (std::size_t i = 0; i < intersections_.size(); ++i)
+    {
+        if (actions[i] == 1)
+        {
+            intersections_[i]->request_phase_switch();
+        }
+    }
+    for (int t = 0; t < ticks_per_step_; ++t)
+    {
+        sim_.tick();
+    }
+    write_observation(observation);
+    return compute_reward();
+}
+
+void TrafficEnvironment::write_observation(float *observation) const
+{
+    const std::size_t stride = static_cast<std::size_t>(max_approaches_) + 3;
+    for (std::size_t i = 0; i < intersections_.size(); ++i)
+    {
+        const Intersection &intersection = *intersections_[i];
+        float *slot = observation + i * stride;
+        std::fill(slot, slot + stride, 0.0f);
+
+        const std::vector<int> &approaches = intersection.get_approach_ids();
+        for (std::size_t a = 0; a < approaches.size(); ++a)
+        {
+            slot[a] = static_cast<float>(intersection.get_vehicle_queue(approaches[a]).size());
+        }
+
+        float phase = 0.0f;
+        if (intersection.get_phase_state() == LightState::GREEN)
+            phase = 1.0f;
+        else if (intersection.get_phase_state() == LightState::YELLOW)
+            phase = 2.0f;
+        slot[max_approaches_] = static_cast<float>(intersection.get_current_green_approach_index());
+        slot[max_approaches_ + 1] = phase;
+        slot[max_approaches_ + 2] = static_cast<float>(intersection.get_ticks_in_current_state());
+    }
+}
+
+float TrafficEnvironment::compute_reward() const
+{
+    std::size_t queued = 0;
+    for (const Intersection *intersection : intersections_)
+    {
+        for (int approach_id : intersection->get_approach_ids())
+        {
+            queued += intersection->get_vehicle_queue(approach_id).size();
+        }
+    }
+    return -static_cast<float>(queued);
+}
+
+std::size_t TrafficEnvironment::observation_size() const
+{
+    return intersection_ids_.size() * (static_cast<std::size_t>(max_approaches_) + 3);
+}
+
+std::size_t TrafficEnvironment::action_size() const
+{
+    return intersection_ids_.size();
+}
+
+int TrafficEnvironment::max_approaches() const
+{
+    return max_approaches_;
+}
+
+const Simulation &TrafficEnvironment::get_simulation() const
+{
+    return sim_;
+}
+
+// --- BatchEnvironment ---
+
+BatchEnvironment::BatchEnvironment(const Simulation &prototype, std::size_t num_envs, int ticks_per_step,
+                                   std::size_t num_threads)
+    : pool_(num_threads),
+      step_actions_(nullptr),
+      step_observations_(nullptr),
+      step_rewards_(nullptr)
+{
+    envs_.reserve(num_envs);
+    for (std::size_t e = 0; e < num_envs; ++e)
+    {
+        envs_.emplace_back(prototype, ticks_per_step);
+    }
+
+    step_body_ = [this](std::size_t e)
+    {
+        step_rewards_[e] = envs_[e].step(step_actions_ + e * action_size(),
+                                         step_observations_ + e * observation_size());
+    };
+}
+
+void BatchEnvironment::reset(unsigned int base_seed, float *observations)
+{
+    const std::size_t stride = observation_size();
+    pool_.parallel_for(envs_.size(), [&](std::size_t e)
+                       { envs_[e].reset(base_seed + static_cast<unsigned int>(e), observations + e * stride); });
+}
+
+void BatchEnvironment::reset_env(std::size_t env_index, unsigned int seed, float *observations)
+{
+    envs_[env_index].reset(seed, observations + env_index * observation_size());
+}
+
+void BatchEnvironment::step(const int *actions, float *observations, float *rewards)
+{
+    step_actions_ = actions;
+    step_observations_ = observations;
+    step_rewards_ = rewards;
+    pool_.parallel_for(envs_.size(), step_body_);
+}
+
+std::size_t BatchEnvironment::num_envs() const
+{
+    return envs_.size();
+}
+
+std::size_t BatchEnvironment::observation_size() const
+{
+    return envs_.empty() ? 0 : envs_.front().observation_size();
+}
+
+std::size_t BatchEnvironment::action_size() const
+{
+    return envs_.empty() ? 0 : envs_.front().action_size();
+}
+
+const TrafficEnvironment &BatchEnvironment::get_env(std::size_t env_index) const
+{
+    return envs_[env_index];
+}
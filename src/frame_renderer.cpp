@@ -0,0 +1,459 @@
+#include "frame_renderer.hpp"
+#include "trace.hpp"
+
+#include <zlib.h>
+#include <algorithm> // For std::min, std::max, std::lower_bound
+#include <cmath>     // For std::floor, std::ceil, std::hypot
+#include <fstream>
+
+namespace
+{
+    using namespace RenderStyle;
+
+    // Square tiles: small enough to spread a frame over many threads, large enough that
+    // binning stays cheap
+    const int TILE_SIZE = 64;
+
+    // Blends `color` over the RGB pixel at `out` by its alpha
+    inline void put_pixel(std::uint8_t *out, Rgba color)
+    {
+        if (color.a == 255)
+        {
+            out[0] = color.r;
+            out[1] = color.g;
+            out[2] = color.b;
+            return;
+        }
+        const unsigned alpha = color.a, rest = 255 - color.a;
+        out[0] = static_cast<std::uint8_t>((color.r * alpha + out[0] * rest + 127) / 255);
+        out[1] = static_cast<std::uint8_t>((color.g * alpha + out[1] * rest + 127) / 255);
+        out[2] = static_cast<std::uint8_t>((color.b * alpha + out[2] * rest + 127) / 255);
+    }
+
+    void put_u32(std::vector<std::uint8_t> &out, std::uint32_t value)
+    {
+        out.push_back(static_cast<std::uint8_t>(value >> 24));
+        out.push_back(static_cast<std::uint8_t>(value >> 16));
+        out.push_back(static_cast<std::uint8_t>(value >> 8));
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    // Length, type, data and CRC of the type and data
+    void append_png_chunk(std::vector<std::uint8_t> &png, const char *type, const std::uint8_t *data,
+                          std::size_t size)
+    {
+        put_u32(png, static_cast<std::uint32_t>(size));
+        const std::size_t type_at = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data, data + size);
+        uLong crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, png.data() + type_at, static_cast<uInt>(size + 4));
+        put_u32(png, static_cast<std::uint32_t>(crc));
+    }
+}
+
+void Framebuffer::resize(int new_width, int new_height)
+{
+    width = std::max(0, new_width);
+    height = std::max(0, new_height);
+    pixels.resize(static_cast<std::size_t>(width) * height * 3);
+}
+
+const std::uint8_t *Framebuffer::pixel(int x, int y) const
+{
+    return pixels.data() + (static_cast<std::size_t>(y) * width + x) * 3;
+}
+
+bool write_ppm(const std::string &path, const Framebuffer &frame)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+    file.write(reinterpret_cast<const char *>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size()));
+    return static_cast<bool>(file);
+}
+
+bool write_png(const std::string &path, const Framebuffer &frame)
+{
+    TRACE_SCOPE("write_png");
+    // Every row gets the Sub filter (each byte minus the one a pixel to its left), which
+    // turns the flat colors of the scene into runs of zeros that deflate well
+    const std::size_t row_bytes = static_cast<std::size_t>(frame.width) * 3;
+    std::vector<std::uint8_t> filtered((row_bytes + 1) * frame.height);
+    for (int y = 0; y < frame.height; ++y)
+    {
+        const std::uint8_t *row = frame.pixels.data() + row_bytes * y;
+        std::uint8_t *out = filtered.data() + (row_bytes + 1) * y;
+        out[0] = 1; // Sub
+        for (std::size_t i = 0; i < row_bytes; ++i)
+            out[1 + i] = static_cast<std::uint8_t>(row[i] - (i >= 3 ? row[i - 3] : 0));
+    }
+    uLongf compressed_size = compressBound(static_cast<uLong>(filtered.size()));
+    std::vector<std::uint8_t> compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, filtered.data(), static_cast<uLong>(filtered.size()),
+                  Z_BEST_SPEED) != Z_OK)
+        return false;
+
+    std::vector<std::uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<std::uint8_t> header;
+    put_u32(header, static_cast<std::uint32_t>(frame.width));
+    put_u32(header, static_cast<std::uint32_t>(frame.height));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, deflate, adaptive filtering, no interlace
+    append_png_chunk(png, "IHDR", header.data(), header.size());
+    append_png_chunk(png, "IDAT", compressed.data(), compressed_size);
+    append_png_chunk(png, "IEND", nullptr, 0);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+RawVideoWriter::~RawVideoWriter()
+{
+    close();
+}
+
+bool RawVideoWriter::open(const std::string &path)
+{
+    close();
+    failed_ = false;
+    frames_written_ = 0;
+    width_ = height_ = 0;
+    if (path == "-")
+    {
+        file_ = stdout;
+        owns_file_ = false;
+    }
+    else
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        owns_file_ = true;
+    }
+    return file_ != nullptr;
+}
+
+bool RawVideoWriter::write(const Framebuffer &frame)
+{
+    if (!file_)
+        return false;
+    if (frames_written_ == 0)
+    {
+        width_ = frame.width;
+        height_ = frame.height;
+    }
+    else if (frame.width != width_ || frame.height != height_)
+    {
+        return false;
+    }
+    if (std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), file_) != frame.pixels.size())
+    {
+        failed_ = true;
+        return false;
+    }
+    ++frames_written_;
+    return true;
+}
+
+bool RawVideoWriter::close()
+{
+    if (file_)
+    {
+        if (std::fflush(file_) != 0)
+            failed_ = true;
+        if (owns_file_ && std::fclose(file_) != 0)
+            failed_ = true;
+        file_ = nullptr;
+    }
+    return !failed_;
+}
+
+bool RawVideoWriter::is_open() const
+{
+    return file_ != nullptr;
+}
+
+long RawVideoWriter::get_frames_written() const
+{
+    return frames_written_;
+}
+
+FrameRenderer::FrameRenderer(const Graph &graph, int width, int height, std::size_t num_threads)
+    : graph_(graph),
+      grid_(graph),
+      pool_(num_threads),
+      origin_x_(0.0),
+      origin_y_(0.0),
+      scale_(1.0)
+{
+    frame_.resize(width, height);
+    tile_columns_ = (frame_.width + TILE_SIZE - 1) / TILE_SIZE;
+    tile_rows_ = (frame_.height + TILE_SIZE - 1) / TILE_SIZE;
+    tile_bins_.resize(static_cast<std::size_t>(tile_columns_) * tile_rows_);
+    edge_loads_.assign(grid_.edge_count(), 0);
+
+    for (std::size_t i = 0; i < grid_.edge_count(); ++i)
+    {
+        RoadEnds road{0.0, 0.0, 0.0, 0.0, false};
+        auto found = graph_.get_all_edges().find(grid_.get_edge_id(static_cast<int>(i)));
+        if (found != graph_.get_all_edges().end())
+        {
+            const Node *from = graph_.get_node(found->second.from_node_id);
+            const Node *to = graph_.get_node(found->second.to_node_id);
+            if (from && to)
+                road = RoadEnds{from->x, from->y, to->x, to->y, true};
+        }
+        roads_.push_back(road);
+    }
+    fit_view();
+}
+
+void FrameRenderer::set_view(const BoundingBox &area)
+{
+    const double width = std::max(area.max_x - area.min_x, 1e-9);
+    const double height = std::max(area.max_y - area.min_y, 1e-9);
+    scale_ = std::min(std::max(frame_.width, 1) / width, std::max(frame_.height, 1) / height);
+    // Centre the area; the other axis shows more than asked for
+    origin_x_ = (area.min_x + area.max_x) / 2 - frame_.width / 2.0 / scale_;
+    origin_y_ = (area.min_y + area.max_y) / 2 - frame_.height / 2.0 / scale_;
+}
+
+void FrameRenderer::fit_view()
+{
+    // Same margin as the Visualizer's fit_view
+    const double margin = INTERSECTION_RADIUS + SIGNAL_RING_THICKNESS + 10.0;
+    const BoundingBox &bounds = grid_.get_bounds();
+    set_view(BoundingBox{bounds.min_x - margin, bounds.min_y - margin, bounds.max_x + margin, bounds.max_y + margin});
+}
+
+const Framebuffer &FrameRenderer::get_frame() const
+{
+    return frame_;
+}
+
+float FrameRenderer::to_pixel_x(double x) const
+{
+    return static_cast<float>((x - origin_x_) * scale_);
+}
+
+float FrameRenderer::to_pixel_y(double y) const
+{
+    return static_cast<float>((y - origin_y_) * scale_);
+}
+
+void FrameRenderer::add_primitive(Primitive primitive)
+{
+    // Pixels whose centres the shape can cover
+    float left, top, right, bottom;
+    switch (primitive.kind)
+    {
+    case PrimitiveKind::SEGMENT:
+        left = std::min(primitive.x0, primitive.x1) - primitive.size;
+        right = std::max(primitive.x0, primitive.x1) + primitive.size;
+        top = std::min(primitive.y0, primitive.y1) - primitive.size;
+        bottom = std::max(primitive.y0, primitive.y1) + primitive.size;
+        break;
+    case PrimitiveKind::RECT:
+        left = primitive.x0;
+        right = primitive.x1;
+        top = primitive.y0;
+        bottom = primitive.y1;
+        break;
+    default: // DISK, RING
+        left = primitive.x0 - primitive.size;
+        right = primitive.x0 + primitive.size;
+        top = primitive.y0 - primitive.size;
+        bottom = primitive.y0 + primitive.size;
+        break;
+    }
+    primitive.min_x = std::max(0, static_cast<int>(std::floor(left - 0.5f)));
+    primitive.min_y = std::max(0, static_cast<int>(std::floor(top - 0.5f)));
+    primitive.max_x = std::min(frame_.width - 1, static_cast<int>(std::ceil(right - 0.5f)));
+    primitive.max_y = std::min(frame_.height - 1, static_cast<int>(std::ceil(bottom - 0.5f)));
+    if (primitive.min_x > primitive.max_x || primitive.min_y > primitive.max_y)
+        return; // Off the frame
+
+    const int index = static_cast<int>(primitives_.size());
+    primitives_.push_back(primitive);
+    for (int row = primitive.min_y / TILE_SIZE; row <= primitive.max_y / TILE_SIZE; ++row)
+        for (int column = primitive.min_x / TILE_SIZE; column <= primitive.max_x / TILE_SIZE; ++column)
+            tile_bins_[static_cast<std::size_t>(row) * tile_columns_ + column].push_back(index);
+}
+
+void FrameRenderer::add_road(int edge_index, float half_width, Rgba color)
+{
+    const RoadEnds &road = roads_[static_cast<std::size_t>(edge_index)];
+    if (!road.valid)
+        return;
+    add_primitive(Primitive{PrimitiveKind::SEGMENT, to_pixel_x(road.x0), to_pixel_y(road.y0), to_pixel_x(road.x1),
+                            to_pixel_y(road.y1), half_width, color, 0, 0, 0, 0});
+}
+
+void FrameRenderer::build_scene(const StateSnapshot &snapshot)
+{
+    primitives_.clear();
+    for (std::vector<int> &bin : tile_bins_)
+        bin.clear(); // Keeps its capacity
+
+    const double pad = INTERSECTION_RADIUS + SIGNAL_RING_THICKNESS;
+    const BoundingBox area{origin_x_ - pad, origin_y_ - pad, origin_x_ + frame_.width / scale_ + pad,
+                           origin_y_ + frame_.height / scale_ + pad};
+    const float pixels_per_unit = static_cast<float>(scale_);
+    const bool whole_network = area.contains(grid_.get_bounds());
+    const bool show_nodes = NODE_RADIUS * pixels_per_unit >= MIN_DETAIL_PIXELS;
+    const bool show_vehicles = VEHICLE_HALF_SIZE * pixels_per_unit >= MIN_DETAIL_PIXELS;
+
+    // Back to front, as the Visualizer draws: roads, nodes, intersections, vehicles
+    grid_.query_edges(area, visible_edges_);
+    std::sort(visible_edges_.begin(), visible_edges_.end()); // Scene order independent of the grid
+    for (int edge : visible_edges_)
+        add_road(edge, ROAD_THICKNESS / 2 * pixels_per_unit, ROAD_COLOR);
+    if (show_nodes)
+    {
+        grid_.query_nodes(area, visible_nodes_);
+        std::sort(visible_nodes_.begin(), visible_nodes_.end());
+        for (int node_index : visible_nodes_)
+        {
+            const Node *node = graph_.get_node(grid_.get_node_id(node_index));
+            add_primitive(Primitive{PrimitiveKind::DISK, to_pixel_x(node->x), to_pixel_y(node->y), 0.f, 0.f,
+                                    NODE_RADIUS * pixels_per_unit, NODE_COLOR, 0, 0, 0, 0});
+        }
+
+        auto add_signal = [&](const StateSnapshot::SignalLight &light)
+        {
+            const float x = to_pixel_x(light.x), y = to_pixel_y(light.y);
+            add_primitive(Primitive{PrimitiveKind::DISK, x, y, 0.f, 0.f, INTERSECTION_RADIUS * pixels_per_unit,
+                                    INTERSECTION_COLOR, 0, 0, 0, 0});
+            add_primitive(Primitive{PrimitiveKind::RING, x, y, INTERSECTION_RADIUS * pixels_per_unit, 0.f,
+                                    (INTERSECTION_RADIUS + SIGNAL_RING_THICKNESS) * pixels_per_unit,
+                                    signal_color(light), 0, 0, 0, 0});
+        };
+        if (whole_network)
+        {
+            for (const StateSnapshot::SignalLight &light : snapshot.signals)
+                add_signal(light);
+        }
+        else
+        {
+            for (int node_index : visible_nodes_)
+            {
+                const int id = grid_.get_node_id(node_index);
+                auto found = std::lower_bound(snapshot.signals.begin(), snapshot.signals.end(), id,
+                                              [](const StateSnapshot::SignalLight &light, int key)
+                                              { return light.intersection_id < key; });
+                if (found != snapshot.signals.end() && found->intersection_id == id)
+                    add_signal(*found);
+            }
+        }
+    }
+
+    if (show_vehicles)
+    {
+        const float h = VEHICLE_HALF_SIZE * pixels_per_unit;
+        for (const StateSnapshot::VehiclePosition &vehicle : snapshot.vehicles)
+        {
+            const float x = to_pixel_x(vehicle.x), y = to_pixel_y(vehicle.y);
+            add_primitive(Primitive{PrimitiveKind::RECT, x - h, y - h, x + h, y + h, 0.f, VEHICLE_COLOR, 0, 0, 0, 0});
+        }
+        return;
+    }
+
+    // Zoomed out: visible edges colored by vehicle density instead of sub-pixel vehicles
+    for (const StateSnapshot::VehiclePosition &vehicle : snapshot.vehicles)
+    {
+        const int edge = grid_.find_edge_index(vehicle.edge_id);
+        if (edge >= 0 && grid_.get_edge_bounds(edge).intersects(area)) // Only counts that get reset below
+            ++edge_loads_[static_cast<std::size_t>(edge)];
+    }
+    const float half_width = std::max(ROAD_THICKNESS * pixels_per_unit, MIN_DENSITY_ROAD_PIXELS) / 2;
+    for (int edge : visible_edges_)
+    {
+        int &load = edge_loads_[static_cast<std::size_t>(edge)];
+        if (load == 0)
+            continue;
+        const RoadEnds &road = roads_[static_cast<std::size_t>(edge)];
+        const double length = std::hypot(road.x1 - road.x0, road.y1 - road.y0);
+        add_road(edge, half_width, density_color(load / std::max(1.f, static_cast<float>(length) / JAM_SPACING)));
+        load = 0; // Ready for the next frame
+    }
+}
+
+void FrameRenderer::rasterize_tile(std::size_t tile)
+{
+    const int tile_x = static_cast<int>(tile % tile_columns_) * TILE_SIZE;
+    const int tile_y = static_cast<int>(tile / tile_columns_) * TILE_SIZE;
+    const int tile_right = std::min(tile_x + TILE_SIZE, frame_.width) - 1;
+    const int tile_bottom = std::min(tile_y + TILE_SIZE, frame_.height) - 1;
+    const std::size_t stride = static_cast<std::size_t>(frame_.width) * 3;
+
+    for (int y = tile_y; y <= tile_bottom; ++y)
+    {
+        std::uint8_t *out = frame_.pixels.data() + stride * y + static_cast<std::size_t>(tile_x) * 3;
+        for (int x = tile_x; x <= tile_right; ++x, out += 3)
+        {
+            out[0] = BACKGROUND_COLOR.r;
+            out[1] = BACKGROUND_COLOR.g;
+            out[2] = BACKGROUND_COLOR.b;
+        }
+    }
+
+    // A pixel is covered when its centre is inside the shape
+    for (int index : tile_bins_[tile])
+    {
+        const Primitive &p = primitives_[static_cast<std::size_t>(index)];
+        const int x_begin = std::max(p.min_x, tile_x), x_end = std::min(p.max_x, tile_right);
+        const int y_begin = std::max(p.min_y, tile_y), y_end = std::min(p.max_y, tile_bottom);
+        const float size_squared = p.size * p.size;
+        // Segment direction, for the projection of pixel centres onto the centre line
+        const float dx = p.x1 - p.x0, dy = p.y1 - p.y0;
+        const float length_squared = dx * dx + dy * dy;
+        for (int y = y_begin; y <= y_end; ++y)
+        {
+            const float py = y + 0.5f;
+            std::uint8_t *out = frame_.pixels.data() + stride * y + static_cast<std::size_t>(x_begin) * 3;
+            for (int x = x_begin; x <= x_end; ++x, out += 3)
+            {
+                const float px = x + 0.5f;
+                bool covered = false;
+                switch (p.kind)
+                {
+                case PrimitiveKind::SEGMENT:
+                {
+                    if (length_squared <= 0.f)
+                        break;
+                    const float along = (px - p.x0) * dx + (py - p.y0) * dy;
+                    const float across = (px - p.x0) * dy - (py - p.y0) * dx;
+                    covered = along >= 0.f && along <= length_squared &&
+                              across * across <= size_squared * length_squared;
+                    break;
+                }
+                case PrimitiveKind::DISK:
+                    covered = (px - p.x0) * (px - p.x0) + (py - p.y0) * (py - p.y0) <= size_squared;
+                    break;
+                case PrimitiveKind::RING:
+                {
+                    const float distance_squared = (px - p.x0) * (px - p.x0) + (py - p.y0) * (py - p.y0);
+                    covered = distance_squared > p.x1 * p.x1 && distance_squared <= size_squared;
+                    break;
+                }
+                case PrimitiveKind::RECT:
+                    covered = px >= p.x0 && px < p.x1 && py >= p.y0 && py < p.y1;
+                    break;
+                }
+                if (covered)
+                    put_pixel(out, p.color);
+            }
+        }
+    }
+}
+
+const Framebuffer &FrameRenderer::render(const StateSnapshot &snapshot)
+{
+    TRACE_SCOPE("render_frame");
+    build_scene(snapshot);
+    pool_.parallel_for(tile_bins_.size(), [this](std::size_t tile)
+                       { rasterize_tile(tile); });
+    return frame_;
+}
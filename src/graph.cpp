@@ -1,6 +1,9 @@
 #include "graph.hpp"
+#include "utils.hpp"
 
 #include <algorithm> // For std::reverse
+#include <cctype>    // For std::isspace
+#include <cmath>     // For std::cos, std::sin
 #include <iostream>  // For error reporting
 #include <limits>    // For std::numeric_limits
 #include <queue>     // For std::priority_queue
@@ -185,10 +188,96 @@ std::vector<int> Graph::find_shortest_path(int start_node_id, int end_node_id) c
     return path;
 }
 
+namespace
+{
+    // Splits a line into whitespace-separated tokens (views into the line)
+    void split_tokens(std::string_view line, std::vector<std::string_view> &tokens)
+    {
+        tokens.clear();
+        std::size_t pos = 0;
+        while (pos < line.size())
+        {
+            while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos])))
+                pos++;
+            std::size_t start = pos;
+            while (pos < line.size() && !std::isspace(static_cast<unsigned char>(line[pos])))
+                pos++;
+            if (pos > start)
+                tokens.push_back(line.substr(start, pos - start));
+        }
+    }
+}
+
 bool Graph::load_from_file(const std::string &filepath)
 {
-    std::cerr << "Warning: Graph::load_from_file(" << filepath << ") is not implemented." << std::endl;
-    return false;
+    clear();
+    std::vector<std::string_view> tokens;
+    std::vector<int> unplaced_nodes; // Nodes listed without coordinates
+    int line_number = 0;
+    bool valid = true;
+
+    bool opened = Utils::for_each_line(filepath, [&](std::string_view line)
+                                       {
+        line_number++;
+        split_tokens(line, tokens);
+        if (!valid || tokens.empty() || tokens[0].front() == '#')
+            return;
+
+        int id = 0, from = 0, to = 0;
+        double x = 0.0, y = 0.0, weight = 0.0;
+        const char *problem = nullptr;
+        if (tokens[0] == "N" && (tokens.size() == 2 || tokens.size() == 4))
+        {
+            bool has_position = tokens.size() == 4;
+            if (!Utils::parse_int(tokens[1], id) ||
+                (has_position && (!Utils::parse_double(tokens[2], x) || !Utils::parse_double(tokens[3], y))))
+                problem = "malformed node";
+            else if (!add_node(id, x, y))
+                problem = "duplicate node id";
+            else if (!has_position)
+                unplaced_nodes.push_back(id);
+        }
+        else if (tokens[0] == "E" && tokens.size() == 5)
+        {
+            if (!Utils::parse_int(tokens[1], id) || !Utils::parse_int(tokens[2], from) ||
+                !Utils::parse_int(tokens[3], to) || !Utils::parse_double(tokens[4], weight))
+                problem = "malformed edge";
+            else if (!add_edge(id, from, to, weight))
+                problem = "duplicate edge id or unknown node";
+        }
+        else
+        {
+            problem = "unknown entry";
+        }
+
+        if (problem)
+        {
+            std::cerr << "Error: " << filepath << ":" << line_number << ": " << problem << ": '" << line << "'" << std::endl;
+            valid = false;
+        } });
+
+    if (!opened)
+    {
+        std::cerr << "Error: Could not read map file: " << filepath << std::endl;
+        clear();
+        return false;
+    }
+    if (!valid)
+    {
+        clear();
+        return false;
+    }
+
+    // Nodes without coordinates are spread evenly on a circle so they can still be drawn
+    const double pi = 3.14159265358979323846;
+    for (std::size_t i = 0; i < unplaced_nodes.size(); ++i)
+    {
+        double angle = 2.0 * pi * static_cast<double>(i) / static_cast<double>(unplaced_nodes.size());
+        Node &node = nodes_[unplaced_nodes[i]];
+        node.x = UNPLACED_LAYOUT_RADIUS * std::cos(angle);
+        node.y = UNPLACED_LAYOUT_RADIUS * std::sin(angle);
+    }
+    return true;
 }
 
 void Graph::clear()
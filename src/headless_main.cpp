@@ -0,0 +1,367 @@
+// Headless simulation runner: no window and no SFML, so it runs on display-less
+// machines and ticks as fast as the core allows.
+// Usage: traffic_sim_headless [--scenario path | --grid ROWS COLS | --geometric NODES]
+//                             [--ticks N] [--seed S] [--vehicles N] [--record path]
+//                             [--profile] [--trace path] [--replicas K [--threads N]]
+//                             [--frames DIR [--frame-format png|ppm]] [--video path|-]
+//                             [--frame-size WxH] [--frame-every K] [--threads N]
+//                             [--serve path]
+// Simulates a scenario file (see scenario.hpp), a generated network or, by default, the
+// demo city of traffic_sim. --ticks and --seed override the scenario's values (defaults
+// without a scenario: 10000 ticks, seed 1). --vehicles adds that many vehicles on random
+// shared routes before the first tick (see NetworkGenerator::add_vehicles). After the
+// run it prints ticks/sec, vehicles processed per second (the vehicle count summed over
+// all ticks) and the peak resident set size. With --replicas, K replicas seeded S, S+1, ...
+// run in parallel instead (see EnsembleRunner) and the outcomes are printed with their
+// 95% confidence intervals.
+// --frames and --video render every K-th tick (default 1) off-screen with FrameRenderer at
+// WxH (default 1920x1080): --frames writes DIR/frame_000000.png, ... and --video a raw
+// RGB24 stream ("-" pipes it to standard output, and the report goes to standard error).
+// --threads sets the renderer's threads as well. Ticks/sec excludes rendering, which is
+// reported on its own.
+// --serve streams the state after every tick to clients of a Unix domain socket at that
+// path (see StateServer); clients that connect late or read slowly get the latest state.
+#include <sys/resource.h> // For getrusage
+#include <chrono>
+#include <cstdio> // For std::snprintf
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "demo_network.hpp"
+#include "ensemble.hpp"
+#include "frame_renderer.hpp"
+#include "network_generator.hpp"
+#include "scenario.hpp"
+#include "simulation.hpp"
+#include "simulation_thread.hpp"
+#include "state_server.hpp"
+#include "trace.hpp"
+#include "trajectory_recorder.hpp"
+
+namespace
+{
+    // Frames buffered for the trajectory writer; headless runs produce frames much
+    // faster than the windowed one, so the ring is deeper than the recorder's default
+    const std::size_t RECORD_RING_CAPACITY = 256;
+
+    // Shared routes for --vehicles, bounding route planning for large populations
+    const int VEHICLE_ROUTES = 4096;
+
+    void print_usage()
+    {
+        std::cerr << "Usage: traffic_sim_headless [--scenario path | --grid ROWS COLS | --geometric NODES]\n"
+                  << "                            [--ticks N] [--seed S] [--vehicles N] [--record path]\n"
+                  << "                            [--profile] [--trace path] [--replicas K [--threads N]]\n"
+                  << "                            [--frames DIR [--frame-format png|ppm]] [--video path|-]\n"
+                  << "                            [--frame-size WxH] [--frame-every K] [--threads N]\n"
+                  << "                            [--serve path]" << std::endl;
+    }
+
+    // Parses "WxH" with both sides positive
+    bool parse_frame_size(const std::string &text, int &width, int &height)
+    {
+        std::size_t x = text.find('x');
+        if (x == std::string::npos)
+            return false;
+        width = std::atoi(text.substr(0, x).c_str());
+        height = std::atoi(text.substr(x + 1).c_str());
+        return width > 0 && height > 0;
+    }
+
+    // Peak resident set size of this process in kilobytes
+    long peak_rss_kb()
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    long ticks = 0; // 0: from the scenario, or 10000
+    bool seed_given = false;
+    unsigned int seed = 1;
+    std::string scenario_path;
+    int grid_rows = 0, grid_cols = 0, geometric_nodes = 0;
+    int extra_vehicles = 0;
+    std::string record_path, trace_path;
+    bool profile = false;
+    int replicas = 0;
+    std::size_t threads = 0; // Every core
+    std::string frames_dir, video_path, frame_format = "png";
+    std::string serve_path;
+    int frame_width = 1920, frame_height = 1080;
+    long frame_every = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--scenario" && i + 1 < argc)
+            scenario_path = argv[++i];
+        else if (arg == "--ticks" && i + 1 < argc)
+        {
+            ticks = std::atol(argv[++i]);
+            if (ticks <= 0)
+            {
+                print_usage();
+                return 2;
+            }
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            seed_given = true;
+        }
+        else if (arg == "--grid" && i + 2 < argc)
+        {
+            grid_rows = std::atoi(argv[++i]);
+            grid_cols = std::atoi(argv[++i]);
+        }
+        else if (arg == "--geometric" && i + 1 < argc)
+            geometric_nodes = std::atoi(argv[++i]);
+        else if (arg == "--vehicles" && i + 1 < argc)
+            extra_vehicles = std::atoi(argv[++i]);
+        else if (arg == "--record" && i + 1 < argc)
+            record_path = argv[++i];
+        else if (arg == "--profile")
+            profile = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (arg == "--replicas" && i + 1 < argc)
+            replicas = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = static_cast<std::size_t>(std::atoi(argv[++i]));
+        else if (arg == "--frames" && i + 1 < argc)
+            frames_dir = argv[++i];
+        else if (arg == "--frame-format" && i + 1 < argc)
+            frame_format = argv[++i];
+        else if (arg == "--video" && i + 1 < argc)
+            video_path = argv[++i];
+        else if (arg == "--frame-size" && i + 1 < argc)
+        {
+            if (!parse_frame_size(argv[++i], frame_width, frame_height))
+            {
+                print_usage();
+                return 2;
+            }
+        }
+        else if (arg == "--frame-every" && i + 1 < argc)
+            frame_every = std::atol(argv[++i]);
+        else if (arg == "--serve" && i + 1 < argc)
+            serve_path = argv[++i];
+        else
+        {
+            print_usage();
+            return 2;
+        }
+    }
+    if ((grid_rows > 0) != (grid_cols > 0) ||
+        (grid_rows > 0) + (geometric_nodes > 0) + !scenario_path.empty() > 1 ||
+        (replicas > 0 && (!record_path.empty() || profile || !frames_dir.empty() || !video_path.empty() ||
+                          !serve_path.empty())) ||
+        (frame_format != "png" && frame_format != "ppm") || frame_every <= 0)
+    {
+        print_usage();
+        return 2;
+    }
+#ifndef TRAFFICSIM_PROFILING
+    if (profile)
+        std::cerr << "Warning: --profile has no effect: tick profiling was compiled out (build with PROFILING=1)."
+                  << std::endl;
+#endif
+#ifndef TRAFFICSIM_TRACING
+    if (!trace_path.empty())
+        std::cerr << "Warning: --trace records no simulation events: tracing was compiled out (build with TRACING=1)."
+                  << std::endl;
+#endif
+
+    Simulation sim(seed);
+    std::string network_name = "demo";
+    if (!scenario_path.empty())
+    {
+        Scenario scenario;
+        if (!load_scenario(scenario_path, scenario))
+            return 1;
+        if (seed_given)
+            scenario.seed = seed;
+        seed = scenario.seed;
+        if (ticks == 0)
+            ticks = scenario.ticks;
+        apply_scenario(sim, scenario);
+        network_name = "scenario " + scenario.name;
+    }
+    else if (grid_rows > 0)
+    {
+        NetworkGenerator::install(sim, NetworkGenerator::make_grid(grid_rows, grid_cols));
+        network_name = "grid " + std::to_string(grid_rows) + "x" + std::to_string(grid_cols);
+    }
+    else if (geometric_nodes > 0)
+    {
+        NetworkGenerator::install(sim, NetworkGenerator::make_random_geometric(geometric_nodes, 6.0, seed));
+        network_name = "geometric " + std::to_string(geometric_nodes);
+    }
+    else
+    {
+        setup_demo_network(sim);
+    }
+    if (ticks == 0)
+        ticks = 10000;
+    if (extra_vehicles > 0)
+        NetworkGenerator::add_vehicles(sim, extra_vehicles, seed, 2000000, VEHICLE_ROUTES); // Ids clear of a scenario's vehicles
+    sim.set_profiling_enabled(profile);
+
+    if (replicas > 0)
+    {
+        if (!trace_path.empty() && !Tracing::start(trace_path))
+        {
+            std::cerr << "Error: Could not start tracing to '" << trace_path << "'." << std::endl;
+            return 1;
+        }
+        std::cout << "Running " << replicas << " replicas of " << network_name << " for " << ticks
+                  << " ticks, seeds " << seed << ".." << seed + replicas - 1 << "..." << std::endl;
+        EnsembleRunner runner(sim, threads);
+        EnsembleResult result = runner.run(replicas, static_cast<int>(ticks), seed);
+        if (!trace_path.empty() && !Tracing::stop())
+            std::cerr << "Error: Could not write trace '" << trace_path << "'." << std::endl;
+        std::cout << result.to_string() << "Routes planned: " << runner.get_route_cache().get_misses()
+                  << " (" << runner.get_route_cache().get_hits() << " shared)\n"
+                  << "Peak RSS:         " << std::fixed << std::setprecision(1) << peak_rss_kb() / 1024.0 << " MB"
+                  << std::endl;
+        return 0;
+    }
+
+    // With the video on standard output, the report must not end up in the stream
+    std::ostream &out = video_path == "-" ? std::cerr : std::cout;
+    const bool rendering = !frames_dir.empty() || !video_path.empty();
+    std::unique_ptr<FrameRenderer> renderer;
+    RawVideoWriter video;
+    StateSnapshot snapshot;
+    if (rendering)
+    {
+        renderer = std::make_unique<FrameRenderer>(sim.get_graph(), frame_width, frame_height, threads);
+        if (!video_path.empty() && !video.open(video_path))
+        {
+            std::cerr << "Error: Could not create video '" << video_path << "'." << std::endl;
+            return 1;
+        }
+    }
+
+    StateServer state_server;
+    if (!serve_path.empty())
+    {
+        if (!state_server.start(serve_path))
+        {
+            std::cerr << "Error: Could not listen on '" << serve_path << "'." << std::endl;
+            return 1;
+        }
+        state_server.publish(sim, sim.get_graph()); // Clients see the network before the first tick
+        out << "Streaming state to clients of " << serve_path << std::endl;
+    }
+
+    TrajectoryRecorder recorder;
+    if (!record_path.empty())
+    {
+        if (!recorder.open(record_path, TrajectoryRecorder::DEFAULT_KEYFRAME_INTERVAL, RECORD_RING_CAPACITY))
+        {
+            std::cerr << "Error: Could not create trajectory log '" << record_path << "'." << std::endl;
+            return 1;
+        }
+        sim.set_frame_capture(true); // The recorder copies the frame tick() captured
+    }
+    if (!trace_path.empty() && !Tracing::start(trace_path))
+    {
+        std::cerr << "Error: Could not start tracing to '" << trace_path << "'." << std::endl;
+        return 1;
+    }
+
+    out << "Simulating " << network_name << " (" << sim.get_graph().get_all_nodes().size() << " nodes, "
+        << sim.get_vehicles().size() << " vehicles) for " << ticks << " ticks, seed " << seed << "..." << std::endl;
+    long vehicle_updates = 0;
+    long frames_rendered = 0;
+    bool frame_error = false;
+    double render_seconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; ++t)
+    {
+        vehicle_updates += static_cast<long>(sim.get_vehicles().size());
+        sim.tick();
+        if (recorder.is_open())
+            recorder.record(sim);
+        if (state_server.is_running())
+            state_server.publish(sim, sim.get_graph());
+        if (rendering && t % frame_every == 0 && !frame_error)
+        {
+            auto render_start = std::chrono::steady_clock::now();
+            snapshot.capture(sim, sim.get_graph());
+            const Framebuffer &frame = renderer->render(snapshot);
+            if (!frames_dir.empty())
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame_%06ld.", frames_rendered);
+                std::string path = frames_dir + name + frame_format;
+                if (!(frame_format == "png" ? write_png(path, frame) : write_ppm(path, frame)))
+                {
+                    std::cerr << "Error: Could not write frame '" << path << "'." << std::endl;
+                    frame_error = true;
+                }
+            }
+            if (video.is_open() && !video.write(frame))
+            {
+                std::cerr << "Error: Writing video '" << video_path << "' failed." << std::endl;
+                frame_error = true;
+            }
+            ++frames_rendered;
+            render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - render_start).count();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - render_seconds;
+    seconds = seconds > 0.0 ? seconds : 1e-9;
+
+    if (!trace_path.empty() && !Tracing::stop())
+        std::cerr << "Error: Could not write trace '" << trace_path << "'." << std::endl;
+    if (recorder.is_open())
+    {
+        recorder.close();
+        out << "Recorded " << recorder.get_frames_written() << " frames (" << recorder.get_frames_dropped()
+            << " dropped, " << recorder.get_bytes_written() << " bytes) to " << record_path << std::endl;
+        if (recorder.has_write_error())
+        {
+            std::cerr << "Error: Writing '" << record_path << "' failed." << std::endl;
+            return 1;
+        }
+    }
+
+    if (state_server.is_running())
+    {
+        state_server.stop();
+        out << "Streamed " << state_server.get_updates_sent() << " updates (" << state_server.get_updates_skipped()
+            << " skipped for slow clients, " << state_server.get_bytes_sent() << " bytes)" << std::endl;
+    }
+    if (video.is_open() && !video.close())
+    {
+        std::cerr << "Error: Writing video '" << video_path << "' failed." << std::endl;
+        frame_error = true;
+    }
+
+    out << std::fixed << std::setprecision(1)
+        << "Ticks:            " << ticks << " in " << std::setprecision(3) << seconds << " s\n"
+        << std::setprecision(1)
+        << "Ticks/sec:        " << ticks / seconds << "\n"
+        << "Vehicles/sec:     " << vehicle_updates / seconds << " (" << vehicle_updates << " vehicle updates)\n"
+        << "Vehicles at end:  " << sim.get_vehicles().size() << "\n";
+    if (rendering)
+        out << "Frames:           " << frames_rendered << " at " << frame_width << "x" << frame_height << " in "
+            << std::setprecision(3) << render_seconds << " s (" << std::setprecision(1)
+            << frames_rendered / (render_seconds > 0.0 ? render_seconds : 1e-9) << " frames/sec)\n";
+    out << "Peak RSS:         " << peak_rss_kb() / 1024.0 << " MB" << std::endl;
+    if (profile)
+        out << sim.get_profiler()->report().to_string();
+    return frame_error ? 1 : 0;
+}
@@ -13,7 +13,8 @@ std::string light_state_to_string(LightState state) {
 
 // Default constructor
 Intersection::Intersection()
-    : id_(-1), current_green_approach_index_(-1), ticks_in_current_state_(0), phase_state_(LightState::RED) {}
+    : id_(-1), current_green_approach_index_(-1), ticks_in_current_state_(0),
+      yellow_duration_(YELLOW_DURATION), pending_offset_(0), phase_state_(LightState::RED) {}
 
 // Constructor with ID and approach_ids
 Intersection::Intersection(int id, const std::vector<int>& approach_ids)
@@ -21,6 +22,8 @@ Intersection::Intersection(int id, const std::vector<int>& approach_ids)
       approach_ids_(approach_ids),
       current_green_approach_index_(-1), // No green initially
       ticks_in_current_state_(0),
+      yellow_duration_(YELLOW_DURATION),
+      pending_offset_(0),
       phase_state_(LightState::RED) { // Start with all red or first one green after first update
     if (!approach_ids_.empty()) {
         current_green_approach_index_ = 0; // Default to first approach if any
@@ -67,7 +70,7 @@ void Intersection::update_signal_state() {
     int current_green_id = approach_ids_[current_green_approach_index_];
 
     if (phase_state_ == LightState::GREEN) {
-        if (ticks_in_current_state_ >= GREEN_DURATION) {
+        if (ticks_in_current_state_ >= get_green_duration(current_green_id)) {
             // Time to switch from GREEN to YELLOW
             current_signals_[current_green_id] = LightState::YELLOW;
             phase_state_ = LightState::YELLOW;
@@ -75,7 +78,7 @@ void Intersection::update_signal_state() {
         }
         // Else, stay GREEN
     } else if (phase_state_ == LightState::YELLOW) {
-        if (ticks_in_current_state_ >= YELLOW_DURATION) {
+        if (ticks_in_current_state_ >= yellow_duration_) {
             // Time to switch from YELLOW to RED, and pick next GREEN
             current_signals_[current_green_id] = LightState::RED; // Old green becomes red
 
@@ -106,6 +109,12 @@ void Intersection::update_signal_state() {
                 current_signals_[approach_id] = LightState::RED;
             }
         }
+        // Fast-forward through the plan offset so coordinated signals start mid-cycle
+        int offset = pending_offset_;
+        pending_offset_ = 0;
+        for (int i = 0; i < offset; ++i) {
+            update_signal_state();
+        }
     }
 }
 
@@ -131,6 +140,22 @@ const std::queue<int>& Intersection::get_vehicle_queue(int approach_id) const {
     throw std::out_of_range("Queried queue for unknown approach_id: " + std::to_string(approach_id));
 }
 
+namespace {
+// std::queue hides its container; a derived type may name the protected member to read it.
+struct QueueContents : std::queue<int> {
+    static const std::deque<int>& of(const std::queue<int>& queue) {
+        return queue.*(&QueueContents::c);
+    }
+};
+}
+
+void Intersection::append_queued_vehicle_ids(int approach_id, std::vector<int>& out) const {
+    auto it = vehicle_queues_.find(approach_id);
+    if (it == vehicle_queues_.end()) return;
+    const std::deque<int>& contents = QueueContents::of(it->second);
+    out.insert(out.end(), contents.begin(), contents.end());
+}
+
 const std::vector<int>& Intersection::get_approach_ids() const {
     return approach_ids_;
 }
@@ -143,3 +168,64 @@ int Intersection::pop_vehicle_from_queue(int approach_id) {
     }
     return -1; // Queue empty or approach_id does not exist
 }
+
+void Intersection::set_timing_plan(const SignalTimingPlan& plan) {
+    green_durations_.clear();
+    for (const auto& pair : plan.green_durations) {
+        if (current_signals_.count(pair.first) && pair.second > 0) {
+            green_durations_[pair.first] = pair.second;
+        }
+    }
+    yellow_duration_ = plan.yellow_duration > 0 ? plan.yellow_duration : YELLOW_DURATION;
+
+    int cycle = 0;
+    for (int approach_id : approach_ids_) {
+        cycle += get_green_duration(approach_id) + yellow_duration_;
+    }
+    pending_offset_ = (cycle > 0 && plan.offset > 0) ? plan.offset % cycle : 0;
+}
+
+int Intersection::get_green_duration(int approach_id) const {
+    auto it = green_durations_.find(approach_id);
+    return it != green_durations_.end() ? it->second : GREEN_DURATION;
+}
+
+int Intersection::get_yellow_duration() const {
+    return yellow_duration_;
+}
+
+void Intersection::request_phase_switch() {
+    if (approach_ids_.empty() || phase_state_ != LightState::GREEN) return;
+
+    current_signals_[approach_ids_[current_green_approach_index_]] = LightState::YELLOW;
+    phase_state_ = LightState::YELLOW;
+    ticks_in_current_state_ = 0;
+}
+
+int Intersection::get_current_green_approach_index() const {
+    return current_green_approach_index_;
+}
+
+LightState Intersection::get_phase_state() const {
+    return phase_state_;
+}
+
+int Intersection::get_ticks_in_current_state() const {
+    return ticks_in_current_state_;
+}
+
+void Intersection::restore_phase(int green_approach_index, LightState phase, int ticks_in_state) {
+    if (green_approach_index < 0 || green_approach_index >= static_cast<int>(approach_ids_.size())) return;
+
+    current_green_approach_index_ = green_approach_index;
+    phase_state_ = phase;
+    ticks_in_current_state_ = ticks_in_state;
+    pending_offset_ = 0;
+    for (int approach_id : approach_ids_) {
+        current_signals_[approach_id] = LightState::RED;
+    }
+    // Before the first update every approach is RED, as in the constructor
+    if (phase != LightState::RED) {
+        current_signals_[approach_ids_[green_approach_index]] = phase;
+    }
+}
@@ -1,59 +1,77 @@
 #include <SFML/Graphics.hpp>
+#include <iostream>
+#include <string>
+#include <utility> // For std::move
+#include "demo_network.hpp"
+#include "render_style.hpp"
+#include "scenario.hpp"
 #include "simulation.hpp"
+#include "simulation_thread.hpp"
+#include "state_server.hpp"
+#include "trajectory_replay.hpp"
 #include "visualizer.hpp"
 
-void setup_simulation(Simulation &sim)
+// Ticks skipped per Left/Right key press while replaying a recorded run
+const int REPLAY_SEEK_TICKS = 300;
+// Simulation speed at 1x: one tick per frame at the window's frame rate limit
+const double REALTIME_TICKS_PER_SECOND = 60.0;
+
+// Usage: traffic_sim [--scenario <scenario file>] [--replay <trajectory log>] [--serve <socket path>]
+// Simulates the scenario (see scenario.hpp) for its number of ticks, or the built-in demo
+// city until the window is closed. Drag to pan, scroll to zoom and Home to see the whole
+// network again. The simulation runs on its own thread: Up/Down double or halve its
+// speed, U toggles running it as fast as possible and Space pauses it. With
+// --replay, a run recorded by TrajectoryRecorder on the same network is played back
+// instead of simulating; Left/Right seek backwards/forwards. --serve streams the live
+// state to clients of a Unix domain socket at that path (see StateServer).
+int main(int argc, char *argv[])
 {
-    Graph g;
-    g.add_node(1, 100, 100);
-    g.add_node(2, 500, 100);
-    g.add_node(3, 900, 100);
-    g.add_node(4, 100, 400);
-    g.add_node(5, 500, 400);
-    g.add_node(6, 900, 400);
-    g.add_node(7, 100, 700);
-    g.add_node(8, 500, 700);
-    g.add_node(9, 900, 700);
+    std::string scenario_path, replay_path, serve_path;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--scenario" && i + 1 < argc)
+            scenario_path = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (arg == "--serve" && i + 1 < argc)
+            serve_path = argv[++i];
+        else
+        {
+            std::cerr << "Usage: traffic_sim [--scenario <scenario file>] [--replay <trajectory log>]"
+                      << " [--serve <socket path>]" << std::endl;
+            return 2;
+        }
+    }
+    if (!replay_path.empty() && !serve_path.empty())
+    {
+        std::cerr << "Error: --serve streams a live simulation and can't be combined with --replay." << std::endl;
+        return 2;
+    }
 
-    g.add_edge(12, 1, 2, 80);
-    g.add_edge(21, 2, 1, 80);
-    g.add_edge(23, 2, 3, 80);
-    g.add_edge(32, 3, 2, 80);
-    g.add_edge(45, 4, 5, 80);
-    g.add_edge(54, 5, 4, 80);
-    g.add_edge(56, 5, 6, 80);
-    g.add_edge(65, 6, 5, 80);
-    g.add_edge(78, 7, 8, 80);
-    g.add_edge(87, 8, 7, 80);
-    g.add_edge(89, 8, 9, 80);
-    g.add_edge(98, 9, 8, 80);
-    g.add_edge(14, 1, 4, 60);
-    g.add_edge(41, 4, 1, 60);
-    g.add_edge(25, 2, 5, 60);
-    g.add_edge(52, 5, 2, 60);
-    g.add_edge(36, 3, 6, 60);
-    g.add_edge(63, 6, 3, 60);
-    g.add_edge(47, 4, 7, 60);
-    g.add_edge(74, 7, 4, 60);
-    g.add_edge(58, 5, 8, 60);
-    g.add_edge(85, 8, 5, 60);
-    g.add_edge(69, 6, 9, 60);
-    g.add_edge(96, 9, 6, 60);
-    sim.set_graph(g);
+    TrajectoryReplay replay;
+    const bool replaying = !replay_path.empty();
+    if (replaying && !replay.open(replay_path))
+    {
+        std::cerr << "Error: Could not read trajectory log '" << replay_path << "'." << std::endl;
+        return 1;
+    }
 
-    sim.add_intersection(Intersection(1, {12, 14}));
-    sim.add_intersection(Intersection(2, {21, 23, 25}));
-    sim.add_intersection(Intersection(3, {32, 36}));
-    sim.add_intersection(Intersection(4, {41, 45, 47}));
-    sim.add_intersection(Intersection(5, {52, 54, 56, 58}));
-    sim.add_intersection(Intersection(6, {63, 65, 69}));
-    sim.add_intersection(Intersection(7, {74, 78}));
-    sim.add_intersection(Intersection(8, {85, 87, 89}));
-    sim.add_intersection(Intersection(9, {96, 98}));
-}
+    Simulation sim;
+    int run_ticks = -1; // Unlimited
+    if (!scenario_path.empty())
+    {
+        Scenario scenario;
+        if (!load_scenario(scenario_path, scenario))
+            return 1;
+        apply_scenario(sim, scenario);
+        run_ticks = scenario.ticks;
+    }
+    else
+    {
+        setup_demo_network(sim);
+    }
 
-int main()
-{
     // --- ADDED ---
     // Create a settings object to enable anti-aliasing for smoother graphics
     sf::ContextSettings settings;
@@ -63,28 +81,78 @@ int main()
     sf::RenderWindow window(sf::VideoMode(1280, 720), "TrafficOptiSim Visualization", sf::Style::Default, settings);
     window.setFramerateLimit(60);
 
-    Simulation sim;
-    setup_simulation(sim);
+    // Declared first, so it outlives the simulation thread feeding it
+    StateServer state_server;
+    if (!serve_path.empty())
+    {
+        if (!state_server.start(serve_path))
+        {
+            std::cerr << "Error: Could not listen on '" << serve_path << "'." << std::endl;
+            return 1;
+        }
+        std::cout << "Streaming state to clients of " << serve_path << std::endl;
+    }
+
+    // Ticking stops at the end of a scenario, which then stays on screen
+    SimulationThread sim_thread(std::move(sim), run_ticks > 0 ? run_ticks : 0);
+    if (state_server.is_running())
+        sim_thread.set_state_server(&state_server);
+    double speed = 1.0; // Multiple of real time
+    sim_thread.set_ticks_per_second(REALTIME_TICKS_PER_SECOND * speed);
+    if (!replaying)
+        sim_thread.start();
 
-    Visualizer visualizer(sim.get_graph());
+    Visualizer visualizer(sim_thread.get_graph());
 
     while (window.isOpen())
     {
         sf::Event event;
         while (window.pollEvent(event))
         {
+            visualizer.handle_event(window, event); // Pan and zoom
             if (event.type == sf::Event::Closed)
             {
                 window.close();
             }
+            else if (replaying && event.type == sf::Event::KeyPressed)
+            {
+                if (event.key.code == sf::Keyboard::Left)
+                    replay.seek(replay.get_current_tick() - REPLAY_SEEK_TICKS);
+                else if (event.key.code == sf::Keyboard::Right)
+                    replay.seek(replay.get_current_tick() + REPLAY_SEEK_TICKS);
+            }
+            else if (event.type == sf::Event::KeyPressed)
+            {
+                if (event.key.code == sf::Keyboard::Up || event.key.code == sf::Keyboard::Down)
+                {
+                    speed = event.key.code == sf::Keyboard::Up ? speed * 2.0 : speed / 2.0;
+                    sim_thread.set_ticks_per_second(REALTIME_TICKS_PER_SECOND * speed);
+                }
+                else if (event.key.code == sf::Keyboard::U)
+                {
+                    const bool unbounded = sim_thread.get_ticks_per_second() == SimulationThread::UNBOUNDED;
+                    sim_thread.set_ticks_per_second(unbounded ? REALTIME_TICKS_PER_SECOND * speed
+                                                              : SimulationThread::UNBOUNDED);
+                }
+                else if (event.key.code == sf::Keyboard::Space)
+                {
+                    sim_thread.set_paused(!sim_thread.is_paused());
+                }
+            }
         }
 
-        sim.tick();
+        if (replaying)
+            replay.step(); // Holds the last frame at the end of the log
 
-        window.clear(sf::Color(25, 30, 50));
-        visualizer.draw(window, sim);
+        const Rgba background = RenderStyle::BACKGROUND_COLOR;
+        window.clear(sf::Color(background.r, background.g, background.b));
+        if (replaying)
+            visualizer.draw(window, replay);
+        else
+            visualizer.draw(window, sim_thread.get_snapshots()); // Never waits for the simulation
         window.display();
     }
 
+    sim_thread.stop();
     return 0;
 }
\ No newline at end of file
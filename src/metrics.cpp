@@ -0,0 +1,258 @@
+#include "metrics.hpp"
+
+#include <algorithm> // For std::lower_bound
+
+namespace
+{
+    const std::memory_order RELAXED = std::memory_order_relaxed;
+
+    // Single writer: load + store is enough and avoids a locked read-modify-write
+    inline void add(std::atomic<std::int64_t> &counter, std::int64_t amount)
+    {
+        counter.store(counter.load(RELAXED) + amount, RELAXED);
+    }
+
+    inline void raise_to(std::atomic<std::int64_t> &maximum, std::int64_t value)
+    {
+        if (value > maximum.load(RELAXED))
+            maximum.store(value, RELAXED);
+    }
+
+    inline double ratio(std::int64_t numerator, std::int64_t denominator)
+    {
+        return denominator > 0 ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.0;
+    }
+}
+
+const EdgeMetrics *MetricsSnapshot::find_edge(int edge_id) const
+{
+    auto it = std::lower_bound(edges.begin(), edges.end(), edge_id,
+                               [](const EdgeMetrics &edge, int id)
+                               { return edge.edge_id < id; });
+    return it != edges.end() && it->edge_id == edge_id ? &*it : nullptr;
+}
+
+void TripDistributions::merge(const TripDistributions &other)
+{
+    for (const auto &pair : other.travel_time_by_od)
+    {
+        auto it = travel_time_by_od.emplace(pair.first, TDigest(pair.second.get_compression())).first;
+        it->second.merge(pair.second);
+    }
+    for (const auto &pair : other.delay_by_approach)
+    {
+        auto it = delay_by_approach.emplace(pair.first, TDigest(pair.second.get_compression())).first;
+        it->second.merge(pair.second);
+    }
+}
+
+TDigest TripDistributions::get_network_travel_time() const
+{
+    TDigest network(travel_time_by_od.empty() ? TDigest::DEFAULT_COMPRESSION
+                                              : travel_time_by_od.begin()->second.get_compression());
+    for (const auto &pair : travel_time_by_od)
+    {
+        network.merge(pair.second);
+    }
+    return network;
+}
+
+SimulationMetrics::SimulationMetrics(const Graph &graph, int start_tick, double sketch_compression)
+    : start_tick_(start_tick),
+      tick_(start_tick),
+      edges_(new EdgeCounters[graph.get_all_edges().size()]),
+      spawned_(0),
+      completed_(0),
+      aborted_(0),
+      travel_time_sum_(0),
+      max_travel_time_(0),
+      trip_delay_sum_(0),
+      sketch_compression_(sketch_compression)
+{
+    edge_ids_.reserve(graph.get_all_edges().size());
+    index_.reserve(graph.get_all_edges().size());
+    for (const auto &pair : graph.get_all_edges())
+    {
+        index_[pair.first] = edge_ids_.size();
+        edges_[edge_ids_.size()].occupancy_changed_tick.store(start_tick, RELAXED);
+        edges_[edge_ids_.size()].queue_changed_tick.store(start_tick, RELAXED);
+        edge_ids_.push_back(pair.first);
+    }
+}
+
+long SimulationMetrics::find_index(int edge_id) const
+{
+    auto it = index_.find(edge_id);
+    return it != index_.end() ? static_cast<long>(it->second) : -1;
+}
+
+void SimulationMetrics::advance_area(Counter &area, Counter &changed_tick, std::int64_t value)
+{
+    const std::int64_t now = tick_.load(RELAXED);
+    add(area, value * (now - changed_tick.load(RELAXED)));
+    changed_tick.store(now, RELAXED);
+}
+
+void SimulationMetrics::on_tick(int tick)
+{
+    tick_.store(tick, RELAXED);
+}
+
+void SimulationMetrics::on_spawn()
+{
+    add(spawned_, 1);
+}
+
+void SimulationMetrics::on_edge_enter(int edge_id)
+{
+    long index = find_index(edge_id);
+    if (index < 0)
+        return;
+    EdgeCounters &edge = edges_[index];
+    const std::int64_t occupancy = edge.entered.load(RELAXED) - edge.exited.load(RELAXED);
+    advance_area(edge.occupancy_area, edge.occupancy_changed_tick, occupancy);
+    add(edge.entered, 1);
+    raise_to(edge.max_occupancy, occupancy + 1);
+}
+
+void SimulationMetrics::on_edge_exit(int edge_id)
+{
+    long index = find_index(edge_id);
+    if (index < 0)
+        return;
+    EdgeCounters &edge = edges_[index];
+    const std::int64_t occupancy = edge.entered.load(RELAXED) - edge.exited.load(RELAXED);
+    advance_area(edge.occupancy_area, edge.occupancy_changed_tick, occupancy);
+    add(edge.exited, 1);
+}
+
+void SimulationMetrics::on_queue_join(int edge_id)
+{
+    long index = find_index(edge_id);
+    if (index < 0)
+        return;
+    EdgeCounters &edge = edges_[index];
+    const std::int64_t length = edge.queued.load(RELAXED) - edge.discharged.load(RELAXED);
+    advance_area(edge.queue_area, edge.queue_changed_tick, length);
+    add(edge.queued, 1);
+    raise_to(edge.max_queue, length + 1);
+}
+
+void SimulationMetrics::on_queue_discharge(int edge_id, int waited_ticks)
+{
+    long index = find_index(edge_id);
+    if (index < 0)
+        return;
+    EdgeCounters &edge = edges_[index];
+    const std::int64_t length = edge.queued.load(RELAXED) - edge.discharged.load(RELAXED);
+    advance_area(edge.queue_area, edge.queue_changed_tick, length);
+    add(edge.discharged, 1);
+    add(edge.delay_sum, waited_ticks);
+    raise_to(edge.max_delay, waited_ticks);
+    pending_delays_.push_back({edge_id, waited_ticks});
+}
+
+void SimulationMetrics::on_trip_complete(int source_node_id, int destination_node_id, int travel_ticks,
+                                         int delay_ticks)
+{
+    pending_travel_times_.push_back({{source_node_id, destination_node_id}, travel_ticks});
+    add(completed_, 1);
+    add(travel_time_sum_, travel_ticks);
+    raise_to(max_travel_time_, travel_ticks);
+    add(trip_delay_sum_, delay_ticks);
+}
+
+void SimulationMetrics::on_trip_aborted()
+{
+    add(aborted_, 1);
+}
+
+void SimulationMetrics::on_initial_vehicles(int edge_id, std::int64_t on_edge, std::int64_t queued)
+{
+    long index = find_index(edge_id);
+    if (index < 0)
+        return;
+    EdgeCounters &edge = edges_[index];
+    add(edge.entered, on_edge);
+    raise_to(edge.max_occupancy, edge.entered.load(RELAXED) - edge.exited.load(RELAXED));
+    add(edge.queued, queued);
+    raise_to(edge.max_queue, edge.queued.load(RELAXED) - edge.discharged.load(RELAXED));
+}
+
+void SimulationMetrics::on_tick_end()
+{
+    if (pending_travel_times_.empty() && pending_delays_.empty())
+        return;
+    // Never wait for a reader; keep the samples for the next tick instead
+    std::unique_lock<std::mutex> lock(distributions_mutex_, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+    for (const TravelTimeSample &sample : pending_travel_times_)
+    {
+        auto it = distributions_.travel_time_by_od.find(sample.od);
+        if (it == distributions_.travel_time_by_od.end())
+            it = distributions_.travel_time_by_od.emplace(sample.od, TDigest(sketch_compression_)).first;
+        it->second.add(sample.ticks);
+    }
+    for (const DelaySample &sample : pending_delays_)
+    {
+        auto it = distributions_.delay_by_approach.find(sample.approach_id);
+        if (it == distributions_.delay_by_approach.end())
+            it = distributions_.delay_by_approach.emplace(sample.approach_id, TDigest(sketch_compression_)).first;
+        it->second.add(sample.ticks);
+    }
+    pending_travel_times_.clear();
+    pending_delays_.clear();
+}
+
+TripDistributions SimulationMetrics::get_distributions() const
+{
+    std::lock_guard<std::mutex> lock(distributions_mutex_);
+    return distributions_;
+}
+
+MetricsSnapshot SimulationMetrics::snapshot() const
+{
+    MetricsSnapshot out;
+    const std::int64_t now = tick_.load(RELAXED);
+    out.tick = static_cast<int>(now);
+    out.ticks_observed = static_cast<int>(now - start_tick_);
+
+    out.vehicles_spawned = spawned_.load(RELAXED);
+    out.trips_completed = completed_.load(RELAXED);
+    out.trips_aborted = aborted_.load(RELAXED);
+    out.travel_time_sum = travel_time_sum_.load(RELAXED);
+    out.max_travel_time = max_travel_time_.load(RELAXED);
+    out.trip_delay_sum = trip_delay_sum_.load(RELAXED);
+    out.mean_travel_time = ratio(out.travel_time_sum, out.trips_completed);
+    out.mean_trip_delay = ratio(out.trip_delay_sum, out.trips_completed);
+
+    out.edges.resize(edge_ids_.size());
+    for (std::size_t i = 0; i < edge_ids_.size(); ++i)
+    {
+        const EdgeCounters &counters = edges_[i];
+        EdgeMetrics &edge = out.edges[i];
+        edge.edge_id = edge_ids_[i];
+
+        edge.vehicles_entered = counters.entered.load(RELAXED);
+        edge.vehicles_exited = counters.exited.load(RELAXED);
+        edge.occupancy = edge.vehicles_entered - edge.vehicles_exited;
+        edge.max_occupancy = counters.max_occupancy.load(RELAXED);
+        // Area so far plus the current value held since it last changed
+        std::int64_t area = counters.occupancy_area.load(RELAXED) +
+                            edge.occupancy * (now - counters.occupancy_changed_tick.load(RELAXED));
+        edge.mean_occupancy = ratio(area, out.ticks_observed);
+
+        edge.vehicles_queued = counters.queued.load(RELAXED);
+        edge.vehicles_discharged = counters.discharged.load(RELAXED);
+        edge.queue_length = edge.vehicles_queued - edge.vehicles_discharged;
+        edge.max_queue_length = counters.max_queue.load(RELAXED);
+        area = counters.queue_area.load(RELAXED) +
+               edge.queue_length * (now - counters.queue_changed_tick.load(RELAXED));
+        edge.mean_queue_length = ratio(area, out.ticks_observed);
+        edge.delay_sum = counters.delay_sum.load(RELAXED);
+        edge.max_delay = counters.max_delay.load(RELAXED);
+        edge.mean_delay = ratio(edge.delay_sum, edge.vehicles_discharged);
+    }
+    return out;
+}
@@ -0,0 +1,187 @@
+#include "network_generator.hpp"
+#include "simulation.hpp"
+
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For std::sqrt, std::ceil
+#include <map>
+#include <memory>
+#include <random>
+#include <utility> // For std::pair
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Adds a street in both directions, recording each edge as an approach of the node
+    // it leaves
+    void add_street(Graph &graph, std::vector<std::vector<int>> &approaches, int &next_edge_id, int a, int b,
+                    double weight)
+    {
+        graph.add_edge(next_edge_id, a, b, weight);
+        approaches[a].push_back(next_edge_id++);
+        graph.add_edge(next_edge_id, b, a, weight);
+        approaches[b].push_back(next_edge_id++);
+    }
+
+    void add_intersections(GeneratedNetwork &network, const std::vector<std::vector<int>> &approaches)
+    {
+        for (std::size_t node = 1; node < approaches.size(); ++node)
+        {
+            if (!approaches[node].empty())
+                network.intersections.emplace_back(static_cast<int>(node), approaches[node]);
+        }
+    }
+}
+
+namespace NetworkGenerator
+{
+    GeneratedNetwork make_grid(int rows, int cols, double spacing, int travel_ticks)
+    {
+        GeneratedNetwork network;
+        std::vector<std::vector<int>> approaches(static_cast<std::size_t>(rows * cols) + 1);
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < cols; ++col)
+            {
+                network.graph.add_node(row * cols + col + 1, col * spacing, row * spacing);
+            }
+        }
+        int next_edge_id = 1;
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < cols; ++col)
+            {
+                int node = row * cols + col + 1;
+                if (col + 1 < cols)
+                    add_street(network.graph, approaches, next_edge_id, node, node + 1, travel_ticks);
+                if (row + 1 < rows)
+                    add_street(network.graph, approaches, next_edge_id, node, node + cols, travel_ticks);
+            }
+        }
+        add_intersections(network, approaches);
+        return network;
+    }
+
+    GeneratedNetwork make_random_geometric(int node_count, double mean_degree, unsigned int seed, double extent,
+                                           double distance_per_tick)
+    {
+        GeneratedNetwork network;
+        if (node_count <= 0)
+            return network;
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> coordinate(0.0, extent);
+        std::vector<std::pair<double, double>> positions(static_cast<std::size_t>(node_count) + 1);
+        for (int node = 1; node <= node_count; ++node)
+        {
+            positions[node] = {coordinate(rng), coordinate(rng)};
+            network.graph.add_node(node, positions[node].first, positions[node].second);
+        }
+
+        // Expected degree of a node is n * pi * r^2 / area
+        const double radius = std::sqrt(mean_degree * extent * extent / (PI * node_count));
+
+        // Bucket nodes into radius-sized cells so each node only checks its 3x3 cells
+        const int cells = std::max(1, static_cast<int>(extent / radius));
+        const double cell_size = extent / cells;
+        auto cell_of = [&](double value)
+        {
+            return std::min(cells - 1, static_cast<int>(value / cell_size));
+        };
+        std::vector<std::vector<int>> grid(static_cast<std::size_t>(cells * cells));
+        for (int node = 1; node <= node_count; ++node)
+        {
+            grid[cell_of(positions[node].second) * cells + cell_of(positions[node].first)].push_back(node);
+        }
+
+        std::vector<std::vector<int>> approaches(static_cast<std::size_t>(node_count) + 1);
+        int next_edge_id = 1;
+        for (int node = 1; node <= node_count; ++node)
+        {
+            int cx = cell_of(positions[node].first);
+            int cy = cell_of(positions[node].second);
+            for (int y = std::max(0, cy - 1); y <= std::min(cells - 1, cy + 1); ++y)
+            {
+                for (int x = std::max(0, cx - 1); x <= std::min(cells - 1, cx + 1); ++x)
+                {
+                    for (int other : grid[y * cells + x])
+                    {
+                        if (other <= node)
+                            continue; // Each pair once
+                        double dx = positions[other].first - positions[node].first;
+                        double dy = positions[other].second - positions[node].second;
+                        double distance = std::sqrt(dx * dx + dy * dy);
+                        if (distance > radius)
+                            continue;
+                        double ticks = std::max(1.0, std::ceil(distance / distance_per_tick));
+                        add_street(network.graph, approaches, next_edge_id, node, other, ticks);
+                    }
+                }
+            }
+        }
+        add_intersections(network, approaches);
+        return network;
+    }
+
+    void install(Simulation &sim, const GeneratedNetwork &network)
+    {
+        sim.set_graph(network.graph);
+        for (const Intersection &intersection : network.intersections)
+        {
+            sim.add_intersection(intersection);
+        }
+    }
+
+    int add_vehicles(Simulation &sim, int count, unsigned int seed, int first_vehicle_id, int route_count)
+    {
+        const Graph &graph = sim.get_graph();
+        std::vector<int> node_ids;
+        node_ids.reserve(graph.get_all_nodes().size());
+        for (const auto &pair : graph.get_all_nodes())
+        {
+            node_ids.push_back(pair.first);
+        }
+        if (node_ids.size() < 2)
+            return 0;
+
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<std::size_t> pick(0, node_ids.size() - 1);
+        std::map<std::pair<int, int>, std::shared_ptr<const std::vector<int>>> routes;
+        std::vector<std::pair<int, int>> route_pool; // Routable pairs, when route_count > 0
+        // Bounded so that a network without routable pairs cannot loop forever
+        const long max_attempts = 10L * (route_count > 0 ? route_count : count) + 100;
+        for (long attempt = 0; attempt < max_attempts && static_cast<int>(route_pool.size()) < route_count; ++attempt)
+        {
+            std::pair<int, int> od(node_ids[pick(rng)], node_ids[pick(rng)]);
+            if (od.first == od.second || routes.count(od))
+                continue;
+            auto path = std::make_shared<const std::vector<int>>(graph.find_shortest_path(od.first, od.second));
+            routes.emplace(od, path);
+            if (!path->empty())
+                route_pool.push_back(od);
+        }
+        if (route_count > 0 && route_pool.empty())
+            return 0;
+
+        int added = 0;
+        for (long attempt = 0; added < count && attempt < max_attempts + 10L * count; ++attempt)
+        {
+            std::pair<int, int> od = route_pool.empty() ? std::make_pair(node_ids[pick(rng)], node_ids[pick(rng)])
+                                                        : route_pool[rng() % route_pool.size()];
+            if (od.first == od.second)
+                continue;
+            auto found = routes.find(od);
+            if (found == routes.end())
+            {
+                auto path = std::make_shared<const std::vector<int>>(graph.find_shortest_path(od.first, od.second));
+                found = routes.emplace(od, path).first;
+            }
+            if (found->second->empty())
+                continue;
+            Vehicle vehicle(first_vehicle_id + added, od.first, od.second);
+            vehicle.set_route(found->second);
+            sim.add_vehicle(vehicle);
+            added++;
+        }
+        return added;
+    }
+}
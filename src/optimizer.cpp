@@ -1,5 +1,10 @@
 #include "optimizer.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+#include <algorithm> // For std::max, std::min, std::max_element
+#include <cmath>     // For std::lround
 #include <iostream> // For placeholder output
+#include <limits>
 
 TrafficOptimizer::TrafficOptimizer() {
     // Constructor for TrafficOptimizer
@@ -8,15 +13,151 @@ TrafficOptimizer::TrafficOptimizer() {
 }
 
 void TrafficOptimizer::load_traffic_data(const std::vector<TrafficDataPoint>& data) {
-    historical_data_ = data;
+    historical_data_.clear();
+    for (const TrafficDataPoint& point : data) {
+        historical_data_.append(point);
+        accumulate_flow(point);
+    }
     // Potentially process the data here, e.g., build internal models or summaries.
     // std::cout << "TrafficOptimizer: Loaded " << data.size() << " traffic data points." << std::endl;
 }
 
-const std::vector<TrafficDataPoint>& TrafficOptimizer::get_traffic_data() const {
+std::vector<TrafficDataPoint> TrafficOptimizer::get_traffic_data() const {
+    std::vector<TrafficDataPoint> data;
+    data.reserve(historical_data_.size());
+    for (int edge_id : historical_data_.get_edge_ids()) {
+        historical_data_.for_each_in_range(edge_id, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+                                           [&data](const TrafficDataPoint& point) { data.push_back(point); });
+    }
+    return data;
+}
+
+const TrafficHistoryStore& TrafficOptimizer::get_history() const {
     return historical_data_;
 }
 
+const std::map<int, ApproachFlow>& TrafficOptimizer::get_approach_flows() const {
+    return approach_flows_;
+}
+
+void TrafficOptimizer::accumulate_flow(const TrafficDataPoint& point) {
+    ApproachFlow& flow = approach_flows_[point.edge_id];
+    flow.vehicles_passed += point.vehicles_passed;
+    flow.samples++;
+    flow.density_sum += point.density;
+}
+
+bool TrafficOptimizer::load_traffic_data_file(const std::string& filepath, bool store_history) {
+    // Rows are parsed in parallel; batches arrive in file order so history stays time-ordered.
+    bool opened = Utils::for_each_traffic_batch(filepath, [&](const TrafficDataColumns& batch) {
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            TrafficDataPoint point = batch.row(i);
+            accumulate_flow(point);
+            if (store_history) {
+                historical_data_.append(point);
+            }
+        }
+    });
+    if (!opened) {
+        std::cerr << "Error: Could not open traffic data file: " << filepath << std::endl;
+    }
+    return opened;
+}
+
+void TrafficOptimizer::ingest_live_sample(const TrafficDataPoint& point, const EdgeWindowStats& window) {
+    accumulate_flow(point);
+    live_conditions_[point.edge_id] = window;
+}
+
+void TrafficOptimizer::follow_feed(TrafficFeedFollower& feed) {
+    feed.set_update_callback([this](const TrafficDataPoint& point, const EdgeWindowStats& window) {
+        ingest_live_sample(point, window);
+    });
+}
+
+const std::map<int, EdgeWindowStats>& TrafficOptimizer::get_live_conditions() const {
+    return live_conditions_;
+}
+
+SignalTimingPlan TrafficOptimizer::compute_webster_plan(const Intersection& intersection,
+                                                        const std::map<int, ApproachFlow>& flows,
+                                                        const WebsterParameters& params) {
+    SignalTimingPlan plan;
+    plan.intersection_id = intersection.get_id();
+    plan.yellow_duration = params.yellow_duration;
+
+    const std::vector<int>& approaches = intersection.get_approach_ids();
+    if (approaches.empty()) return plan;
+
+    // Flow ratio y_i = q_i / s for every approach; each approach is its own phase here.
+    std::vector<double> flow_ratios;
+    double total_ratio = 0.0;
+    for (int approach_id : approaches) {
+        double flow_per_tick = 0.0;
+        auto it = flows.find(approach_id);
+        if (it != flows.end() && params.ticks_per_sample > 0.0) {
+            flow_per_tick = it->second.mean_flow() / params.ticks_per_sample;
+        }
+        double ratio = params.saturation_flow > 0.0 ? flow_per_tick / params.saturation_flow : 0.0;
+        flow_ratios.push_back(ratio);
+        total_ratio += ratio;
+    }
+
+    // Webster: C0 = (1.5 L + 5) / (1 - Y)
+    int phase_count = static_cast<int>(approaches.size());
+    double lost_time = static_cast<double>(params.lost_time_per_phase) * phase_count;
+    double capped_ratio = std::min(total_ratio, params.max_flow_ratio_sum);
+    double optimal_cycle = (1.5 * lost_time + 5.0) / (1.0 - capped_ratio);
+
+    int min_cycle = std::max(params.min_cycle, phase_count * (params.min_green + params.yellow_duration));
+    int cycle = static_cast<int>(std::lround(optimal_cycle));
+    cycle = std::max(min_cycle, std::min(std::max(params.max_cycle, min_cycle), cycle));
+
+    // Split the green time left after the yellow intervals in proportion to y_i.
+    int available_green = cycle - phase_count * params.yellow_duration;
+    std::vector<int> greens(approaches.size());
+    int green_sum = 0;
+    for (size_t i = 0; i < approaches.size(); ++i) {
+        double share = total_ratio > 0.0 ? flow_ratios[i] / total_ratio : 1.0 / phase_count;
+        int green = static_cast<int>(std::lround(share * available_green));
+        greens[i] = std::max(params.min_green, green);
+        green_sum += greens[i];
+    }
+    // Rounding and the min_green floor can leave the greens a few ticks off the cycle.
+    // Settle the difference on the largest greens, which min_cycle keeps above min_green.
+    while (green_sum != available_green) {
+        auto largest = std::max_element(greens.begin(), greens.end());
+        int adjustment = green_sum > available_green ? -1 : 1;
+        *largest += adjustment;
+        green_sum += adjustment;
+    }
+    for (size_t i = 0; i < approaches.size(); ++i) {
+        plan.green_durations[approaches[i]] = greens[i];
+    }
+    return plan;
+}
+
+std::map<int, SignalTimingPlan> TrafficOptimizer::compute_webster_timings(const std::map<int, Intersection>& intersections,
+                                                                          const WebsterParameters& params) const {
+    std::vector<const Intersection*> work;
+    work.reserve(intersections.size());
+    for (const auto& pair : intersections) {
+        work.push_back(&pair.second);
+    }
+
+    std::vector<SignalTimingPlan> results(work.size());
+    ThreadPool pool(params.num_threads);
+    pool.parallel_for(work.size(), [&](std::size_t i) {
+        results[i] = compute_webster_plan(*work[i], approach_flows_, params);
+    });
+
+    std::map<int, SignalTimingPlan> plans;
+    for (SignalTimingPlan& plan : results) {
+        plans.emplace(plan.intersection_id, std::move(plan));
+    }
+    return plans;
+}
+
 void TrafficOptimizer::analyze_current_conditions(const Graph& graph, const std::map<int, Intersection>& intersections /*, const std::map<int, Vehicle>& vehicles */) {
     // Placeholder for analysis logic.
     // This method would typically iterate through graph edges or intersections
@@ -48,18 +189,30 @@ void TrafficOptimizer::analyze_current_conditions(const Graph& graph, const std:
     // std::cout << "TrafficOptimizer: Current conditions analyzed (placeholder)." << std::endl;
 }
 
+TimingSearchResult TrafficOptimizer::search_signal_timings(const Simulation& base, const TimingSearchParameters& params) {
+    std::vector<std::map<int, SignalTimingPlan>> initial_plans;
+    if (!approach_flows_.empty()) {
+        WebsterParameters webster;
+        webster.yellow_duration = params.yellow_duration;
+        webster.min_green = params.min_green;
+        webster.num_threads = params.num_threads;
+        initial_plans.push_back(compute_webster_timings(base.get_intersections(), webster));
+    }
+
+    SignalTimingSearch search(base, params);
+    TimingSearchResult result = search.run(initial_plans);
+    suggested_plans_ = result.best_plans;
+    return result;
+}
+
 std::map<int, int> TrafficOptimizer::suggest_new_signal_timings(int intersection_id) {
-    // Placeholder for signal timing optimization logic.
-    // This method would use `current_congestion_levels_` or other analysis results
-    // to propose new signal timings (e.g., green phase durations) for the given intersection.
-    // The returned map could be {approach_id, new_green_duration}.
-
-    std::map<int, int> new_timings;
-    // Example: If congestion on a hypothetical approach 'X' (edge_id) is high, increase its green time.
-    // This requires knowing which approaches (edge_ids) belong to `intersection_id`.
-    // This is a very simplified example and would need actual data and algorithms.
-
-    // For now, it returns an empty map, indicating no changes or that the feature is not implemented.
-    // std::cout << "TrafficOptimizer: Suggested new signal timings for intersection " << intersection_id << " (placeholder)." << std::endl;
-    return new_timings;
+    auto it = suggested_plans_.find(intersection_id);
+    if (it == suggested_plans_.end()) {
+        return {};
+    }
+    return it->second.green_durations;
+}
+
+const std::map<int, SignalTimingPlan>& TrafficOptimizer::get_suggested_plans() const {
+    return suggested_plans_;
 }
@@ -0,0 +1,277 @@
+#include "profiler.hpp"
+
+#include <algorithm> // For std::min, std::max
+#include <iomanip>   // For std::setw, std::setprecision
+#include <sstream>
+
+namespace
+{
+    const std::memory_order RELAXED = std::memory_order_relaxed;
+
+    // Single writer: load + store is enough and avoids a locked read-modify-write
+    inline void add(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+    {
+        counter.store(counter.load(RELAXED) + amount, RELAXED);
+    }
+
+    int highest_bit(std::uint64_t value)
+    {
+        return 63 - __builtin_clzll(value);
+    }
+
+    PhaseProfile profile(const std::string &name, const LatencyHistogram &histogram)
+    {
+        PhaseProfile out;
+        out.name = name;
+        out.samples = histogram.get_count();
+        out.total_ns = histogram.get_total();
+        out.mean_ns = histogram.get_mean();
+        out.min_ns = histogram.get_min();
+        out.p50_ns = histogram.percentile(0.50);
+        out.p90_ns = histogram.percentile(0.90);
+        out.p99_ns = histogram.percentile(0.99);
+        out.max_ns = histogram.get_max();
+        return out;
+    }
+
+    std::uint64_t elapsed_ns(TickProfiler::Clock::time_point from, TickProfiler::Clock::time_point to)
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram &other)
+{
+    reset();
+    merge(other);
+}
+
+LatencyHistogram &LatencyHistogram::operator=(const LatencyHistogram &other)
+{
+    if (this != &other)
+    {
+        reset();
+        merge(other);
+    }
+    return *this;
+}
+
+int LatencyHistogram::bucket_index(std::uint64_t value)
+{
+    if (value < static_cast<std::uint64_t>(SUB_BUCKET_COUNT))
+        return static_cast<int>(value);
+    int exponent = highest_bit(value);
+    if (exponent > MAX_EXPONENT)
+        return BUCKET_COUNT - 1;
+    // The top SUB_BUCKET_BITS + 1 bits select the bucket; the leading 1 is implied
+    int sub_bucket = static_cast<int>(value >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::bucket_value(int index)
+{
+    if (index < SUB_BUCKET_COUNT)
+        return static_cast<std::uint64_t>(index);
+    int exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    int shift = exponent - SUB_BUCKET_BITS;
+    std::uint64_t lowest = static_cast<std::uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lowest + ((std::uint64_t(1) << shift) >> 1);
+}
+
+void LatencyHistogram::record(std::uint64_t value)
+{
+    add(buckets_[bucket_index(value)], 1);
+    if (count_.load(RELAXED) == 0 || value < min_.load(RELAXED))
+        min_.store(value, RELAXED);
+    if (value > max_.load(RELAXED))
+        max_.store(value, RELAXED);
+    add(total_, value);
+    add(count_, 1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    const std::uint64_t other_count = other.count_.load(RELAXED);
+    if (other_count == 0)
+        return;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        add(buckets_[i], other.buckets_[i].load(RELAXED));
+    const std::uint64_t other_min = other.min_.load(RELAXED);
+    if (count_.load(RELAXED) == 0 || other_min < min_.load(RELAXED))
+        min_.store(other_min, RELAXED);
+    max_.store(std::max(max_.load(RELAXED), other.max_.load(RELAXED)), RELAXED);
+    add(total_, other.total_.load(RELAXED));
+    add(count_, other_count);
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : buckets_)
+        bucket.store(0, RELAXED);
+    count_.store(0, RELAXED);
+    total_.store(0, RELAXED);
+    min_.store(0, RELAXED);
+    max_.store(0, RELAXED);
+}
+
+std::uint64_t LatencyHistogram::get_count() const
+{
+    return count_.load(RELAXED);
+}
+
+std::uint64_t LatencyHistogram::get_total() const
+{
+    return total_.load(RELAXED);
+}
+
+std::uint64_t LatencyHistogram::get_min() const
+{
+    return min_.load(RELAXED);
+}
+
+std::uint64_t LatencyHistogram::get_max() const
+{
+    return max_.load(RELAXED);
+}
+
+double LatencyHistogram::get_mean() const
+{
+    const std::uint64_t count = get_count();
+    return count > 0 ? static_cast<double>(get_total()) / static_cast<double>(count) : 0.0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const
+{
+    // Sum the buckets rather than trusting count_: a concurrent reader may see a
+    // bucket increment before the count
+    std::uint64_t count = 0;
+    for (const auto &bucket : buckets_)
+        count += bucket.load(RELAXED);
+    if (count == 0)
+        return 0;
+    q = std::min(1.0, std::max(0.0, q));
+    // Rank of the requested value, 1-based: the smallest value with at least q * count
+    // values at or below it
+    std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.5);
+    rank = std::max<std::uint64_t>(1, std::min(rank, count));
+    if (rank == 1)
+        return get_min();
+    if (rank == count)
+        return get_max();
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += buckets_[i].load(RELAXED);
+        if (seen >= rank)
+            return std::min(std::max(bucket_value(i), get_min()), get_max());
+    }
+    return get_max();
+}
+
+const char *to_string(TickPhase phase)
+{
+    switch (phase)
+    {
+    case TickPhase::SIGNALS:
+        return "signals";
+    case TickPhase::SPAWNING:
+        return "spawning";
+    case TickPhase::MOVEMENT:
+        return "movement";
+    case TickPhase::DESPAWNING:
+        return "despawning";
+    default:
+        return "unknown";
+    }
+}
+
+const char *to_string(ProfileCounter counter)
+{
+    switch (counter)
+    {
+    case ProfileCounter::ROUTES_COMPUTED:
+        return "routes computed";
+    case ProfileCounter::QUEUE_OPERATIONS:
+        return "queue operations";
+    case ProfileCounter::MAP_LOOKUPS:
+        return "map lookups";
+    default:
+        return "unknown";
+    }
+}
+
+std::string ProfileReport::to_string() const
+{
+    std::ostringstream out;
+    out << "Tick profile over " << ticks << " ticks (times in us)\n";
+    out << std::left << std::setw(12) << "phase" << std::right << std::setw(8) << "share" << std::setw(10)
+        << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10)
+        << "max" << "\n";
+    out << std::fixed << std::setprecision(1);
+    auto line = [&](const PhaseProfile &phase)
+    {
+        double share = tick.total_ns > 0 ? 100.0 * phase.total_ns / tick.total_ns : 0.0;
+        out << std::left << std::setw(12) << phase.name << std::right << std::setw(7) << share << "%"
+            << std::setw(10) << phase.mean_ns / 1e3 << std::setw(10) << phase.p50_ns / 1e3 << std::setw(10)
+            << phase.p90_ns / 1e3 << std::setw(10) << phase.p99_ns / 1e3 << std::setw(10) << phase.max_ns / 1e3
+            << "\n";
+    };
+    for (const PhaseProfile &phase : phases)
+        line(phase);
+    line(tick);
+    for (const auto &counter : counters)
+    {
+        out << std::left << std::setw(18) << counter.first << std::right << std::setw(14) << counter.second
+            << "  (" << (ticks > 0 ? static_cast<double>(counter.second) / ticks : 0.0) << " per tick)\n";
+    }
+    return out.str();
+}
+
+TickProfiler::TickProfiler()
+{
+    for (auto &counter : counters_)
+        counter.store(0, RELAXED);
+}
+
+void TickProfiler::begin_tick()
+{
+    tick_start_ = phase_start_ = Clock::now();
+}
+
+void TickProfiler::end_phase(TickPhase phase)
+{
+    Clock::time_point now = Clock::now();
+    phases_[static_cast<std::size_t>(phase)].record(elapsed_ns(phase_start_, now));
+    phase_start_ = now;
+}
+
+void TickProfiler::end_tick()
+{
+    tick_.record(elapsed_ns(tick_start_, Clock::now()));
+}
+
+ProfileReport TickProfiler::report() const
+{
+    ProfileReport out;
+    out.tick = profile("tick", tick_);
+    out.ticks = out.tick.samples;
+    for (std::size_t i = 0; i < phases_.size(); ++i)
+        out.phases.push_back(profile(::to_string(static_cast<TickPhase>(i)), phases_[i]));
+    for (std::size_t i = 0; i < counters_.size(); ++i)
+        out.counters.emplace_back(::to_string(static_cast<ProfileCounter>(i)), counters_[i].load(RELAXED));
+    return out;
+}
+
+void TickProfiler::reset()
+{
+    for (auto &phase : phases_)
+        phase.reset();
+    tick_.reset();
+    for (auto &counter : counters_)
+        counter.store(0, RELAXED);
+}
@@ -0,0 +1,183 @@
+#include "quantile_sketch.hpp"
+
+#include <algorithm> // For std::sort, std::min, std::max
+#include <cmath>     // For std::asin, std::sin
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Scale function k1: maps quantile q to an index where every centroid may span at
+    // most 1. Its slope grows towards q = 0 and q = 1, which keeps tail centroids small.
+    double scale_k(double q, double compression)
+    {
+        return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+    }
+
+    double scale_k_inverse(double k, double compression)
+    {
+        double angle = k * 2.0 * PI / compression;
+        if (angle >= PI / 2.0)
+            return 1.0;
+        return (std::sin(angle) + 1.0) / 2.0;
+    }
+
+    double interpolate(double from, double to, double fraction)
+    {
+        return from + (to - from) * fraction;
+    }
+}
+
+TDigest::TDigest(double compression)
+    : compression_(compression < 10.0 ? 10.0 : compression),
+      count_(0.0),
+      min_(0.0),
+      max_(0.0)
+{
+}
+
+void TDigest::add(double value, double weight)
+{
+    if (!(weight > 0.0)) // Also rejects NaN
+        return;
+    if (count_ == 0.0)
+    {
+        min_ = max_ = value;
+    }
+    else
+    {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += weight;
+    buffer_.push_back({value, weight});
+    if (buffer_.size() >= static_cast<std::size_t>(2.0 * compression_))
+        compress();
+}
+
+void TDigest::merge(const TDigest &other)
+{
+    if (other.count_ == 0.0)
+        return;
+    if (count_ == 0.0)
+    {
+        min_ = other.min_;
+        max_ = other.max_;
+    }
+    else
+    {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    count_ += other.count_;
+    buffer_.insert(buffer_.end(), other.centroids_.begin(), other.centroids_.end());
+    buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+    compress();
+}
+
+void TDigest::compress()
+{
+    if (buffer_.empty())
+        return;
+    buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+    std::sort(buffer_.begin(), buffer_.end(),
+              [](const Centroid &a, const Centroid &b)
+              { return a.mean < b.mean; });
+
+    // Greedily merge neighbours while the merged centroid spans at most one unit of k
+    centroids_.clear();
+    Centroid current = buffer_.front();
+    double weight_before = 0.0; // Weight of the centroids already emitted
+    double q_limit = scale_k_inverse(scale_k(0.0, compression_) + 1.0, compression_);
+    for (std::size_t i = 1; i < buffer_.size(); ++i)
+    {
+        const Centroid &next = buffer_[i];
+        double q_after = (weight_before + current.weight + next.weight) / count_;
+        if (q_after <= q_limit)
+        {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        }
+        else
+        {
+            centroids_.push_back(current);
+            weight_before += current.weight;
+            q_limit = scale_k_inverse(scale_k(weight_before / count_, compression_) + 1.0, compression_);
+            current = next;
+        }
+    }
+    centroids_.push_back(current);
+    buffer_.clear();
+}
+
+double TDigest::quantile(double q) const
+{
+    if (count_ == 0.0)
+        return 0.0;
+    if (!buffer_.empty())
+    {
+        TDigest compressed(*this);
+        compressed.compress();
+        return compressed.quantile(q);
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    if (centroids_.size() == 1)
+        return interpolate(min_, max_, q);
+
+    // Each centroid's mean sits at the middle of its weight; interpolate between the
+    // centres, and between the exact extremes and the outermost centres
+    const double target = q * count_;
+    const Centroid &first = centroids_.front();
+    if (target < first.weight / 2.0)
+        return interpolate(min_, first.mean, target / (first.weight / 2.0));
+
+    double weight_so_far = first.weight / 2.0;
+    for (std::size_t i = 0; i + 1 < centroids_.size(); ++i)
+    {
+        const Centroid &left = centroids_[i];
+        const Centroid &right = centroids_[i + 1];
+        double span = (left.weight + right.weight) / 2.0;
+        if (weight_so_far + span > target)
+            return interpolate(left.mean, right.mean, (target - weight_so_far) / span);
+        weight_so_far += span;
+    }
+
+    const Centroid &last = centroids_.back();
+    double tail = last.weight / 2.0;
+    double fraction = tail > 0.0 ? (target - weight_so_far) / tail : 1.0;
+    return interpolate(last.mean, max_, std::min(1.0, fraction));
+}
+
+bool TDigest::empty() const
+{
+    return count_ == 0.0;
+}
+
+double TDigest::get_count() const
+{
+    return count_;
+}
+
+double TDigest::get_min() const
+{
+    return min_;
+}
+
+double TDigest::get_max() const
+{
+    return max_;
+}
+
+double TDigest::get_compression() const
+{
+    return compression_;
+}
+
+std::size_t TDigest::get_centroid_count() const
+{
+    if (buffer_.empty())
+        return centroids_.size();
+    TDigest compressed(*this);
+    compressed.compress();
+    return compressed.centroids_.size();
+}
@@ -0,0 +1,71 @@
+#include "route_cache.hpp"
+
+#include <utility> // For std::move
+
+namespace
+{
+    std::uint64_t pair_key(int source_node_id, int destination_node_id)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(source_node_id)) << 32) |
+               static_cast<std::uint32_t>(destination_node_id);
+    }
+}
+
+RouteCache::RouteCache(std::shared_ptr<const Graph> graph)
+    : graph_(graph ? std::move(graph) : std::make_shared<const Graph>()),
+      hits_(0),
+      misses_(0)
+{
+}
+
+std::shared_ptr<const std::vector<int>> RouteCache::find_or_plan(int source_node_id, int destination_node_id,
+                                                                 bool *planned)
+{
+    const std::uint64_t key = pair_key(source_node_id, destination_node_id);
+    // Mix the high (source) and low (destination) halves so both spread over the shards
+    Shard &shard = shards_[(key ^ (key >> 29)) % SHARD_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.paths.find(key);
+        if (found != shard.paths.end())
+        {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            if (planned)
+                *planned = false;
+            return found->second;
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto path = std::make_shared<const std::vector<int>>(graph_->find_shortest_path(source_node_id, destination_node_id));
+    if (planned)
+        *planned = true;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.paths.emplace(key, std::move(path)).first->second; // Keeps a concurrent insert
+}
+
+const Graph &RouteCache::get_graph() const
+{
+    return *graph_;
+}
+
+std::size_t RouteCache::size() const
+{
+    std::size_t total = 0;
+    for (const Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.paths.size();
+    }
+    return total;
+}
+
+std::uint64_t RouteCache::get_hits() const
+{
+    return hits_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RouteCache::get_misses() const
+{
+    return misses_.load(std::memory_order_relaxed);
+}
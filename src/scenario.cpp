@@ -0,0 +1,254 @@
+#include "scenario.hpp"
+#include "network_generator.hpp"
+
+#include <algorithm> // For std::sort
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <utility> // For std::move
+
+namespace
+{
+    std::string directory_of(const std::string &filepath)
+    {
+        std::size_t slash = filepath.find_last_of('/');
+        return slash == std::string::npos ? std::string() : filepath.substr(0, slash + 1);
+    }
+
+    std::string stem_of(const std::string &filepath)
+    {
+        std::size_t slash = filepath.find_last_of('/');
+        std::string name = slash == std::string::npos ? filepath : filepath.substr(slash + 1);
+        std::size_t dot = name.find_last_of('.');
+        return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+    }
+
+    std::string resolve(const std::string &directory, const std::string &path)
+    {
+        return path.empty() || path[0] == '/' ? path : directory + path;
+    }
+
+    // True when only whitespace is left on the line
+    bool at_end(std::istringstream &line_stream)
+    {
+        return (line_stream >> std::ws).eof();
+    }
+}
+
+bool load_scenario(const std::string &filepath, Scenario &out_scenario)
+{
+    std::ifstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not open scenario file: " << filepath << std::endl;
+        return false;
+    }
+
+    const std::string directory = directory_of(filepath);
+    Scenario scenario;
+    scenario.name = stem_of(filepath);
+    std::string network_source;  // "map", "grid" or "geometric"
+    std::string map_path, plans_path;
+    int grid_rows = 0, grid_cols = 0, grid_travel_ticks = 5;
+    double grid_spacing = 50.0;
+    int geometric_nodes = 0;
+    double geometric_degree = 0.0;
+    unsigned int geometric_seed = 0;
+    std::vector<std::pair<int, std::vector<int>>> listed_intersections;
+    int network_line = 0;
+
+    auto fail = [&](int line_number, const std::string &problem)
+    {
+        std::cerr << "Error: " << filepath << ":" << line_number << ": " << problem << std::endl;
+        return false;
+    };
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        std::istringstream line_stream(line.substr(0, line.find('#'))); // Comments run to the end of the line
+        std::string directive;
+        if (!(line_stream >> directive))
+            continue;
+
+        bool ok = false;
+        if (directive == "map" || directive == "grid" || directive == "geometric")
+        {
+            if (!network_source.empty())
+                return fail(line_number, "second network (already given on line " + std::to_string(network_line) + ")");
+            network_source = directive;
+            network_line = line_number;
+            if (directive == "map")
+            {
+                ok = static_cast<bool>(line_stream >> map_path) && at_end(line_stream);
+            }
+            else if (directive == "grid")
+            {
+                ok = line_stream >> grid_rows >> grid_cols && grid_rows > 0 && grid_cols > 0;
+                if (ok && !at_end(line_stream))
+                    ok = line_stream >> grid_spacing >> grid_travel_ticks && grid_spacing > 0.0 && grid_travel_ticks > 0;
+                ok = ok && at_end(line_stream);
+            }
+            else
+            {
+                ok = line_stream >> geometric_nodes >> geometric_degree >> geometric_seed && geometric_nodes > 0 &&
+                     geometric_degree > 0.0 && at_end(line_stream);
+            }
+        }
+        else if (directive == "intersection")
+        {
+            int node_id = 0;
+            std::vector<int> approaches;
+            int approach = 0;
+            if (line_stream >> node_id)
+            {
+                while (!at_end(line_stream) && line_stream >> approach)
+                    approaches.push_back(approach);
+                ok = !approaches.empty() && at_end(line_stream);
+            }
+            if (ok)
+                listed_intersections.emplace_back(node_id, std::move(approaches));
+        }
+        else if (directive == "plans")
+        {
+            ok = static_cast<bool>(line_stream >> plans_path) && at_end(line_stream);
+        }
+        else if (directive == "demand")
+        {
+            DemandPeriod period;
+            ok = line_stream >> period.start_tick >> period.spawn_interval && period.start_tick >= 0 &&
+                 period.spawn_interval >= 0 && at_end(line_stream);
+            if (ok)
+                scenario.demand.push_back(period);
+        }
+        else if (directive == "vehicles")
+        {
+            ok = line_stream >> scenario.initial_vehicles && scenario.initial_vehicles >= 0;
+            if (ok && !at_end(line_stream))
+                ok = line_stream >> scenario.vehicle_routes && scenario.vehicle_routes >= 0;
+            ok = ok && at_end(line_stream);
+        }
+        else if (directive == "seed")
+        {
+            ok = static_cast<bool>(line_stream >> scenario.seed) && at_end(line_stream);
+        }
+        else if (directive == "ticks")
+        {
+            ok = line_stream >> scenario.ticks && scenario.ticks > 0 && at_end(line_stream);
+        }
+        else
+        {
+            return fail(line_number, "unknown directive '" + directive + "'");
+        }
+
+        if (!ok)
+            return fail(line_number, "malformed " + directive + " line: '" + line + "'");
+    }
+
+    // --- Network ---
+    auto graph = std::make_shared<Graph>();
+    std::vector<Intersection> generated_intersections;
+    if (network_source.empty())
+    {
+        std::cerr << "Error: " << filepath << ": no network (map, grid or geometric)" << std::endl;
+        return false;
+    }
+    if (network_source == "map")
+    {
+        if (!graph->load_from_file(resolve(directory, map_path)))
+            return fail(network_line, "could not load map '" + map_path + "'");
+    }
+    else
+    {
+        GeneratedNetwork network =
+            network_source == "grid"
+                ? NetworkGenerator::make_grid(grid_rows, grid_cols, grid_spacing, grid_travel_ticks)
+                : NetworkGenerator::make_random_geometric(geometric_nodes, geometric_degree, geometric_seed);
+        *graph = std::move(network.graph);
+        generated_intersections = std::move(network.intersections);
+    }
+
+    // --- Intersections ---
+    if (!listed_intersections.empty())
+    {
+        std::set<int> seen;
+        for (const auto &listed : listed_intersections)
+        {
+            if (!graph->has_node(listed.first) || !seen.insert(listed.first).second)
+            {
+                std::cerr << "Error: " << filepath << ": intersection " << listed.first
+                          << " is not a node of the network or is listed twice" << std::endl;
+                return false;
+            }
+            for (int approach : listed.second)
+            {
+                if (!graph->has_edge(approach))
+                {
+                    std::cerr << "Error: " << filepath << ": intersection " << listed.first << " approach "
+                              << approach << " is not an edge of the network" << std::endl;
+                    return false;
+                }
+            }
+        }
+        for (const auto &listed : listed_intersections)
+            scenario.intersections.emplace_back(listed.first, listed.second);
+    }
+    else if (network_source != "map")
+    {
+        scenario.intersections = std::move(generated_intersections); // Same derivation rule
+    }
+    else
+    {
+        for (const auto &pair : graph->get_all_nodes())
+        {
+            const std::vector<Edge> &outgoing = graph->get_edges_from_node(pair.first);
+            if (outgoing.empty())
+                continue;
+            std::vector<int> approaches;
+            approaches.reserve(outgoing.size());
+            for (const Edge &edge : outgoing)
+                approaches.push_back(edge.id);
+            scenario.intersections.emplace_back(pair.first, approaches);
+        }
+    }
+    std::sort(scenario.intersections.begin(), scenario.intersections.end(),
+              [](const Intersection &a, const Intersection &b)
+              { return a.get_id() < b.get_id(); });
+
+    // --- Timing plans, applied to the intersections here so every build reuses them ---
+    if (!plans_path.empty())
+    {
+        if (!load_timing_plans(resolve(directory, plans_path), scenario.timing_plans))
+            return false;
+        for (Intersection &intersection : scenario.intersections)
+        {
+            auto plan = scenario.timing_plans.find(intersection.get_id());
+            if (plan != scenario.timing_plans.end())
+                intersection.set_timing_plan(plan->second);
+        }
+    }
+
+    scenario.graph = std::move(graph);
+    out_scenario = std::move(scenario);
+    return true;
+}
+
+void apply_scenario(Simulation &sim, const Scenario &scenario)
+{
+    sim.set_random_seed(scenario.seed);
+    sim.set_graph(scenario.graph);
+    for (const Intersection &intersection : scenario.intersections)
+    {
+        sim.add_intersection(intersection);
+    }
+    if (!scenario.demand.empty())
+        sim.set_demand_profile(scenario.demand);
+    if (scenario.initial_vehicles > 0)
+    {
+        NetworkGenerator::add_vehicles(sim, scenario.initial_vehicles, scenario.seed, 1000000,
+                                       scenario.vehicle_routes);
+    }
+}
@@ -0,0 +1,326 @@
+#include "signal_search.hpp"
+#include "trace.hpp"
+
+#include <algorithm> // For std::sort, std::min, std::max
+#include <limits>
+#include <numeric> // For std::iota
+
+SignalTimingSearch::SignalTimingSearch(const Simulation &base, const TimingSearchParameters &params)
+    : base_(base),
+      params_(params),
+      rng_(params.search_seed),
+      pool_(params.num_threads),
+      evaluations_(0),
+      cache_hits_(0),
+      offsets_searched_(base.get_current_tick() == 0)
+{
+    params_.population_size = std::max(1, params_.population_size);
+    params_.elite_count = std::max(0, std::min(params_.elite_count, params_.population_size));
+    params_.tournament_size = std::max(1, params_.tournament_size);
+    params_.min_green = std::max(1, params_.min_green);
+    params_.max_green = std::max(params_.min_green, params_.max_green);
+    if (params_.rollout_seeds.empty())
+    {
+        params_.rollout_seeds.push_back(0);
+    }
+}
+
+std::uint64_t SignalTimingSearch::hash_plans(const std::map<int, SignalTimingPlan> &plans)
+{
+    // FNV-1a over the integer fields
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](long long value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash ^= static_cast<std::uint64_t>(value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    for (const auto &pair : plans)
+    {
+        const SignalTimingPlan &plan = pair.second;
+        mix(pair.first);
+        mix(plan.offset);
+        mix(plan.yellow_duration);
+        mix(static_cast<long long>(plan.green_durations.size()));
+        for (const auto &green : plan.green_durations)
+        {
+            mix(green.first);
+            mix(green.second);
+        }
+    }
+    return hash;
+}
+
+std::size_t SignalTimingSearch::cache_size() const
+{
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return fitness_cache_.size();
+}
+
+double SignalTimingSearch::evaluate(const std::map<int, SignalTimingPlan> &plans)
+{
+    std::vector<PlanSet> single(1, plans);
+    std::vector<double> fitness;
+    evaluate_population(single, fitness);
+    return fitness[0];
+}
+
+double SignalTimingSearch::rollout(const PlanSet &plans, unsigned int seed) const
+{
+    TRACE_SCOPE_ARG("rollout", "seed", seed);
+    Simulation sim = base_.fork(seed);
+    sim.apply_timing_plans(plans);
+
+    long long waiting_vehicle_ticks = 0;
+    for (int t = 0; t < params_.rollout_ticks; ++t)
+    {
+        sim.tick();
+        for (const auto &pair : sim.get_vehicles())
+        {
+            if (pair.second.get_state() == VehicleState::WAITING_AT_INTERSECTION)
+            {
+                waiting_vehicle_ticks++;
+            }
+        }
+    }
+    return params_.rollout_ticks > 0 ? static_cast<double>(waiting_vehicle_ticks) / params_.rollout_ticks : 0.0;
+}
+
+void SignalTimingSearch::evaluate_population(const std::vector<PlanSet> &population, std::vector<double> &fitness)
+{
+    fitness.assign(population.size(), 0.0);
+    std::vector<std::uint64_t> hashes(population.size());
+    std::vector<std::size_t> pending; // Indices of distinct plan sets missing from the cache
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        std::unordered_map<std::uint64_t, bool> queued;
+        for (std::size_t i = 0; i < population.size(); ++i)
+        {
+            hashes[i] = hash_plans(population[i]);
+            if (fitness_cache_.count(hashes[i]) || queued.count(hashes[i]))
+            {
+                cache_hits_++;
+            }
+            else
+            {
+                queued[hashes[i]] = true;
+                pending.push_back(i);
+            }
+        }
+    }
+
+    // One job per (plan set, seed) pair so every core stays busy even for small populations.
+    const std::size_t seed_count = params_.rollout_seeds.size();
+    std::vector<double> scores(pending.size() * seed_count, 0.0);
+    pool_.parallel_for(scores.size(), [&](std::size_t job)
+                       {
+        const PlanSet &plans = population[pending[job / seed_count]];
+        scores[job] = rollout(plans, params_.rollout_seeds[job % seed_count]); });
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (std::size_t p = 0; p < pending.size(); ++p)
+    {
+        double total = 0.0;
+        for (std::size_t s = 0; s < seed_count; ++s)
+        {
+            total += scores[p * seed_count + s];
+        }
+        fitness_cache_[hashes[pending[p]]] = total / seed_count;
+    }
+    evaluations_ += static_cast<int>(pending.size());
+
+    for (std::size_t i = 0; i < population.size(); ++i)
+    {
+        fitness[i] = fitness_cache_.at(hashes[i]);
+    }
+}
+
+void SignalTimingSearch::clamp(SignalTimingPlan &plan) const
+{
+    plan.yellow_duration = params_.yellow_duration;
+    for (auto &green : plan.green_durations)
+    {
+        green.second = std::max(params_.min_green, std::min(params_.max_green, green.second));
+    }
+    int cycle = plan.cycle_length();
+    plan.offset = offsets_searched_ && cycle > 0 ? ((plan.offset % cycle) + cycle) % cycle : 0;
+}
+
+SignalTimingSearch::PlanSet SignalTimingSearch::default_plan_set() const
+{
+    PlanSet plans;
+    for (const auto &pair : base_.get_intersections())
+    {
+        SignalTimingPlan plan;
+        plan.intersection_id = pair.first;
+        for (int approach_id : pair.second.get_approach_ids())
+        {
+            plan.green_durations[approach_id] = Intersection::GREEN_DURATION;
+        }
+        clamp(plan);
+        plans[pair.first] = plan;
+    }
+    return plans;
+}
+
+SignalTimingSearch::PlanSet SignalTimingSearch::random_plan_set()
+{
+    std::uniform_int_distribution<int> green_dist(params_.min_green, params_.max_green);
+    PlanSet plans = default_plan_set();
+    for (auto &pair : plans)
+    {
+        SignalTimingPlan &plan = pair.second;
+        for (auto &green : plan.green_durations)
+        {
+            green.second = green_dist(rng_);
+        }
+        int cycle = plan.cycle_length();
+        if (offsets_searched_ && cycle > 0)
+        {
+            plan.offset = std::uniform_int_distribution<int>(0, cycle - 1)(rng_);
+        }
+    }
+    return plans;
+}
+
+const SignalTimingSearch::PlanSet &SignalTimingSearch::tournament_select(const std::vector<PlanSet> &population,
+                                                                         const std::vector<double> &fitness)
+{
+    std::uniform_int_distribution<std::size_t> pick(0, population.size() - 1);
+    std::size_t best = pick(rng_);
+    for (int i = 1; i < params_.tournament_size; ++i)
+    {
+        std::size_t challenger = pick(rng_);
+        if (fitness[challenger] < fitness[best])
+        {
+            best = challenger;
+        }
+    }
+    return population[best];
+}
+
+SignalTimingSearch::PlanSet SignalTimingSearch::crossover(const PlanSet &a, const PlanSet &b)
+{
+    // Uniform crossover at intersection granularity keeps each green split/offset pair intact.
+    std::bernoulli_distribution coin(0.5);
+    PlanSet child = a;
+    for (auto &pair : child)
+    {
+        auto it = b.find(pair.first);
+        if (it != b.end() && coin(rng_))
+        {
+            pair.second = it->second;
+        }
+    }
+    return child;
+}
+
+void SignalTimingSearch::mutate(PlanSet &plans)
+{
+    std::bernoulli_distribution should_mutate(params_.mutation_rate);
+    std::uniform_int_distribution<int> step(-params_.mutation_step, params_.mutation_step);
+    for (auto &pair : plans)
+    {
+        SignalTimingPlan &plan = pair.second;
+        for (auto &green : plan.green_durations)
+        {
+            if (should_mutate(rng_))
+            {
+                green.second += step(rng_);
+            }
+        }
+        if (offsets_searched_ && should_mutate(rng_))
+        {
+            plan.offset += step(rng_);
+        }
+        clamp(plan);
+    }
+}
+
+TimingSearchResult SignalTimingSearch::run(const std::vector<std::map<int, SignalTimingPlan>> &initial_plans)
+{
+    const std::size_t population_size = static_cast<std::size_t>(params_.population_size);
+    const PlanSet defaults = default_plan_set();
+
+    std::vector<PlanSet> population;
+    population.reserve(population_size);
+    for (const PlanSet &seed_plans : initial_plans)
+    {
+        if (population.size() >= population_size)
+            break;
+        // Start from the defaults so intersections missing from the seed are still searched.
+        PlanSet plans = defaults;
+        for (auto &pair : plans)
+        {
+            auto it = seed_plans.find(pair.first);
+            if (it == seed_plans.end())
+                continue;
+            for (auto &green : pair.second.green_durations)
+            {
+                auto seeded = it->second.green_durations.find(green.first);
+                if (seeded != it->second.green_durations.end())
+                {
+                    green.second = seeded->second;
+                }
+            }
+            pair.second.offset = it->second.offset;
+            clamp(pair.second);
+        }
+        population.push_back(plans);
+    }
+    if (population.size() < population_size)
+    {
+        population.push_back(defaults);
+    }
+    while (population.size() < population_size)
+    {
+        population.push_back(random_plan_set());
+    }
+
+    TimingSearchResult result;
+    result.best_fitness = std::numeric_limits<double>::infinity();
+    std::vector<double> fitness;
+    for (int generation = 0; generation < std::max(1, params_.generations); ++generation)
+    {
+        TRACE_SCOPE_ARG("ga generation", "generation", generation);
+        evaluate_population(population, fitness);
+
+        std::vector<std::size_t> order(population.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                  { return fitness[a] < fitness[b]; });
+
+        if (fitness[order[0]] < result.best_fitness)
+        {
+            result.best_fitness = fitness[order[0]];
+            result.best_plans = population[order[0]];
+        }
+        result.best_fitness_per_generation.push_back(result.best_fitness);
+
+        if (generation + 1 >= params_.generations)
+            break;
+
+        std::vector<PlanSet> next;
+        next.reserve(population_size);
+        for (int e = 0; e < params_.elite_count; ++e)
+        {
+            next.push_back(population[order[e]]);
+        }
+        while (next.size() < population_size)
+        {
+            PlanSet child = crossover(tournament_select(population, fitness), tournament_select(population, fitness));
+            mutate(child);
+            next.push_back(std::move(child));
+        }
+        population.swap(next);
+    }
+
+    result.evaluations = evaluations_;
+    result.cache_hits = cache_hits_;
+    result.offsets_searched = offsets_searched_;
+    return result;
+}
@@ -1,10 +1,13 @@
 #include "simulation.hpp"
+#include "route_cache.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <algorithm> // For std::remove_if, std::vector operations, std::shuffle
 #include <vector>    // For std::vector to hold keys or IDs
 
 // Constructor
-Simulation::Simulation() : current_tick_(0),
+Simulation::Simulation() : graph_(std::make_shared<Graph>()),
+                           current_tick_(0),
                            last_vehicle_id_(0),
                            spawn_timer_(0),
                            random_engine_(std::random_device{}()) // Seed the random engine
@@ -12,40 +15,305 @@ Simulation::Simulation() : current_tick_(0),
     // Graph, vehicles, intersections are default-initialized
 }
 
+Simulation::Simulation(unsigned int seed) : graph_(std::make_shared<Graph>()),
+                                            current_tick_(0),
+                                            last_vehicle_id_(0),
+                                            spawn_timer_(0),
+                                            random_engine_(seed)
+{
+}
+
+Simulation::Simulation(const Simulation &other) : SimulationView(other),
+                                                  graph_(other.graph_),
+                                                  route_cache_(other.route_cache_),
+                                                  vehicles_(other.vehicles_),
+                                                  intersections_(other.intersections_),
+                                                  current_tick_(other.current_tick_),
+                                                  last_vehicle_id_(other.last_vehicle_id_),
+                                                  spawn_timer_(other.spawn_timer_),
+                                                  spawn_interval_(other.spawn_interval_),
+                                                  demand_profile_(other.demand_profile_),
+                                                  next_demand_period_(other.next_demand_period_),
+                                                  random_engine_(other.random_engine_),
+                                                  capture_enabled_(other.capture_enabled_),
+                                                  tick_frame_valid_(other.tick_frame_valid_),
+                                                  tick_frame_(other.tick_frame_)
+{
+    // metrics_ and profiler_ stay null; the scratch buffers are refilled by every tick()
+}
+
+Simulation &Simulation::operator=(const Simulation &other)
+{
+    if (this != &other)
+    {
+        Simulation copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+void Simulation::set_random_seed(unsigned int seed)
+{
+    random_engine_.seed(seed);
+}
+
+void Simulation::set_spawn_interval(int ticks)
+{
+    spawn_interval_ = std::max(0, ticks);
+    spawn_timer_ = 0;
+    demand_profile_.clear();
+    next_demand_period_ = 0;
+}
+
+void Simulation::set_demand_profile(const std::vector<DemandPeriod> &periods)
+{
+    demand_profile_ = periods;
+    std::stable_sort(demand_profile_.begin(), demand_profile_.end(),
+                     [](const DemandPeriod &a, const DemandPeriod &b)
+                     { return a.start_tick < b.start_tick; });
+    next_demand_period_ = 0;
+}
+
+int Simulation::get_spawn_interval() const
+{
+    return spawn_interval_;
+}
+
 void Simulation::set_graph(const Graph &graph)
 {
-    graph_ = graph;
+    graph_ = std::make_shared<const Graph>(graph);
+    route_cache_.reset();
+    if (metrics_)
+        set_metrics_enabled(true); // Counters are per edge of the graph
+}
+
+void Simulation::set_graph(std::shared_ptr<const Graph> graph)
+{
+    graph_ = graph ? std::move(graph) : std::make_shared<const Graph>();
+    route_cache_.reset();
+    if (metrics_)
+        set_metrics_enabled(true);
+}
+
+bool Simulation::set_route_cache(std::shared_ptr<RouteCache> cache)
+{
+    if (cache && &cache->get_graph() != graph_.get())
+        return false;
+    route_cache_ = std::move(cache);
+    return true;
+}
+
+Simulation Simulation::fork() const
+{
+    // Members are either shared pointers to immutable data (graph, vehicle paths)
+    // or plain values, so the copy is the cheap fork. It already leaves metrics and
+    // profiling off, so look-ahead never counts towards this run's metrics.
+    Simulation branch(*this);
+    branch.set_frame_capture(false);
+    return branch;
+}
+
+Simulation Simulation::fork(unsigned int seed) const
+{
+    Simulation branch = fork();
+    branch.set_random_seed(seed);
+    return branch;
+}
+
+void Simulation::set_frame_capture(bool enabled)
+{
+    capture_enabled_ = enabled;
+    tick_frame_valid_ = false;
+    if (!enabled)
+    {
+        tick_frame_ = TrajectoryFrame(); // Release the columns
+    }
+}
+
+const TrajectoryFrame *Simulation::get_tick_frame() const
+{
+    return tick_frame_valid_ ? &tick_frame_ : nullptr;
+}
+
+void Simulation::set_metrics_enabled(bool enabled)
+{
+    if (!enabled)
+    {
+        metrics_ = nullptr;
+        return;
+    }
+    auto metrics = std::make_shared<SimulationMetrics>(*graph_, current_tick_);
+    // Vehicles already under way will leave edges and queues the fresh counters never
+    // saw them enter
+    for (const auto &pair : vehicles_)
+    {
+        if (pair.second.get_state() == VehicleState::EN_ROUTE)
+            metrics->on_initial_vehicles(pair.second.get_current_edge_id(), 1, 0);
+    }
+    for (const auto &pair : intersections_)
+    {
+        for (int approach_id : pair.second.get_approach_ids())
+        {
+            const std::size_t queued = pair.second.get_vehicle_queue(approach_id).size();
+            if (queued > 0)
+                metrics->on_initial_vehicles(approach_id, 0, static_cast<std::int64_t>(queued));
+        }
+    }
+    metrics_ = std::move(metrics);
+}
+
+std::shared_ptr<const SimulationMetrics> Simulation::get_metrics() const
+{
+    return metrics_;
+}
+
+void Simulation::set_profiling_enabled(bool enabled)
+{
+    profiler_ = enabled ? std::make_shared<TickProfiler>() : nullptr;
+}
+
+std::shared_ptr<const TickProfiler> Simulation::get_profiler() const
+{
+    return profiler_;
+}
+
+namespace
+{
+    // Vehicle columns are sized up front (resize_vehicles) and written by index, which
+    // keeps the per-vehicle cost of capture to a handful of stores.
+    void resize_vehicles(TrajectoryFrame &frame, std::size_t count)
+    {
+        frame.vehicle_ids.resize(count);
+        frame.vehicle_states.resize(count);
+        frame.current_nodes.resize(count);
+        frame.next_nodes.resize(count);
+        frame.progress_ticks.resize(count);
+        frame.total_ticks.resize(count);
+        frame.destinations.resize(count);
+    }
+
+    void store_vehicle(TrajectoryFrame &frame, std::size_t index, int vehicle_id, const Vehicle &vehicle)
+    {
+        frame.vehicle_ids[index] = vehicle_id;
+        frame.vehicle_states[index] = static_cast<std::uint8_t>(vehicle.get_state());
+        frame.current_nodes[index] = vehicle.get_current_node_id();
+        frame.next_nodes[index] = vehicle.get_next_node_id();
+        frame.progress_ticks[index] = vehicle.get_current_edge_progress_ticks();
+        frame.total_ticks[index] = vehicle.get_current_edge_total_ticks();
+        frame.destinations[index] = vehicle.get_destination_node_id();
+    }
+
+    void append_intersections(TrajectoryFrame &frame, const std::map<int, Intersection> &intersections)
+    {
+        for (const auto &pair : intersections)
+        {
+            const Intersection &intersection = pair.second;
+            const std::vector<int> &approaches = intersection.get_approach_ids();
+            frame.intersection_ids.push_back(pair.first);
+            frame.green_indices.push_back(intersection.get_current_green_approach_index());
+            frame.phases.push_back(static_cast<std::uint8_t>(intersection.get_phase_state()));
+            frame.ticks_in_state.push_back(intersection.get_ticks_in_current_state());
+            frame.approach_counts.push_back(static_cast<int>(approaches.size()));
+            for (int approach_id : approaches)
+            {
+                std::size_t before = frame.queued_vehicle_ids.size();
+                intersection.append_queued_vehicle_ids(approach_id, frame.queued_vehicle_ids);
+                frame.approach_ids.push_back(approach_id);
+                frame.queue_lengths.push_back(static_cast<int>(frame.queued_vehicle_ids.size() - before));
+            }
+        }
+    }
+}
+
+void Simulation::capture_frame(TrajectoryFrame &frame) const
+{
+    frame.clear();
+    frame.tick = current_tick_;
+    resize_vehicles(frame, vehicles_.size());
+    std::size_t index = 0;
+    for (const auto &pair : vehicles_)
+    {
+        store_vehicle(frame, index++, pair.first, pair.second);
+    }
+    append_intersections(frame, intersections_);
 }
 
 void Simulation::add_vehicle(const Vehicle &vehicle)
 {
-    vehicles_.emplace(vehicle.get_id(), vehicle);
+    auto inserted = vehicles_.emplace(vehicle.get_id(), vehicle);
+    if (!inserted.second)
+        return;
+    if (vehicle.get_departure_tick() < 0)
+        inserted.first->second.set_departure_tick(current_tick_);
+    if (metrics_)
+        metrics_->on_spawn();
 }
 
 void Simulation::add_intersection(const Intersection &intersection)
 {
-    intersections_.emplace(intersection.get_id(), intersection);
+    // Hinted at the end: loaders add intersections in id order, which makes each insert O(1)
+    intersections_.emplace_hint(intersections_.end(), intersection.get_id(), intersection);
+}
+
+void Simulation::apply_timing_plans(const std::map<int, SignalTimingPlan> &plans)
+{
+    for (const auto &pair : plans)
+    {
+        auto it = intersections_.find(pair.first);
+        if (it != intersections_.end())
+        {
+            it->second.set_timing_plan(pair.second);
+        }
+    }
+}
+
+bool Simulation::load_timing_plans(const std::string &filepath)
+{
+    std::map<int, SignalTimingPlan> plans;
+    if (!::load_timing_plans(filepath, plans))
+    {
+        return false;
+    }
+    apply_timing_plans(plans);
+    return true;
 }
 
 void Simulation::tick()
 {
+    TRACE_SCOPE_ARG("tick", "vehicles", vehicles_.size());
+    TickProfiler *profiler = profiler_.get();
+    PROFILE_TICK_BEGIN(profiler);
     current_tick_++;
+    SimulationMetrics *metrics = metrics_.get();
+    if (metrics)
+        metrics->on_tick(current_tick_);
 
+    TRACE_PHASES(trace_phase, "signals");
     // 1. Update intersection signals
     for (auto &pair : intersections_)
     {
         pair.second.update_signal_state();
     }
+    PROFILE_PHASE_END(profiler, TickPhase::SIGNALS);
+    TRACE_PHASE_NEXT(trace_phase, "spawning");
 
     // --- Vehicle Spawning ---
+    while (next_demand_period_ < demand_profile_.size() &&
+           demand_profile_[next_demand_period_].start_tick < current_tick_)
+    {
+        spawn_interval_ = std::max(0, demand_profile_[next_demand_period_++].spawn_interval);
+        spawn_timer_ = 0;
+    }
     spawn_timer_++;
-    if (spawn_timer_ >= SPAWN_INTERVAL)
+    if (spawn_interval_ > 0 && spawn_timer_ >= spawn_interval_)
     {
         spawn_timer_ = 0;
-        const auto &all_nodes_map = graph_.get_all_nodes();
+        const auto &all_nodes_map = graph_->get_all_nodes();
         if (all_nodes_map.size() >= 2)
         {
-            std::vector<int> node_ids;
+            // Reuse the scratch buffer so steady-state ticks do not allocate
+            std::vector<int> &node_ids = spawn_node_ids_;
+            node_ids.clear();
             for (const auto &node_pair : all_nodes_map)
             {
                 node_ids.push_back(node_pair.first);
@@ -59,7 +327,13 @@ void Simulation::tick()
             if (source_node != dest_node)
             {
                 Vehicle new_vehicle(++last_vehicle_id_, source_node, dest_node);
-                new_vehicle.plan_route(graph_);
+                bool planned = true;
+                if (route_cache_)
+                    new_vehicle.set_route(route_cache_->find_or_plan(source_node, dest_node, &planned));
+                else
+                    new_vehicle.plan_route(*graph_);
+                if (planned)
+                    PROFILE_COUNT(profiler, ProfileCounter::ROUTES_COMPUTED, 1);
                 if (!new_vehicle.get_current_path().empty())
                 {
                     add_vehicle(new_vehicle);
@@ -68,8 +342,20 @@ void Simulation::tick()
         }
     }
 
+    PROFILE_PHASE_END(profiler, TickPhase::SPAWNING);
+    TRACE_PHASE_NEXT(trace_phase, "movement");
+
     // --- Vehicle Updates (Movement Logic) ---
-    std::vector<int> arrived_vehicle_ids;
+    std::vector<int> &arrived_vehicle_ids = arrived_vehicle_ids_;
+    arrived_vehicle_ids.clear();
+    std::size_t captured_vehicles = 0;
+    if (capture_enabled_)
+    {
+        // Vehicle columns are overwritten in place, so only the rest needs clearing
+        tick_frame_.clear_intersections();
+        tick_frame_.tick = current_tick_;
+        resize_vehicles(tick_frame_, vehicles_.size());
+    }
 
     for (auto &vehicle_pair : vehicles_)
     {
@@ -79,7 +365,9 @@ void Simulation::tick()
         {
         case VehicleState::NOT_STARTED:
         {
-            vehicle.start_journey(graph_);
+            vehicle.start_journey(*graph_);
+            if (metrics && vehicle.get_state() == VehicleState::EN_ROUTE)
+                metrics->on_edge_enter(vehicle.get_current_edge_id());
             // **FIX:** No break here! Allow fall-through to EN_ROUTE case.
             // This ensures the vehicle makes its first move in the same tick it starts.
         }
@@ -92,8 +380,11 @@ void Simulation::tick()
             if (vehicle.get_current_edge_progress_ticks() >= vehicle.get_current_edge_total_ticks())
             {
                 int new_current_node_id = vehicle.get_next_node_id();
+                if (metrics)
+                    metrics->on_edge_exit(vehicle.get_current_edge_id());
                 vehicle.set_current_node_id(new_current_node_id);
                 vehicle.set_current_edge_ticks(0, 0);
+                vehicle.set_current_edge_id(-1);
 
                 if (new_current_node_id == vehicle.get_destination_node_id())
                 {
@@ -116,12 +407,18 @@ void Simulation::tick()
                     if (current_path_index != (size_t)-1 && current_path_index + 1 < path.size())
                     {
                         vehicle.set_next_node_id(path[current_path_index + 1]);
+                        PROFILE_COUNT(profiler, ProfileCounter::MAP_LOOKUPS, 1);
                         if (intersections_.count(new_current_node_id))
                         {
-                            const Edge *outgoing_edge = graph_.get_edge_between(new_current_node_id, vehicle.get_next_node_id());
+                            const Edge *outgoing_edge = graph_->get_edge_between(new_current_node_id, vehicle.get_next_node_id());
+                            PROFILE_COUNT(profiler, ProfileCounter::MAP_LOOKUPS, 2);
                             if (outgoing_edge)
                             {
                                 intersections_.at(new_current_node_id).add_vehicle_to_queue(vehicle.get_id(), outgoing_edge->id);
+                                PROFILE_COUNT(profiler, ProfileCounter::QUEUE_OPERATIONS, 1);
+                                vehicle.set_queue_entry_tick(current_tick_);
+                                if (metrics)
+                                    metrics->on_queue_join(outgoing_edge->id);
                             }
                             else
                             {
@@ -151,13 +448,16 @@ void Simulation::tick()
                 break;
             }
 
+            PROFILE_COUNT(profiler, ProfileCounter::MAP_LOOKUPS, 1);
             if (intersections_.count(current_loc_node_id))
             {
                 Intersection &intersection = intersections_.at(current_loc_node_id);
-                const Edge *outgoing_edge = graph_.get_edge_between(current_loc_node_id, next_target_node_id);
+                const Edge *outgoing_edge = graph_->get_edge_between(current_loc_node_id, next_target_node_id);
+                PROFILE_COUNT(profiler, ProfileCounter::MAP_LOOKUPS, 2);
                 if (outgoing_edge)
                 {
                     int outgoing_edge_id = outgoing_edge->id;
+                    PROFILE_COUNT(profiler, ProfileCounter::QUEUE_OPERATIONS, 1);
                     bool can_proceed = false;
                     if (!intersection.get_vehicle_queue(outgoing_edge_id).empty() &&
                         intersection.get_vehicle_queue(outgoing_edge_id).front() == vehicle.get_id())
@@ -168,11 +468,20 @@ void Simulation::tick()
                     if (intersection.get_signal_state(outgoing_edge_id) == LightState::GREEN && can_proceed)
                     {
                         intersection.pop_vehicle_from_queue(outgoing_edge_id);
+                        PROFILE_COUNT(profiler, ProfileCounter::QUEUE_OPERATIONS, 1);
+                        int waited_ticks = current_tick_ - vehicle.get_queue_entry_tick();
+                        vehicle.add_delay_ticks(waited_ticks);
+                        if (metrics)
+                        {
+                            metrics->on_queue_discharge(outgoing_edge_id, waited_ticks);
+                            metrics->on_edge_enter(outgoing_edge_id);
+                        }
                         vehicle.set_state(VehicleState::EN_ROUTE);
                         int travel_ticks = static_cast<int>(outgoing_edge->weight);
                         if (travel_ticks < 1)
                             travel_ticks = 1;
                         vehicle.set_current_edge_ticks(0, travel_ticks);
+                        vehicle.set_current_edge_id(outgoing_edge_id);
                         // After changing state, immediately give it one tick of progress
                         vehicle.increment_edge_progress_ticks();
                     }
@@ -197,18 +506,49 @@ void Simulation::tick()
         if (vehicle.get_state() == VehicleState::ARRIVED)
         {
             arrived_vehicle_ids.push_back(vehicle_pair.first);
+            if (metrics)
+            {
+                // Routing errors also end in ARRIVED, away from the destination
+                if (vehicle.get_current_node_id() == vehicle.get_destination_node_id())
+                    metrics->on_trip_complete(vehicle.get_source_node_id(), vehicle.get_destination_node_id(),
+                                              current_tick_ - vehicle.get_departure_tick(), vehicle.get_delay_ticks());
+                else
+                    metrics->on_trip_aborted();
+            }
+        }
+        else if (capture_enabled_)
+        {
+            // This vehicle is final for the tick; record it while it is in cache
+            store_vehicle(tick_frame_, captured_vehicles++, vehicle_pair.first, vehicle);
         }
     }
 
+    PROFILE_PHASE_END(profiler, TickPhase::MOVEMENT);
+    TRACE_PHASE_NEXT(trace_phase, "despawning");
+
     // --- Vehicle Despawning ---
     for (int vehicle_id : arrived_vehicle_ids)
     {
         vehicles_.erase(vehicle_id);
     }
+    PROFILE_PHASE_END(profiler, TickPhase::DESPAWNING);
+    TRACE_PHASE_NEXT(trace_phase, "finish tick");
+
+    if (metrics)
+        metrics->on_tick_end();
+
+    if (capture_enabled_)
+    {
+        resize_vehicles(tick_frame_, captured_vehicles); // Drop the slots of arrived vehicles
+        append_intersections(tick_frame_, intersections_);
+        tick_frame_valid_ = true;
+    }
+    PROFILE_TICK_END(profiler);
 }
 
 int Simulation::get_current_tick() const { return current_tick_; }
-const Graph &Simulation::get_graph() const { return graph_; }
+const Graph &Simulation::get_graph() const { return *graph_; }
+std::shared_ptr<const Graph> Simulation::get_shared_graph() const { return graph_; }
 const std::map<int, Vehicle> &Simulation::get_vehicles() const { return vehicles_; }
 const std::map<int, Intersection> &Simulation::get_intersections() const { return intersections_; }
 Vehicle *Simulation::get_vehicle_by_id(int vehicle_id)
@@ -0,0 +1,193 @@
+#include "simulation_thread.hpp"
+#include "state_server.hpp"
+
+#include <algorithm> // For std::min, std::sort
+#include <chrono>
+#include <utility> // For std::move
+
+namespace
+{
+    std::uint64_t steady_now_ns()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    // How far the thread may fall behind its target rate before it gives up catching up
+    const std::chrono::milliseconds MAX_LAG(250);
+    // How often a paused or sleeping thread looks at its flags again
+    const std::chrono::milliseconds PAUSE_POLL(5);
+}
+
+void StateSnapshot::capture(const SimulationView &view, const Graph &graph)
+{
+    tick = view.get_current_tick();
+    published_ns = steady_now_ns();
+    vehicle_count = view.get_vehicles().size();
+
+    vehicles.clear();
+    for (const auto &pair : view.get_vehicles()) // Ascending id
+    {
+        const Vehicle &vehicle = pair.second;
+        if (vehicle.get_state() != VehicleState::EN_ROUTE)
+            continue;
+        const Node *from = graph.get_node(vehicle.get_current_node_id());
+        const Node *to = graph.get_node(vehicle.get_next_node_id());
+        if (!from || !to)
+            continue;
+        double progress = 1.0;
+        if (vehicle.get_current_edge_total_ticks() > 0)
+            progress = static_cast<double>(vehicle.get_current_edge_progress_ticks()) /
+                       vehicle.get_current_edge_total_ticks();
+        if (progress > 1.0)
+            progress = 1.0;
+        int edge_id = vehicle.get_current_edge_id();
+        if (edge_id < 0)
+        {
+            // Replayed vehicles (TrajectoryReplay) carry nodes but no edge id
+            const Edge *edge = graph.get_edge_between(from->id, to->id);
+            edge_id = edge ? edge->id : -1;
+        }
+        vehicles.push_back({pair.first, edge_id,
+                            static_cast<float>(from->x + (to->x - from->x) * progress),
+                            static_cast<float>(from->y + (to->y - from->y) * progress)});
+    }
+
+    signals.clear();
+    queues.clear();
+    for (const auto &pair : view.get_intersections())
+    {
+        const Intersection &intersection = pair.second;
+        for (int approach_id : intersection.get_approach_ids())
+            queues.push_back({approach_id, static_cast<int>(intersection.get_vehicle_queue(approach_id).size())});
+        const Node *node = graph.get_node(intersection.get_id());
+        if (!node)
+            continue;
+        SignalLight light{pair.first, static_cast<float>(node->x), static_cast<float>(node->y), false, LightState::RED};
+        if (!intersection.get_approach_ids().empty())
+        {
+            light.has_approaches = true;
+            light.state = intersection.get_signal_state(intersection.get_approach_ids()[0]);
+        }
+        signals.push_back(light);
+    }
+    // Approach ids are only unique across intersections, not ordered by them
+    std::sort(queues.begin(), queues.end(),
+              [](const QueueLength &a, const QueueLength &b) { return a.approach_id < b.approach_id; });
+}
+
+SimulationThread::SimulationThread(Simulation simulation, int max_ticks)
+    : simulation_(std::move(simulation)),
+      max_ticks_(max_ticks),
+      state_server_(nullptr),
+      stopping_(false),
+      ticks_per_second_(UNBOUNDED),
+      paused_(false)
+{
+    // The reader has something to draw before the first tick
+    snapshots_.write_buffer().capture(simulation_, simulation_.get_graph());
+    snapshots_.publish();
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+void SimulationThread::start()
+{
+    if (thread_.joinable())
+        return;
+    stopping_.store(false);
+    thread_ = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop()
+{
+    stopping_.store(true);
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void SimulationThread::set_ticks_per_second(double ticks_per_second)
+{
+    ticks_per_second_.store(ticks_per_second > 0.0 ? ticks_per_second : UNBOUNDED);
+}
+
+double SimulationThread::get_ticks_per_second() const
+{
+    return ticks_per_second_.load();
+}
+
+void SimulationThread::set_paused(bool paused)
+{
+    paused_.store(paused);
+}
+
+bool SimulationThread::is_paused() const
+{
+    return paused_.load();
+}
+
+void SimulationThread::set_state_server(StateServer *server)
+{
+    state_server_ = server;
+}
+
+TripleBuffer<StateSnapshot> &SimulationThread::get_snapshots()
+{
+    return snapshots_;
+}
+
+const Graph &SimulationThread::get_graph() const
+{
+    return simulation_.get_graph();
+}
+
+const Simulation &SimulationThread::get_simulation() const
+{
+    return simulation_;
+}
+
+void SimulationThread::run()
+{
+    using clock = std::chrono::steady_clock;
+    clock::time_point next_tick = clock::now();
+    while (!stopping_.load(std::memory_order_relaxed))
+    {
+        if (paused_.load(std::memory_order_relaxed) ||
+            (max_ticks_ > 0 && simulation_.get_current_tick() >= max_ticks_))
+        {
+            std::this_thread::sleep_for(PAUSE_POLL);
+            next_tick = clock::now(); // Resume at the target rate, not in a burst
+            continue;
+        }
+
+        simulation_.tick();
+        snapshots_.write_buffer().capture(simulation_, simulation_.get_graph());
+        if (state_server_)
+            state_server_->publish(snapshots_.write_buffer()); // A copy, cheaper than capturing again
+        snapshots_.publish();
+
+        const double ticks_per_second = ticks_per_second_.load(std::memory_order_relaxed);
+        if (ticks_per_second == UNBOUNDED)
+        {
+            next_tick = clock::now();
+            continue;
+        }
+        next_tick += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / ticks_per_second));
+        clock::time_point now = clock::now();
+        if (now - next_tick > MAX_LAG)
+        {
+            next_tick = now; // Far behind: drop the backlog rather than burst to catch up
+            continue;
+        }
+        // In short steps, so stop() does not wait out a slow rate
+        while (now < next_tick && !stopping_.load(std::memory_order_relaxed))
+        {
+            std::this_thread::sleep_until(std::min(next_tick, now + PAUSE_POLL));
+            now = clock::now();
+        }
+    }
+}
@@ -0,0 +1,214 @@
+#include "spatial_grid.hpp"
+
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For std::sqrt, std::floor
+
+namespace
+{
+    // Items (nodes plus edges) per cell the grid is sized for
+    const double ITEMS_PER_CELL = 2.0;
+    // Upper bound on the number of cells, whatever the graph's shape
+    const double MAX_CELLS = 4.0e6;
+
+    // Boxes of edges whose nodes are missing are inverted, so they match nothing
+    bool is_empty(const BoundingBox &box)
+    {
+        return box.min_x > box.max_x;
+    }
+}
+
+bool BoundingBox::intersects(const BoundingBox &other) const
+{
+    return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+}
+
+bool BoundingBox::contains(const BoundingBox &other) const
+{
+    return min_x <= other.min_x && other.max_x <= max_x && min_y <= other.min_y && other.max_y <= max_y;
+}
+
+SpatialGrid::SpatialGrid(const Graph &graph)
+    : cell_size_(1.0),
+      columns_(1),
+      rows_(1)
+{
+    bool first = true;
+    auto extend = [this, &first](const BoundingBox &box)
+    {
+        if (first)
+            bounds_ = box;
+        bounds_.min_x = std::min(bounds_.min_x, box.min_x);
+        bounds_.min_y = std::min(bounds_.min_y, box.min_y);
+        bounds_.max_x = std::max(bounds_.max_x, box.max_x);
+        bounds_.max_y = std::max(bounds_.max_y, box.max_y);
+        first = false;
+    };
+
+    for (const auto &pair : graph.get_all_nodes())
+    {
+        const Node &node = pair.second;
+        node_index_[node.id] = static_cast<int>(node_ids_.size());
+        node_ids_.push_back(node.id);
+        BoundingBox box{node.x, node.y, node.x, node.y};
+        node_bounds_.push_back(box);
+        extend(box);
+    }
+    for (const auto &pair : graph.get_all_edges())
+    {
+        const Edge &edge = pair.second;
+        edge_index_[edge.id] = static_cast<int>(edge_ids_.size());
+        edge_ids_.push_back(edge.id);
+        const Node *from = graph.get_node(edge.from_node_id);
+        const Node *to = graph.get_node(edge.to_node_id);
+        BoundingBox box{1.0, 1.0, 0.0, 0.0}; // Empty
+        if (from && to)
+        {
+            box = BoundingBox{std::min(from->x, to->x), std::min(from->y, to->y), std::max(from->x, to->x),
+                              std::max(from->y, to->y)};
+            extend(box);
+        }
+        edge_bounds_.push_back(box);
+    }
+
+    const double width = bounds_.max_x - bounds_.min_x;
+    const double height = bounds_.max_y - bounds_.min_y;
+    const double cells = std::min(MAX_CELLS, std::max(1.0, (node_ids_.size() + edge_ids_.size()) / ITEMS_PER_CELL));
+    // Square cells; a degenerate (line or point) extent is covered by a single row or column
+    const double area = std::max(width, 1e-9) * std::max(height, 1e-9);
+    cell_size_ = std::max(std::sqrt(area / cells), std::max(width, height) / cells);
+    if (cell_size_ <= 0.0)
+        cell_size_ = 1.0;
+    columns_ = static_cast<int>(std::min(MAX_CELLS, std::floor(width / cell_size_) + 1));
+    rows_ = static_cast<int>(std::min(MAX_CELLS / columns_, std::floor(height / cell_size_) + 1));
+
+    fill_cells(node_bounds_, node_cells_);
+    fill_cells(edge_bounds_, edge_cells_);
+}
+
+int SpatialGrid::cell_column(double x) const
+{
+    double column = std::floor((x - bounds_.min_x) / cell_size_);
+    return static_cast<int>(std::max(0.0, std::min(column, static_cast<double>(columns_ - 1))));
+}
+
+int SpatialGrid::cell_row(double y) const
+{
+    double row = std::floor((y - bounds_.min_y) / cell_size_);
+    return static_cast<int>(std::max(0.0, std::min(row, static_cast<double>(rows_ - 1))));
+}
+
+void SpatialGrid::fill_cells(const std::vector<BoundingBox> &boxes, CellLists &lists) const
+{
+    // Counting pass, then a placement pass into one flat array
+    const std::size_t cell_count = static_cast<std::size_t>(columns_) * rows_;
+    lists.starts.assign(cell_count + 1, 0);
+    for (const BoundingBox &box : boxes)
+    {
+        if (is_empty(box))
+            continue;
+        for (int row = cell_row(box.min_y); row <= cell_row(box.max_y); ++row)
+            for (int column = cell_column(box.min_x); column <= cell_column(box.max_x); ++column)
+                ++lists.starts[static_cast<std::size_t>(row) * columns_ + column + 1];
+    }
+    for (std::size_t c = 0; c < cell_count; ++c)
+        lists.starts[c + 1] += lists.starts[c];
+
+    lists.items.assign(static_cast<std::size_t>(lists.starts[cell_count]), 0);
+    std::vector<int> next(lists.starts.begin(), lists.starts.end() - 1);
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        const BoundingBox &box = boxes[i];
+        if (is_empty(box))
+            continue;
+        for (int row = cell_row(box.min_y); row <= cell_row(box.max_y); ++row)
+            for (int column = cell_column(box.min_x); column <= cell_column(box.max_x); ++column)
+                lists.items[static_cast<std::size_t>(next[static_cast<std::size_t>(row) * columns_ + column]++)] =
+                    static_cast<int>(i);
+    }
+}
+
+void SpatialGrid::query(const BoundingBox &area, const std::vector<BoundingBox> &boxes, const CellLists &lists,
+                        std::vector<int> &out) const
+{
+    out.clear();
+    if (boxes.empty() || !area.intersects(bounds_))
+        return;
+    const int first_column = cell_column(area.min_x), last_column = cell_column(area.max_x);
+    const int first_row = cell_row(area.min_y), last_row = cell_row(area.max_y);
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        for (int column = first_column; column <= last_column; ++column)
+        {
+            const std::size_t cell = static_cast<std::size_t>(row) * columns_ + column;
+            for (int k = lists.starts[cell]; k < lists.starts[cell + 1]; ++k)
+            {
+                const int item = lists.items[static_cast<std::size_t>(k)];
+                const BoundingBox &box = boxes[static_cast<std::size_t>(item)];
+                if (!box.intersects(area))
+                    continue;
+                // An item spanning several cells is reported only from the cell holding
+                // the lowest corner of its overlap with the area, so it comes out once
+                if (cell_column(std::max(box.min_x, area.min_x)) == column &&
+                    cell_row(std::max(box.min_y, area.min_y)) == row)
+                    out.push_back(item);
+            }
+        }
+    }
+}
+
+void SpatialGrid::query_edges(const BoundingBox &area, std::vector<int> &out) const
+{
+    query(area, edge_bounds_, edge_cells_, out);
+}
+
+void SpatialGrid::query_nodes(const BoundingBox &area, std::vector<int> &out) const
+{
+    query(area, node_bounds_, node_cells_, out);
+}
+
+std::size_t SpatialGrid::edge_count() const
+{
+    return edge_ids_.size();
+}
+
+std::size_t SpatialGrid::node_count() const
+{
+    return node_ids_.size();
+}
+
+int SpatialGrid::get_edge_id(int edge_index) const
+{
+    return edge_ids_[static_cast<std::size_t>(edge_index)];
+}
+
+int SpatialGrid::get_node_id(int node_index) const
+{
+    return node_ids_[static_cast<std::size_t>(node_index)];
+}
+
+int SpatialGrid::find_edge_index(int edge_id) const
+{
+    auto found = edge_index_.find(edge_id);
+    return found == edge_index_.end() ? -1 : found->second;
+}
+
+int SpatialGrid::find_node_index(int node_id) const
+{
+    auto found = node_index_.find(node_id);
+    return found == node_index_.end() ? -1 : found->second;
+}
+
+const BoundingBox &SpatialGrid::get_edge_bounds(int edge_index) const
+{
+    return edge_bounds_[static_cast<std::size_t>(edge_index)];
+}
+
+const BoundingBox &SpatialGrid::get_bounds() const
+{
+    return bounds_;
+}
+
+double SpatialGrid::get_cell_size() const
+{
+    return cell_size_;
+}
@@ -0,0 +1,274 @@
+#include "state_server.hpp"
+#include "state_stream.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm> // For std::min, std::max, std::remove_if
+#include <cerrno>
+#include <chrono>
+#include <cstring> // For std::memcpy
+#include <utility> // For std::move
+
+namespace
+{
+    // Longest the server thread sleeps before looking at stopping_ again
+    const int MAX_POLL_MS = 50;
+
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL; // A vanished client must not raise SIGPIPE
+#else
+    const int SEND_FLAGS = 0; // SO_NOSIGPIPE is set on each client instead
+#endif
+
+    bool set_non_blocking(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+}
+
+StateServer::StateServer()
+    : listen_fd_(-1),
+      max_updates_per_second_(DEFAULT_MAX_UPDATES_PER_SECOND),
+      stopping_(false),
+      has_snapshot_(false),
+      client_count_(0),
+      updates_sent_(0),
+      updates_skipped_(0),
+      bytes_sent_(0)
+{
+}
+
+StateServer::~StateServer()
+{
+    stop();
+}
+
+bool StateServer::start(const std::string &socket_path, double max_updates_per_second)
+{
+    stop();
+    sockaddr_un address{};
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path) || max_updates_per_second <= 0.0)
+        return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    // A socket file left behind by an earlier run would make bind() fail; anything else
+    // at that path is not ours to delete
+    struct stat existing;
+    if (lstat(socket_path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+        unlink(socket_path.c_str());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+        return false;
+    if (bind(listen_fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0 || !set_non_blocking(listen_fd_))
+    {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    socket_path_ = socket_path;
+    max_updates_per_second_ = max_updates_per_second;
+    stopping_.store(false);
+    thread_ = std::thread(&StateServer::serve, this);
+    return true;
+}
+
+void StateServer::stop()
+{
+    stopping_.store(true);
+    if (thread_.joinable())
+        thread_.join();
+    if (listen_fd_ >= 0)
+    {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(socket_path_.c_str());
+    }
+}
+
+bool StateServer::is_running() const
+{
+    return thread_.joinable();
+}
+
+void StateServer::publish(const StateSnapshot &snapshot)
+{
+    snapshots_.write_buffer() = snapshot; // Reuses the buffer's capacity
+    snapshots_.publish();
+}
+
+void StateServer::publish(const SimulationView &view, const Graph &graph)
+{
+    snapshots_.write_buffer().capture(view, graph);
+    snapshots_.publish();
+}
+
+std::size_t StateServer::get_client_count() const
+{
+    return client_count_.load();
+}
+
+std::uint64_t StateServer::get_updates_sent() const
+{
+    return updates_sent_.load();
+}
+
+std::uint64_t StateServer::get_updates_skipped() const
+{
+    return updates_skipped_.load();
+}
+
+std::uint64_t StateServer::get_bytes_sent() const
+{
+    return bytes_sent_.load();
+}
+
+void StateServer::serve()
+{
+    using clock = std::chrono::steady_clock;
+    const clock::duration interval =
+        std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / max_updates_per_second_));
+    clock::time_point next_update = clock::now();
+    std::vector<pollfd> fds;
+    while (!stopping_.load(std::memory_order_relaxed))
+    {
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const Client &client : clients_)
+        {
+            short events = POLLIN; // Input is discarded, but reading it notices hang-ups
+            if (client.output_offset < client.output.size())
+                events |= POLLOUT;
+            fds.push_back({client.fd, events, 0});
+        }
+        const auto until_update = std::chrono::duration_cast<std::chrono::milliseconds>(next_update - clock::now());
+        const int timeout =
+            static_cast<int>(std::max<long long>(0, std::min<long long>(until_update.count(), MAX_POLL_MS)));
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout) < 0 && errno != EINTR)
+            break;
+
+        // fds[i + 1] belongs to clients_[i]; new clients are only added after this pass
+        for (std::size_t i = 0; i < clients_.size(); ++i)
+        {
+            Client &client = clients_[i];
+            const short revents = fds[i + 1].revents;
+            bool alive = !(revents & (POLLERR | POLLNVAL));
+            if (alive && (revents & (POLLIN | POLLHUP)))
+            {
+                scratch_.resize(4096);
+                ssize_t received = recv(client.fd, scratch_.data(), scratch_.size(), 0);
+                alive = received > 0 || (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+            }
+            if (alive && (revents & POLLOUT))
+                alive = flush_client(client);
+            if (!alive)
+                disconnect(client);
+        }
+        if (fds[0].revents & POLLIN)
+            accept_clients();
+
+        const clock::time_point now = clock::now();
+        if (now >= next_update)
+        {
+            // On schedule, but never in a burst after a stall
+            next_update = std::max(next_update + interval, now);
+            const bool is_new = snapshots_.update();
+            has_snapshot_ = has_snapshot_ || is_new;
+            if (has_snapshot_)
+                send_latest(snapshots_.read_buffer(), is_new);
+        }
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                      [](const Client &client) { return client.fd < 0; }),
+                       clients_.end());
+        client_count_.store(clients_.size());
+    }
+    close_clients();
+}
+
+void StateServer::accept_clients()
+{
+    for (;;)
+    {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0)
+            return; // EAGAIN: no one else is waiting
+        if (!set_non_blocking(fd))
+        {
+            close(fd);
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        Client client;
+        client.fd = fd;
+        client.output.assign(StateStreamFormat::MAGIC, StateStreamFormat::MAGIC + sizeof(StateStreamFormat::MAGIC));
+        clients_.push_back(std::move(client));
+    }
+}
+
+bool StateServer::flush_client(Client &client)
+{
+    while (client.output_offset < client.output.size())
+    {
+        ssize_t written = send(client.fd, client.output.data() + client.output_offset,
+                               client.output.size() - client.output_offset, SEND_FLAGS);
+        if (written < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        client.output_offset += static_cast<std::size_t>(written);
+        bytes_sent_.fetch_add(static_cast<std::uint64_t>(written), std::memory_order_relaxed);
+    }
+    client.output.clear();
+    client.output_offset = 0;
+    return true;
+}
+
+void StateServer::send_latest(const StateSnapshot &snapshot, bool is_new)
+{
+    for (Client &client : clients_)
+    {
+        if (client.fd < 0)
+            continue;
+        if (client.has_state && client.output_offset < client.output.size())
+        {
+            // Still draining its previous update: this state is skipped for this client
+            if (is_new)
+                updates_skipped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (client.has_state && !is_new && client.sent.tick == snapshot.tick)
+            continue; // Up to date
+        // A new client's header may still be queued in front of its KEY update
+        encode_state_update(client.sent, snapshot, !client.has_state, client.output);
+        client.sent = snapshot;
+        client.has_state = true;
+        updates_sent_.fetch_add(1, std::memory_order_relaxed);
+        if (!flush_client(client))
+            disconnect(client);
+    }
+}
+
+void StateServer::disconnect(Client &client)
+{
+    close(client.fd);
+    client.fd = -1; // Removed from clients_ at the end of the server loop
+}
+
+void StateServer::close_clients()
+{
+    for (Client &client : clients_)
+    {
+        if (client.fd >= 0)
+            close(client.fd);
+    }
+    clients_.clear();
+    client_count_.store(0);
+}
@@ -0,0 +1,361 @@
+#include "state_stream.hpp"
+#include "varint.hpp"
+
+#include <cstring> // For std::memcpy, std::memcmp
+#include <limits>
+
+namespace
+{
+    // Largest update payload a decoder accepts
+    const std::uint64_t MAX_PAYLOAD_BYTES = std::uint64_t(1) << 30;
+
+    void append_float(std::vector<std::uint8_t> &out, float value)
+    {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int byte = 0; byte < 4; ++byte)
+            out.push_back(static_cast<std::uint8_t>(bits >> (8 * byte)));
+    }
+
+    bool read_float(const std::uint8_t *&cursor, const std::uint8_t *end, float &out_value)
+    {
+        if (end - cursor < 4)
+            return false;
+        std::uint32_t bits = 0;
+        for (int byte = 0; byte < 4; ++byte)
+            bits |= static_cast<std::uint32_t>(*cursor++) << (8 * byte);
+        std::memcpy(&out_value, &bits, sizeof(out_value));
+        return true;
+    }
+
+    bool read_int(const std::uint8_t *&cursor, const std::uint8_t *end, int &out_value)
+    {
+        std::int64_t value = 0;
+        if (!Varint::read_signed(cursor, end, value))
+            return false;
+        out_value = static_cast<int>(value);
+        return true;
+    }
+
+    // --- Per-section entry codecs ---
+
+    int entry_id(const StateSnapshot::VehiclePosition &vehicle)
+    {
+        return vehicle.vehicle_id;
+    }
+    int entry_id(const StateSnapshot::SignalLight &light)
+    {
+        return light.intersection_id;
+    }
+    int entry_id(const StateSnapshot::QueueLength &queue)
+    {
+        return queue.approach_id;
+    }
+
+    std::uint8_t signal_state_byte(const StateSnapshot::SignalLight &light)
+    {
+        return light.has_approaches ? static_cast<std::uint8_t>(light.state) : StateStreamFormat::SIGNAL_NO_APPROACHES;
+    }
+
+    bool same_entry(const StateSnapshot::VehiclePosition &a, const StateSnapshot::VehiclePosition &b)
+    {
+        return a.edge_id == b.edge_id && a.x == b.x && a.y == b.y;
+    }
+    bool same_entry(const StateSnapshot::SignalLight &a, const StateSnapshot::SignalLight &b)
+    {
+        return signal_state_byte(a) == signal_state_byte(b) && a.x == b.x && a.y == b.y;
+    }
+    bool same_entry(const StateSnapshot::QueueLength &a, const StateSnapshot::QueueLength &b)
+    {
+        return a.length == b.length;
+    }
+
+    void append_fields(std::vector<std::uint8_t> &out, const StateSnapshot::VehiclePosition &vehicle)
+    {
+        Varint::append_signed(out, vehicle.edge_id);
+        append_float(out, vehicle.x);
+        append_float(out, vehicle.y);
+    }
+    void append_fields(std::vector<std::uint8_t> &out, const StateSnapshot::SignalLight &light)
+    {
+        out.push_back(signal_state_byte(light));
+        append_float(out, light.x);
+        append_float(out, light.y);
+    }
+    void append_fields(std::vector<std::uint8_t> &out, const StateSnapshot::QueueLength &queue)
+    {
+        Varint::append_signed(out, queue.length);
+    }
+
+    bool read_entry(const std::uint8_t *&cursor, const std::uint8_t *end, int id,
+                    StateSnapshot::VehiclePosition &vehicle)
+    {
+        vehicle.vehicle_id = id;
+        return read_int(cursor, end, vehicle.edge_id) && read_float(cursor, end, vehicle.x) &&
+               read_float(cursor, end, vehicle.y);
+    }
+    bool read_entry(const std::uint8_t *&cursor, const std::uint8_t *end, int id, StateSnapshot::SignalLight &light)
+    {
+        if (cursor == end || *cursor > StateStreamFormat::SIGNAL_NO_APPROACHES)
+            return false;
+        const std::uint8_t state = *cursor++;
+        light.intersection_id = id;
+        light.has_approaches = state != StateStreamFormat::SIGNAL_NO_APPROACHES;
+        light.state = light.has_approaches ? static_cast<LightState>(state) : LightState::RED;
+        return read_float(cursor, end, light.x) && read_float(cursor, end, light.y);
+    }
+    bool read_entry(const std::uint8_t *&cursor, const std::uint8_t *end, int id, StateSnapshot::QueueLength &queue)
+    {
+        queue.approach_id = id;
+        return read_int(cursor, end, queue.length);
+    }
+
+    // Walks two id-sorted lists together, reporting entries of `current` that are new or
+    // differ from `previous` and ids of `previous` missing from `current`. With `key`,
+    // every entry of `current` is reported and nothing is removed.
+    template <typename Entry, typename OnChanged, typename OnRemoved>
+    void diff_section(const std::vector<Entry> &previous, const std::vector<Entry> &current, bool key,
+                      OnChanged on_changed, OnRemoved on_removed)
+    {
+        if (key)
+        {
+            for (const Entry &entry : current)
+                on_changed(entry);
+            return;
+        }
+        std::size_t p = 0, c = 0;
+        while (p < previous.size() || c < current.size())
+        {
+            if (c == current.size() || (p < previous.size() && entry_id(previous[p]) < entry_id(current[c])))
+                on_removed(entry_id(previous[p++]));
+            else if (p == previous.size() || entry_id(current[c]) < entry_id(previous[p]))
+                on_changed(current[c++]);
+            else
+            {
+                if (!same_entry(previous[p], current[c]))
+                    on_changed(current[c]);
+                ++p;
+                ++c;
+            }
+        }
+    }
+
+    template <typename Entry>
+    void encode_section(const std::vector<Entry> &previous, const std::vector<Entry> &current, bool key,
+                        std::vector<std::uint8_t> &out)
+    {
+        // Counting first keeps the counts in front of their entries without a scratch buffer
+        std::uint64_t changed = 0, removed = 0;
+        diff_section(previous, current, key, [&](const Entry &) { ++changed; }, [&](int) { ++removed; });
+
+        std::int64_t last_id = 0;
+        auto append_changed = [&](const Entry &entry)
+        {
+            Varint::append_signed(out, static_cast<std::int64_t>(entry_id(entry)) - last_id);
+            last_id = entry_id(entry);
+            append_fields(out, entry);
+        };
+        auto append_removed = [&](int id)
+        {
+            Varint::append_signed(out, static_cast<std::int64_t>(id) - last_id);
+            last_id = id;
+        };
+        Varint::append_unsigned(out, changed);
+        diff_section(previous, current, key, append_changed, [](int) {});
+        Varint::append_unsigned(out, removed);
+        last_id = 0;
+        diff_section(previous, current, key, [](const Entry &) {}, append_removed);
+    }
+
+    // Reads the next delta-coded id of a list; ids must be strictly ascending
+    bool read_id(const std::uint8_t *&cursor, const std::uint8_t *end, bool first, std::int64_t &id)
+    {
+        std::int64_t delta = 0;
+        if (!Varint::read_signed(cursor, end, delta) || delta > (std::int64_t(1) << 33) ||
+            delta < -(std::int64_t(1) << 33))
+            return false;
+        std::int64_t next = id + delta;
+        if ((!first && next <= id) || next < std::numeric_limits<int>::min() || next > std::numeric_limits<int>::max())
+            return false;
+        id = next;
+        return true;
+    }
+
+    // Decodes one section into `changes` and `removed`, then merges it with `state` into
+    // `merged`. A KEY section replaces the state outright.
+    template <typename Entry>
+    bool decode_section(const std::uint8_t *&cursor, const std::uint8_t *end, bool key,
+                        const std::vector<Entry> &state, std::vector<Entry> &changes, std::vector<int> &removed,
+                        std::vector<Entry> &merged)
+    {
+        std::uint64_t count = 0;
+        if (!Varint::read_unsigned(cursor, end, count) || count > static_cast<std::uint64_t>(end - cursor))
+            return false;
+        changes.resize(static_cast<std::size_t>(count));
+        std::int64_t id = 0;
+        for (std::size_t i = 0; i < changes.size(); ++i)
+        {
+            if (!read_id(cursor, end, i == 0, id) || !read_entry(cursor, end, static_cast<int>(id), changes[i]))
+                return false;
+        }
+        if (!Varint::read_unsigned(cursor, end, count) || count > static_cast<std::uint64_t>(end - cursor) ||
+            (key && count > 0))
+            return false;
+        removed.resize(static_cast<std::size_t>(count));
+        id = 0;
+        for (std::size_t i = 0; i < removed.size(); ++i)
+        {
+            if (!read_id(cursor, end, i == 0, id))
+                return false;
+            removed[i] = static_cast<int>(id);
+        }
+
+        if (key)
+        {
+            merged.swap(changes);
+            return true;
+        }
+        merged.clear();
+        std::size_t s = 0, c = 0, r = 0;
+        while (s < state.size() || c < changes.size())
+        {
+            if (c == changes.size() || (s < state.size() && entry_id(state[s]) < entry_id(changes[c])))
+            {
+                const int old_id = entry_id(state[s]);
+                while (r < removed.size() && removed[r] < old_id)
+                    ++r;
+                if (r == removed.size() || removed[r] != old_id)
+                    merged.push_back(state[s]);
+                ++s;
+            }
+            else
+            {
+                if (s < state.size() && entry_id(state[s]) == entry_id(changes[c]))
+                    ++s; // Replaced
+                merged.push_back(changes[c++]);
+            }
+        }
+        return true;
+    }
+}
+
+void encode_state_update(const StateSnapshot &previous, const StateSnapshot &current, bool key,
+                         std::vector<std::uint8_t> &out)
+{
+    out.push_back(key ? StateStreamFormat::UPDATE_KEY : StateStreamFormat::UPDATE_DELTA);
+    const std::size_t payload_start = out.size();
+    Varint::append_unsigned(out, static_cast<std::uint64_t>(current.tick));
+    Varint::append_unsigned(out, current.vehicle_count);
+    encode_section(previous.vehicles, current.vehicles, key, out);
+    encode_section(previous.signals, current.signals, key, out);
+    encode_section(previous.queues, current.queues, key, out);
+
+    // The size goes in front of the payload; shifting it is cheap next to encoding it
+    std::vector<std::uint8_t> size;
+    Varint::append_unsigned(size, out.size() - payload_start);
+    out.insert(out.begin() + static_cast<std::ptrdiff_t>(payload_start), size.begin(), size.end());
+}
+
+StateStreamDecoder::StateStreamDecoder()
+    : has_header_(false),
+      has_state_(false),
+      failed_(false),
+      updates_decoded_(0)
+{
+}
+
+bool StateStreamDecoder::feed(const std::uint8_t *data, std::size_t size)
+{
+    if (failed_)
+        return false;
+    pending_.insert(pending_.end(), data, data + size);
+
+    const std::uint8_t *cursor = pending_.data();
+    const std::uint8_t *end = cursor + pending_.size();
+    if (!has_header_)
+    {
+        const std::size_t magic_size = sizeof(StateStreamFormat::MAGIC);
+        if (pending_.size() < magic_size)
+            return true;
+        if (std::memcmp(cursor, StateStreamFormat::MAGIC, magic_size) != 0)
+        {
+            failed_ = true;
+            return false;
+        }
+        has_header_ = true;
+        cursor += magic_size;
+    }
+    while (cursor < end)
+    {
+        const std::uint8_t *update = cursor + 1;
+        std::uint64_t payload_size = 0;
+        if (!Varint::read_unsigned(update, end, payload_size))
+        {
+            failed_ = end - cursor > 11; // Longer than any size varint: corrupt, not truncated
+            break;
+        }
+        if (payload_size > MAX_PAYLOAD_BYTES)
+        {
+            failed_ = true;
+            break;
+        }
+        if (static_cast<std::uint64_t>(end - update) < payload_size)
+            break; // Rest of the update still in flight
+        if (!decode_update(*cursor, update, update + payload_size))
+        {
+            failed_ = true;
+            break;
+        }
+        cursor = update + payload_size;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + (cursor - pending_.data()));
+    return !failed_;
+}
+
+bool StateStreamDecoder::decode_update(std::uint8_t type, const std::uint8_t *cursor, const std::uint8_t *end)
+{
+    if (type != StateStreamFormat::UPDATE_KEY && (type != StateStreamFormat::UPDATE_DELTA || !has_state_))
+        return false;
+    const bool key = type == StateStreamFormat::UPDATE_KEY;
+    std::uint64_t tick = 0, vehicle_count = 0;
+    if (!Varint::read_unsigned(cursor, end, tick) || !Varint::read_unsigned(cursor, end, vehicle_count) ||
+        !decode_section(cursor, end, key, state_.vehicles, changes_.vehicles, removed_, merged_.vehicles) ||
+        !decode_section(cursor, end, key, state_.signals, changes_.signals, removed_, merged_.signals) ||
+        !decode_section(cursor, end, key, state_.queues, changes_.queues, removed_, merged_.queues) ||
+        cursor != end)
+        return false;
+
+    state_.tick = static_cast<int>(tick);
+    state_.vehicle_count = static_cast<std::size_t>(vehicle_count);
+    state_.vehicles.swap(merged_.vehicles);
+    state_.signals.swap(merged_.signals);
+    state_.queues.swap(merged_.queues);
+    has_state_ = true;
+    ++updates_decoded_;
+    return true;
+}
+
+void StateStreamDecoder::reset()
+{
+    pending_.clear();
+    has_header_ = false;
+    has_state_ = false;
+    failed_ = false;
+    updates_decoded_ = 0;
+    state_ = StateSnapshot();
+}
+
+const StateSnapshot &StateStreamDecoder::get_state() const
+{
+    return state_;
+}
+
+long StateStreamDecoder::get_updates_decoded() const
+{
+    return updates_decoded_;
+}
+
+bool StateStreamDecoder::has_state() const
+{
+    return has_state_;
+}
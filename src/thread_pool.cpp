@@ -0,0 +1,161 @@
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+ThreadPool::ThreadPool(std::size_t num_threads)
+    : stopping_(false),
+      batch_body_(nullptr),
+      batch_count_(0),
+      batch_next_index_(0),
+      batch_active_workers_(0),
+      batch_generation_(0)
+{
+    if (num_threads == 0)
+    {
+        num_threads = default_thread_count();
+    }
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (std::thread &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::size() const
+{
+    return workers_.size();
+}
+
+std::size_t ThreadPool::default_thread_count()
+{
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)> &body)
+{
+    if (count == 0)
+        return;
+
+    if (workers_.empty() || count == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    TRACE_SCOPE_ARG("parallel_for", "jobs", count);
+    // Only one batch is in flight at a time; concurrent callers queue up here.
+    std::lock_guard<std::mutex> serial(batch_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_body_ = &body;
+        batch_count_ = count;
+        batch_next_index_.store(0);
+        batch_error_ = nullptr;
+        ++batch_generation_;
+    }
+    work_available_.notify_all();
+
+    // The calling thread works on the batch too, so a busy pool cannot stall it.
+    run_batch_indices();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        batch_done_.wait(lock, [this]()
+                         { return batch_active_workers_ == 0; });
+        batch_body_ = nullptr;
+        error = batch_error_;
+        batch_error_ = nullptr;
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::run_batch_indices()
+{
+    while (true)
+    {
+        std::size_t index = batch_next_index_.fetch_add(1);
+        if (index >= batch_count_)
+            break;
+        try
+        {
+            TRACE_SCOPE_ARG("pool job", "index", index);
+            (*batch_body_)(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!batch_error_)
+            {
+                batch_error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::worker_loop()
+{
+    TRACE_THREAD_NAME("pool worker");
+    unsigned long seen_generation = 0;
+    while (true)
+    {
+        std::function<void()> task;
+        bool join_batch = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [&]()
+                                 { return stopping_ || !tasks_.empty() ||
+                                          (batch_body_ != nullptr && batch_generation_ != seen_generation); });
+
+            if (batch_body_ != nullptr && batch_generation_ != seen_generation)
+            {
+                seen_generation = batch_generation_;
+                ++batch_active_workers_;
+                join_batch = true;
+            }
+            else if (!tasks_.empty())
+            {
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            else
+            {
+                return; // stopping_ and nothing left to do
+            }
+        }
+
+        if (join_batch)
+        {
+            run_batch_indices();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--batch_active_workers_ == 0)
+            {
+                batch_done_.notify_all();
+            }
+        }
+        else
+        {
+            TRACE_SCOPE("pool task");
+            task();
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "timing_plan.hpp"
+
+#include <fstream>
+#include <iostream> // For error reporting
+#include <sstream>
+
+int SignalTimingPlan::cycle_length() const
+{
+    int total = 0;
+    for (const auto &pair : green_durations)
+    {
+        total += pair.second + yellow_duration;
+    }
+    return total;
+}
+
+bool save_timing_plans(const std::string &filepath, const std::map<int, SignalTimingPlan> &plans)
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not open timing plan file for writing: " << filepath << std::endl;
+        return false;
+    }
+
+    file << "# Signal timing plans\n";
+    file << "# P <intersection_id> <offset> <yellow_duration>\n";
+    file << "# G <approach_id> <green_duration>\n";
+    for (const auto &pair : plans)
+    {
+        const SignalTimingPlan &plan = pair.second;
+        file << "P " << pair.first << " " << plan.offset << " " << plan.yellow_duration << "\n";
+        for (const auto &green : plan.green_durations)
+        {
+            file << "G " << green.first << " " << green.second << "\n";
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool load_timing_plans(const std::string &filepath, std::map<int, SignalTimingPlan> &out_plans)
+{
+    std::ifstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not open timing plan file: " << filepath << std::endl;
+        return false;
+    }
+
+    std::map<int, SignalTimingPlan> plans;
+    SignalTimingPlan *current_plan = nullptr;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        std::istringstream line_stream(line);
+        std::string tag;
+        if (!(line_stream >> tag) || tag[0] == '#')
+            continue;
+
+        bool ok = false;
+        if (tag == "P")
+        {
+            SignalTimingPlan plan;
+            if (line_stream >> plan.intersection_id >> plan.offset >> plan.yellow_duration)
+            {
+                current_plan = &plans[plan.intersection_id];
+                *current_plan = plan;
+                ok = true;
+            }
+        }
+        else if (tag == "G" && current_plan)
+        {
+            int approach_id = 0;
+            int green = 0;
+            if (line_stream >> approach_id >> green && green > 0)
+            {
+                current_plan->green_durations[approach_id] = green;
+                ok = true;
+            }
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Error: Malformed timing plan line " << line_number << " in " << filepath << std::endl;
+            return false;
+        }
+    }
+
+    out_plans = std::move(plans);
+    return true;
+}
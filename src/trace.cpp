@@ -0,0 +1,227 @@
+#include "trace.hpp"
+
+#include <atomic>
+#include <cstdio>  // For std::snprintf
+#include <cstdlib> // For std::atexit
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char *name;
+        const char *arg_name;
+        std::int64_t arg_value;
+        std::uint64_t start_ns;
+        std::uint64_t end_ns;
+    };
+
+    const std::size_t CHUNK_EVENTS = 4096;
+
+    // Written only by the owning thread: events first, then the count (release), so a
+    // reader that loads the count (acquire) sees complete events
+    struct Chunk
+    {
+        Event events[CHUNK_EVENTS];
+        std::atomic<std::size_t> count{0};
+        std::atomic<Chunk *> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        int thread_id = 0;
+        std::atomic<const char *> name{nullptr};
+        Chunk *head = nullptr;            // Oldest chunk still kept; only touched under the registry mutex
+        std::atomic<Chunk *> tail{nullptr}; // Chunk being written
+        std::size_t session_begin = 0;    // Events of `head` recorded before start()
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<ThreadBuffer *> buffers; // Kept after their threads exit
+        std::atomic<bool> enabled{false};
+        std::string filepath;
+        std::uint64_t session_start_ns = 0;
+        bool exit_handler_registered = false;
+    };
+
+    // Never destroyed: threads and the exit handler may still use it during shutdown
+    Registry &registry()
+    {
+        static Registry *instance = new Registry();
+        return *instance;
+    }
+
+    thread_local ThreadBuffer *thread_buffer = nullptr;
+    thread_local const char *thread_name = nullptr;
+
+    ThreadBuffer *register_thread()
+    {
+        ThreadBuffer *buffer = new ThreadBuffer();
+        buffer->name.store(thread_name, std::memory_order_relaxed);
+        buffer->head = new Chunk();
+        buffer->tail.store(buffer->head, std::memory_order_release);
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffer->thread_id = static_cast<int>(reg.buffers.size()) + 1;
+        reg.buffers.push_back(buffer);
+        thread_buffer = buffer;
+        return buffer;
+    }
+
+    void append_escaped(std::string &out, const char *text)
+    {
+        for (; *text; ++text)
+        {
+            char c = *text;
+            if (c == '"' || c == '\\')
+                out.push_back('\\');
+            if (static_cast<unsigned char>(c) >= 0x20)
+                out.push_back(c);
+        }
+    }
+
+    void append_event(std::string &out, const Event &event, int thread_id, std::uint64_t origin_ns)
+    {
+        char numbers[96];
+        out += ",\n{\"name\":\"";
+        append_escaped(out, event.name);
+        std::snprintf(numbers, sizeof(numbers), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                      thread_id, (event.start_ns - origin_ns) / 1e3, (event.end_ns - event.start_ns) / 1e3);
+        out += numbers;
+        if (event.arg_name)
+        {
+            out += ",\"args\":{\"";
+            append_escaped(out, event.arg_name);
+            std::snprintf(numbers, sizeof(numbers), "\":%lld}", static_cast<long long>(event.arg_value));
+            out += numbers;
+        }
+        out += "}";
+    }
+
+    void stop_at_exit()
+    {
+        Tracing::stop();
+    }
+}
+
+namespace Tracing
+{
+    std::uint64_t now_ns()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    bool is_enabled()
+    {
+        return registry().enabled.load(std::memory_order_relaxed);
+    }
+
+    void set_thread_name(const char *name)
+    {
+        thread_name = name;
+        if (thread_buffer)
+            thread_buffer->name.store(name, std::memory_order_relaxed);
+    }
+
+    void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns, const char *arg_name,
+                std::int64_t arg_value)
+    {
+        ThreadBuffer *buffer = thread_buffer ? thread_buffer : register_thread();
+        Chunk *chunk = buffer->tail.load(std::memory_order_relaxed);
+        std::size_t count = chunk->count.load(std::memory_order_relaxed);
+        if (count == CHUNK_EVENTS)
+        {
+            Chunk *fresh = new Chunk();
+            chunk->next.store(fresh, std::memory_order_release);
+            buffer->tail.store(fresh, std::memory_order_release);
+            chunk = fresh;
+            count = 0;
+        }
+        chunk->events[count] = {name, arg_name, arg_value, start_ns, end_ns};
+        chunk->count.store(count + 1, std::memory_order_release);
+    }
+
+    bool start(const std::string &filepath)
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (reg.enabled.load(std::memory_order_relaxed))
+            return false;
+        // Drop what earlier sessions left behind. Owners only ever touch their tail
+        // chunk, so everything before it can be freed.
+        for (ThreadBuffer *buffer : reg.buffers)
+        {
+            Chunk *tail = buffer->tail.load(std::memory_order_acquire);
+            while (buffer->head != tail)
+            {
+                Chunk *next = buffer->head->next.load(std::memory_order_acquire);
+                delete buffer->head;
+                buffer->head = next;
+            }
+            buffer->session_begin = tail->count.load(std::memory_order_acquire);
+        }
+        reg.filepath = filepath;
+        reg.session_start_ns = now_ns();
+        if (!reg.exit_handler_registered)
+        {
+            std::atexit(stop_at_exit);
+            reg.exit_handler_registered = true;
+        }
+        reg.enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool stop()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (!reg.enabled.load(std::memory_order_relaxed))
+            return false;
+        reg.enabled.store(false, std::memory_order_release);
+
+        std::ofstream file(reg.filepath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"traffic_sim\"}}";
+        for (ThreadBuffer *buffer : reg.buffers)
+        {
+            const char *name = buffer->name.load(std::memory_order_relaxed);
+            if (name)
+            {
+                out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+                out += std::to_string(buffer->thread_id);
+                out += ",\"args\":{\"name\":\"";
+                append_escaped(out, name);
+                out += "\"}}";
+            }
+
+            std::size_t skip = buffer->session_begin;
+            for (Chunk *chunk = buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+            {
+                const std::size_t count = chunk->count.load(std::memory_order_acquire);
+                for (std::size_t i = skip; i < count; ++i)
+                {
+                    // Scopes opened before start() may end inside the session
+                    if (chunk->events[i].start_ns >= reg.session_start_ns)
+                        append_event(out, chunk->events[i], buffer->thread_id, reg.session_start_ns);
+                }
+                skip = 0;
+                if (out.size() >= (1u << 20))
+                {
+                    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+                    out.clear();
+                }
+            }
+        }
+        out += "\n]}\n";
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        return static_cast<bool>(file);
+    }
+}
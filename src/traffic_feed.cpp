@@ -0,0 +1,284 @@
+#include "traffic_feed.hpp"
+#include "utils.hpp"
+
+#include <algorithm> // For std::min
+#include <chrono>
+#include <cstring> // For std::memchr
+#include <fstream>
+
+// --- SlidingWindowAggregator ---
+
+SlidingWindowAggregator::SlidingWindowAggregator(std::size_t window_size)
+    : window_size_(window_size > 0 ? window_size : 1)
+{
+}
+
+const EdgeWindowStats &SlidingWindowAggregator::add(const TrafficDataPoint &point)
+{
+    EdgeWindow &window = windows_[point.edge_id];
+    Sample sample{point.density, point.average_speed, point.vehicles_passed};
+
+    if (window.samples.size() < window_size_)
+    {
+        window.samples.push_back(sample);
+    }
+    else
+    {
+        // Window full: replace the oldest sample and take it out of the running sums
+        Sample &oldest = window.samples[window.next_slot];
+        window.density_sum -= oldest.density;
+        window.speed_sum -= oldest.average_speed;
+        window.stats.vehicles_passed -= oldest.vehicles_passed;
+        oldest = sample;
+    }
+    window.next_slot = (window.next_slot + 1) % window_size_;
+
+    window.density_sum += sample.density;
+    window.speed_sum += sample.average_speed;
+    window.stats.vehicles_passed += sample.vehicles_passed;
+    if (window.next_slot == 0)
+    {
+        // Once per pass over the ring, recompute the sums from the samples so the rounding
+        // of the running += / -= cannot accumulate over an unbounded feed
+        window.density_sum = 0.0;
+        window.speed_sum = 0.0;
+        for (const Sample &kept : window.samples)
+        {
+            window.density_sum += kept.density;
+            window.speed_sum += kept.average_speed;
+        }
+    }
+    window.stats.count = window.samples.size();
+    window.stats.mean_density = window.density_sum / window.stats.count;
+    window.stats.mean_speed = window.speed_sum / window.stats.count;
+    window.stats.last_timestamp = point.timestamp;
+    return window.stats;
+}
+
+void SlidingWindowAggregator::clear()
+{
+    windows_.clear();
+}
+
+std::size_t SlidingWindowAggregator::get_window_size() const
+{
+    return window_size_;
+}
+
+bool SlidingWindowAggregator::get_stats(int edge_id, EdgeWindowStats &out_stats) const
+{
+    auto it = windows_.find(edge_id);
+    if (it == windows_.end())
+        return false;
+    out_stats = it->second.stats;
+    return true;
+}
+
+std::map<int, EdgeWindowStats> SlidingWindowAggregator::get_all_stats() const
+{
+    std::map<int, EdgeWindowStats> all_stats;
+    for (const auto &pair : windows_)
+    {
+        all_stats[pair.first] = pair.second.stats;
+    }
+    return all_stats;
+}
+
+// --- TrafficFeedFollower ---
+
+TrafficFeedFollower::TrafficFeedFollower(const std::string &filepath, std::size_t window_size,
+                                         bool start_at_end, char delimiter)
+    : filepath_(filepath),
+      delimiter_(delimiter),
+      skip_existing_(start_at_end),
+      offset_(0),
+      discarding_line_(false),
+      read_buffer_(READ_CHUNK_BYTES),
+      aggregator_(window_size),
+      rows_ingested_(0),
+      running_(false)
+{
+}
+
+TrafficFeedFollower::~TrafficFeedFollower()
+{
+    stop();
+}
+
+void TrafficFeedFollower::set_update_callback(UpdateCallback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_update_ = std::move(callback);
+}
+
+std::size_t TrafficFeedFollower::poll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ifstream file(filepath_, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    file.seekg(0, std::ios::end);
+    std::streamoff end = file.tellg();
+    if (end < 0)
+        return 0;
+    std::size_t file_size = static_cast<std::size_t>(end);
+
+    if (skip_existing_)
+    {
+        // If the file ends mid-row, skip the rest of that row when it arrives
+        skip_existing_ = false;
+        offset_ = file_size;
+        if (file_size > 0)
+        {
+            char last = '\n';
+            file.seekg(-1, std::ios::end);
+            file.get(last);
+            discarding_line_ = last != '\n';
+        }
+        return 0;
+    }
+    if (file_size < offset_)
+    {
+        // Truncated or replaced: start over on the new contents
+        offset_ = 0;
+        partial_line_.clear();
+        discarding_line_ = false;
+    }
+
+    std::size_t rows = 0;
+    while (offset_ < file_size)
+    {
+        std::size_t to_read = std::min(read_buffer_.size(), file_size - offset_);
+        file.seekg(static_cast<std::streamoff>(offset_));
+        file.read(read_buffer_.data(), static_cast<std::streamsize>(to_read));
+        std::size_t bytes_read = static_cast<std::size_t>(file.gcount());
+        if (bytes_read == 0)
+            break;
+        rows += ingest_bytes(read_buffer_.data(), bytes_read);
+        offset_ += bytes_read;
+    }
+    return rows;
+}
+
+std::size_t TrafficFeedFollower::ingest_bytes(const char *data, std::size_t size)
+{
+    std::size_t rows = 0;
+    std::size_t position = 0;
+    while (position < size)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(data + position, '\n', size - position));
+        if (!newline)
+        {
+            // Incomplete last line: keep it until the rest has been written
+            std::size_t length = size - position;
+            if (!discarding_line_)
+            {
+                if (partial_line_.size() + length > MAX_LINE_BYTES)
+                {
+                    partial_line_.clear();
+                    discarding_line_ = true;
+                }
+                else
+                {
+                    partial_line_.append(data + position, length);
+                }
+            }
+            break;
+        }
+
+        std::size_t length = static_cast<std::size_t>(newline - (data + position));
+        if (discarding_line_)
+        {
+            discarding_line_ = false;
+        }
+        else if (!partial_line_.empty())
+        {
+            partial_line_.append(data + position, length);
+            rows += ingest_line(partial_line_.data(), partial_line_.size()) ? 1 : 0;
+            partial_line_.clear();
+        }
+        else
+        {
+            rows += ingest_line(data + position, length) ? 1 : 0;
+        }
+        position += length + 1;
+    }
+    return rows;
+}
+
+bool TrafficFeedFollower::ingest_line(const char *data, std::size_t size)
+{
+    Utils::CsvCursor cursor(std::string_view(data, size), delimiter_);
+    Utils::CsvFields fields;
+    TrafficDataPoint point;
+    if (!cursor.next(fields) || !Utils::parse_traffic_row(fields, point))
+        return false; // Comment, header or malformed row
+
+    const EdgeWindowStats &stats = aggregator_.add(point);
+    rows_ingested_++;
+    if (on_update_)
+    {
+        on_update_(point, stats);
+    }
+    return true;
+}
+
+void TrafficFeedFollower::start(int poll_interval_ms)
+{
+    if (running_.exchange(true))
+        return;
+    worker_ = std::thread([this, poll_interval_ms]()
+                          {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        while (running_)
+        {
+            lock.unlock();
+            poll();
+            lock.lock();
+            stop_requested_.wait_for(lock, std::chrono::milliseconds(poll_interval_ms),
+                                     [this]() { return !running_; });
+        } });
+}
+
+void TrafficFeedFollower::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        running_ = false;
+    }
+    stop_requested_.notify_all();
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+bool TrafficFeedFollower::is_running() const
+{
+    return running_;
+}
+
+bool TrafficFeedFollower::get_stats(int edge_id, EdgeWindowStats &out_stats) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aggregator_.get_stats(edge_id, out_stats);
+}
+
+std::map<int, EdgeWindowStats> TrafficFeedFollower::get_all_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aggregator_.get_all_stats();
+}
+
+std::size_t TrafficFeedFollower::get_rows_ingested() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rows_ingested_;
+}
+
+std::size_t TrafficFeedFollower::get_offset() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return offset_;
+}
@@ -0,0 +1,270 @@
+#include "traffic_store.hpp"
+#include "varint.hpp"
+
+#include <algorithm> // For std::stable_sort, std::nth_element, std::min, std::max
+#include <cmath>     // For std::ceil
+#include <limits>
+
+TrafficHistoryStore::TrafficHistoryStore() : row_count_(0)
+{
+}
+
+void TrafficHistoryStore::append(const TrafficDataPoint &point)
+{
+    EdgeSeries &series = series_[point.edge_id];
+    if (series.row_count > 0 && point.timestamp < series.last_timestamp)
+    {
+        series.in_time_order = false;
+    }
+    series.last_timestamp = point.timestamp;
+
+    if (series.blocks.empty() || series.blocks.back().row_count >= BLOCK_SIZE)
+    {
+        Block block;
+        block.min_timestamp = point.timestamp;
+        block.max_timestamp = point.timestamp;
+        block.last_timestamp = 0; // First delta is the absolute timestamp
+        block.row_count = 0;
+        series.blocks.push_back(std::move(block));
+    }
+
+    Block &block = series.blocks.back();
+    Varint::append_signed(block.timestamps, static_cast<std::int64_t>(point.timestamp) - block.last_timestamp);
+    Varint::append_signed(block.vehicles_passed, point.vehicles_passed);
+    block.density.push_back(point.density);
+    block.average_speed.push_back(point.average_speed);
+    block.last_timestamp = point.timestamp;
+    block.min_timestamp = std::min(block.min_timestamp, point.timestamp);
+    block.max_timestamp = std::max(block.max_timestamp, point.timestamp);
+    block.row_count++;
+
+    series.row_count++;
+    row_count_++;
+}
+
+void TrafficHistoryStore::clear()
+{
+    series_.clear();
+    row_count_ = 0;
+}
+
+std::size_t TrafficHistoryStore::size() const
+{
+    return row_count_;
+}
+
+std::vector<int> TrafficHistoryStore::get_edge_ids() const
+{
+    std::vector<int> ids;
+    ids.reserve(series_.size());
+    for (const auto &pair : series_)
+    {
+        ids.push_back(pair.first);
+    }
+    return ids;
+}
+
+std::size_t TrafficHistoryStore::get_row_count(int edge_id) const
+{
+    auto it = series_.find(edge_id);
+    return it != series_.end() ? it->second.row_count : 0;
+}
+
+std::size_t TrafficHistoryStore::memory_bytes() const
+{
+    std::size_t total = 0;
+    for (const auto &pair : series_)
+    {
+        for (const Block &block : pair.second.blocks)
+        {
+            total += sizeof(Block) + block.timestamps.capacity() + block.vehicles_passed.capacity() +
+                     (block.density.capacity() + block.average_speed.capacity()) * sizeof(double);
+        }
+    }
+    return total;
+}
+
+void TrafficHistoryStore::decode_block(int edge_id, const Block &block, std::vector<TrafficDataPoint> &out)
+{
+    const std::uint8_t *ts_cursor = block.timestamps.data();
+    const std::uint8_t *ts_end = ts_cursor + block.timestamps.size();
+    const std::uint8_t *count_cursor = block.vehicles_passed.data();
+    const std::uint8_t *count_end = count_cursor + block.vehicles_passed.size();
+
+    std::int64_t timestamp = 0;
+    for (std::size_t i = 0; i < block.row_count; ++i)
+    {
+        std::int64_t delta = 0;
+        std::int64_t vehicles = 0;
+        if (!Varint::read_signed(ts_cursor, ts_end, delta) || !Varint::read_signed(count_cursor, count_end, vehicles))
+            break;
+        timestamp += delta;
+
+        TrafficDataPoint point;
+        point.timestamp = static_cast<int>(timestamp);
+        point.edge_id = edge_id;
+        point.density = block.density[i];
+        point.average_speed = block.average_speed[i];
+        point.vehicles_passed = static_cast<int>(vehicles);
+        out.push_back(point);
+    }
+}
+
+void TrafficHistoryStore::for_each_in_range(int edge_id, int from_timestamp, int to_timestamp,
+                                            const std::function<void(const TrafficDataPoint &)> &callback) const
+{
+    auto it = series_.find(edge_id);
+    if (it == series_.end() || from_timestamp > to_timestamp)
+        return;
+    const EdgeSeries &series = it->second;
+
+    std::vector<TrafficDataPoint> decoded;
+    std::vector<TrafficDataPoint> unordered_matches;
+    for (const Block &block : series.blocks)
+    {
+        if (block.max_timestamp < from_timestamp || block.min_timestamp > to_timestamp)
+            continue; // Block lies entirely outside the range
+
+        decoded.clear();
+        decode_block(edge_id, block, decoded);
+        for (const TrafficDataPoint &point : decoded)
+        {
+            if (point.timestamp < from_timestamp || point.timestamp > to_timestamp)
+                continue;
+            if (series.in_time_order)
+                callback(point);
+            else
+                unordered_matches.push_back(point);
+        }
+    }
+
+    if (!series.in_time_order)
+    {
+        std::stable_sort(unordered_matches.begin(), unordered_matches.end(),
+                         [](const TrafficDataPoint &a, const TrafficDataPoint &b)
+                         { return a.timestamp < b.timestamp; });
+        for (const TrafficDataPoint &point : unordered_matches)
+        {
+            callback(point);
+        }
+    }
+}
+
+std::vector<TrafficDataPoint> TrafficHistoryStore::query_range(int edge_id, int from_timestamp, int to_timestamp) const
+{
+    std::vector<TrafficDataPoint> rows;
+    for_each_in_range(edge_id, from_timestamp, to_timestamp, [&rows](const TrafficDataPoint &point)
+                      { rows.push_back(point); });
+    return rows;
+}
+
+void TrafficHistoryStore::for_each(const std::function<void(const TrafficDataPoint &)> &callback) const
+{
+    std::vector<TrafficDataPoint> decoded;
+    for (const auto &pair : series_)
+    {
+        for (const Block &block : pair.second.blocks)
+        {
+            decoded.clear();
+            decode_block(pair.first, block, decoded);
+            for (const TrafficDataPoint &point : decoded)
+            {
+                callback(point);
+            }
+        }
+    }
+}
+
+double TrafficHistoryStore::metric_value(const TrafficDataPoint &point, TrafficMetric metric)
+{
+    switch (metric)
+    {
+    case TrafficMetric::DENSITY:
+        return point.density;
+    case TrafficMetric::AVERAGE_SPEED:
+        return point.average_speed;
+    case TrafficMetric::VEHICLES_PASSED:
+        return static_cast<double>(point.vehicles_passed);
+    }
+    return 0.0;
+}
+
+std::vector<TrafficSeriesPoint> TrafficHistoryStore::rolling_mean(int edge_id, TrafficMetric metric, int window,
+                                                                  int from_timestamp, int to_timestamp) const
+{
+    std::vector<TrafficSeriesPoint> result;
+    if (window < 1)
+        return result;
+
+    // Rows just before the range still contribute to the first windows.
+    long long lookback_start = static_cast<long long>(from_timestamp) - window + 1;
+    int query_start = static_cast<int>(std::max<long long>(lookback_start, std::numeric_limits<int>::min()));
+    std::vector<TrafficDataPoint> rows = query_range(edge_id, query_start, to_timestamp);
+
+    double window_sum = 0.0;
+    std::size_t window_begin = 0;
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        window_sum += metric_value(rows[i], metric);
+        while (static_cast<long long>(rows[window_begin].timestamp) <= static_cast<long long>(rows[i].timestamp) - window)
+        {
+            window_sum -= metric_value(rows[window_begin], metric);
+            window_begin++;
+        }
+        if (rows[i].timestamp >= from_timestamp)
+        {
+            result.push_back({rows[i].timestamp, window_sum / static_cast<double>(i - window_begin + 1)});
+        }
+    }
+    return result;
+}
+
+bool TrafficHistoryStore::percentile(int edge_id, TrafficMetric metric, double percent,
+                                     int from_timestamp, int to_timestamp, double &out_value) const
+{
+    std::vector<double> values;
+    for_each_in_range(edge_id, from_timestamp, to_timestamp, [&](const TrafficDataPoint &point)
+                      { values.push_back(metric_value(point, metric)); });
+    if (values.empty())
+        return false;
+
+    percent = std::max(0.0, std::min(100.0, percent));
+    std::size_t rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * values.size()));
+    std::size_t index = rank > 0 ? rank - 1 : 0;
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    out_value = values[index];
+    return true;
+}
+
+std::vector<TrafficBucket> TrafficHistoryStore::downsample(int edge_id, int bucket_width,
+                                                           int from_timestamp, int to_timestamp) const
+{
+    std::vector<TrafficBucket> buckets;
+    if (bucket_width < 1)
+        return buckets;
+
+    for_each_in_range(edge_id, from_timestamp, to_timestamp, [&](const TrafficDataPoint &point)
+                      {
+        // Floor division so negative timestamps land in the right bucket
+        long long start = point.timestamp / bucket_width;
+        if (point.timestamp % bucket_width < 0)
+            start--;
+        start *= bucket_width;
+
+        if (buckets.empty() || buckets.back().start_timestamp != start)
+        {
+            buckets.push_back({static_cast<int>(start), 0, 0.0, 0.0, 0});
+        }
+        TrafficBucket &bucket = buckets.back();
+        bucket.sample_count++;
+        bucket.mean_density += point.density;
+        bucket.mean_speed += point.average_speed;
+        bucket.vehicles_passed += point.vehicles_passed; });
+
+    for (TrafficBucket &bucket : buckets)
+    {
+        bucket.mean_density /= bucket.sample_count;
+        bucket.mean_speed /= bucket.sample_count;
+    }
+    return buckets;
+}
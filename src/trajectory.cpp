@@ -0,0 +1,303 @@
+#include "trajectory.hpp"
+#include "varint.hpp"
+
+#include <algorithm> // For std::max
+
+void TrajectoryFrame::clear()
+{
+    tick = 0;
+    vehicle_ids.clear();
+    vehicle_states.clear();
+    current_nodes.clear();
+    next_nodes.clear();
+    progress_ticks.clear();
+    total_ticks.clear();
+    destinations.clear();
+    clear_intersections();
+}
+
+void TrajectoryFrame::clear_intersections()
+{
+    intersection_ids.clear();
+    green_indices.clear();
+    phases.clear();
+    ticks_in_state.clear();
+    approach_counts.clear();
+    approach_ids.clear();
+    queue_lengths.clear();
+    queued_vehicle_ids.clear();
+}
+
+void match_vehicle_references(const std::vector<int> &previous_ids, const std::vector<int> &ids,
+                              std::vector<int> &reference)
+{
+    reference.assign(ids.size(), -1);
+    std::size_t p = 0;
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        while (p < previous_ids.size() && previous_ids[p] < ids[i])
+            p++;
+        if (p < previous_ids.size() && previous_ids[p] == ids[i])
+            reference[i] = static_cast<int>(p);
+    }
+}
+
+namespace
+{
+    void append_plain_column(std::vector<std::uint8_t> &out, const std::vector<int> &column)
+    {
+        for (int value : column)
+        {
+            Varint::append_signed(out, value);
+        }
+    }
+
+    // Ids are sorted, so consecutive differences are small and non-negative
+    void append_id_column(std::vector<std::uint8_t> &out, const std::vector<int> &ids)
+    {
+        std::int64_t previous = 0;
+        for (int id : ids)
+        {
+            Varint::append_signed(out, static_cast<std::int64_t>(id) - previous);
+            previous = id;
+        }
+    }
+
+    void append_delta_column(std::vector<std::uint8_t> &out, const std::vector<int> &column,
+                             const std::vector<int> &previous_column, const std::vector<int> &reference)
+    {
+        for (std::size_t i = 0; i < column.size(); ++i)
+        {
+            std::int64_t base = reference[i] >= 0 ? previous_column[reference[i]] : 0;
+            Varint::append_signed(out, static_cast<std::int64_t>(column[i]) - base);
+        }
+    }
+
+    bool read_int(const std::uint8_t *&cursor, const std::uint8_t *end, int &out_value)
+    {
+        std::int64_t value = 0;
+        if (!Varint::read_signed(cursor, end, value))
+            return false;
+        out_value = static_cast<int>(value);
+        return true;
+    }
+
+    bool read_count(const std::uint8_t *&cursor, const std::uint8_t *end, std::size_t &out_count)
+    {
+        std::uint64_t value = 0;
+        // Every counted element takes at least one byte, which bounds bogus counts
+        if (!Varint::read_unsigned(cursor, end, value) || value > static_cast<std::uint64_t>(end - cursor))
+            return false;
+        out_count = static_cast<std::size_t>(value);
+        return true;
+    }
+
+    bool read_plain_column(const std::uint8_t *&cursor, const std::uint8_t *end, std::size_t count,
+                           std::vector<int> &column)
+    {
+        column.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!read_int(cursor, end, column[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool read_byte_column(const std::uint8_t *&cursor, const std::uint8_t *end, std::size_t count,
+                          std::vector<std::uint8_t> &column)
+    {
+        if (static_cast<std::size_t>(end - cursor) < count)
+            return false;
+        column.assign(cursor, cursor + count);
+        cursor += count;
+        return true;
+    }
+
+    bool read_id_column(const std::uint8_t *&cursor, const std::uint8_t *end, std::size_t count,
+                        std::vector<int> &ids)
+    {
+        ids.resize(count);
+        int previous = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int delta = 0;
+            if (!read_int(cursor, end, delta))
+                return false;
+            previous += delta;
+            ids[i] = previous;
+        }
+        return true;
+    }
+
+    bool read_delta_column(const std::uint8_t *&cursor, const std::uint8_t *end, std::size_t count,
+                           const std::vector<int> &previous_column, const std::vector<int> &reference,
+                           std::vector<int> &column)
+    {
+        column.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int delta = 0;
+            if (!read_int(cursor, end, delta))
+                return false;
+            column[i] = delta + (reference[i] >= 0 ? previous_column[reference[i]] : 0);
+        }
+        return true;
+    }
+}
+
+// --- TrajectoryEncoder ---
+
+TrajectoryEncoder::TrajectoryEncoder(int keyframe_interval)
+    : keyframe_interval_(std::max(1, keyframe_interval)),
+      frames_since_key_(0),
+      has_previous_(false)
+{
+}
+
+bool TrajectoryEncoder::encode(const TrajectoryFrame &frame, std::vector<std::uint8_t> &out)
+{
+    const bool key = !has_previous_ || frames_since_key_ >= keyframe_interval_;
+    payload_.clear();
+
+    Varint::append_signed(payload_, key ? frame.tick : static_cast<std::int64_t>(frame.tick) - previous_.tick);
+
+    // Vehicle columns
+    Varint::append_unsigned(payload_, frame.vehicle_ids.size());
+    append_id_column(payload_, frame.vehicle_ids);
+    payload_.insert(payload_.end(), frame.vehicle_states.begin(), frame.vehicle_states.end());
+    if (key)
+    {
+        append_plain_column(payload_, frame.current_nodes);
+        append_plain_column(payload_, frame.next_nodes);
+        append_plain_column(payload_, frame.progress_ticks);
+        append_plain_column(payload_, frame.total_ticks);
+        append_plain_column(payload_, frame.destinations);
+    }
+    else
+    {
+        match_vehicle_references(previous_.vehicle_ids, frame.vehicle_ids, reference_index_);
+        append_delta_column(payload_, frame.current_nodes, previous_.current_nodes, reference_index_);
+        append_delta_column(payload_, frame.next_nodes, previous_.next_nodes, reference_index_);
+        append_delta_column(payload_, frame.progress_ticks, previous_.progress_ticks, reference_index_);
+        append_delta_column(payload_, frame.total_ticks, previous_.total_ticks, reference_index_);
+        append_delta_column(payload_, frame.destinations, previous_.destinations, reference_index_);
+    }
+
+    // Intersection columns
+    Varint::append_unsigned(payload_, frame.intersection_ids.size());
+    append_id_column(payload_, frame.intersection_ids);
+    append_plain_column(payload_, frame.green_indices);
+    payload_.insert(payload_.end(), frame.phases.begin(), frame.phases.end());
+    append_plain_column(payload_, frame.ticks_in_state);
+    append_plain_column(payload_, frame.approach_counts);
+    Varint::append_unsigned(payload_, frame.approach_ids.size());
+    append_plain_column(payload_, frame.approach_ids);
+    append_plain_column(payload_, frame.queue_lengths);
+    Varint::append_unsigned(payload_, frame.queued_vehicle_ids.size());
+    append_plain_column(payload_, frame.queued_vehicle_ids);
+
+    out.push_back(key ? TrajectoryFormat::FRAME_KEY : TrajectoryFormat::FRAME_DELTA);
+    Varint::append_unsigned(out, payload_.size());
+    out.insert(out.end(), payload_.begin(), payload_.end());
+
+    frames_since_key_ = key ? 1 : frames_since_key_ + 1;
+    previous_ = frame; // Reuses previous_'s capacity
+    has_previous_ = true;
+    return key;
+}
+
+void TrajectoryEncoder::reset()
+{
+    has_previous_ = false;
+    frames_since_key_ = 0;
+}
+
+int TrajectoryEncoder::get_keyframe_interval() const
+{
+    return keyframe_interval_;
+}
+
+// --- TrajectoryDecoder ---
+
+TrajectoryDecoder::TrajectoryDecoder() : has_previous_(false)
+{
+}
+
+void TrajectoryDecoder::reset()
+{
+    has_previous_ = false;
+}
+
+bool TrajectoryDecoder::decode(const std::uint8_t *&cursor, const std::uint8_t *end, TrajectoryFrame &out,
+                               std::uint8_t &frame_type)
+{
+    const std::uint8_t *position = cursor;
+    std::uint64_t payload_size = 0;
+    if (position >= end)
+        return false;
+    frame_type = *position++;
+    if (!Varint::read_unsigned(position, end, payload_size) ||
+        payload_size > static_cast<std::uint64_t>(end - position))
+        return false;
+    const std::uint8_t *payload_end = position + payload_size;
+
+    if (frame_type == TrajectoryFormat::FRAME_INDEX)
+    {
+        cursor = payload_end;
+        return true;
+    }
+    const bool key = frame_type == TrajectoryFormat::FRAME_KEY;
+    if (!key && (frame_type != TrajectoryFormat::FRAME_DELTA || !has_previous_))
+        return false;
+
+    int tick = 0;
+    std::size_t vehicle_count = 0;
+    if (!read_int(position, payload_end, tick) || !read_count(position, payload_end, vehicle_count))
+        return false;
+    out.tick = key ? tick : previous_.tick + tick;
+
+    if (!read_id_column(position, payload_end, vehicle_count, out.vehicle_ids) ||
+        !read_byte_column(position, payload_end, vehicle_count, out.vehicle_states))
+        return false;
+    bool ok;
+    if (key)
+    {
+        ok = read_plain_column(position, payload_end, vehicle_count, out.current_nodes) &&
+             read_plain_column(position, payload_end, vehicle_count, out.next_nodes) &&
+             read_plain_column(position, payload_end, vehicle_count, out.progress_ticks) &&
+             read_plain_column(position, payload_end, vehicle_count, out.total_ticks) &&
+             read_plain_column(position, payload_end, vehicle_count, out.destinations);
+    }
+    else
+    {
+        match_vehicle_references(previous_.vehicle_ids, out.vehicle_ids, reference_index_);
+        ok = read_delta_column(position, payload_end, vehicle_count, previous_.current_nodes, reference_index_, out.current_nodes) &&
+             read_delta_column(position, payload_end, vehicle_count, previous_.next_nodes, reference_index_, out.next_nodes) &&
+             read_delta_column(position, payload_end, vehicle_count, previous_.progress_ticks, reference_index_, out.progress_ticks) &&
+             read_delta_column(position, payload_end, vehicle_count, previous_.total_ticks, reference_index_, out.total_ticks) &&
+             read_delta_column(position, payload_end, vehicle_count, previous_.destinations, reference_index_, out.destinations);
+    }
+    if (!ok)
+        return false;
+
+    std::size_t intersection_count = 0, approach_count = 0, queued_count = 0;
+    ok = read_count(position, payload_end, intersection_count) &&
+         read_id_column(position, payload_end, intersection_count, out.intersection_ids) &&
+         read_plain_column(position, payload_end, intersection_count, out.green_indices) &&
+         read_byte_column(position, payload_end, intersection_count, out.phases) &&
+         read_plain_column(position, payload_end, intersection_count, out.ticks_in_state) &&
+         read_plain_column(position, payload_end, intersection_count, out.approach_counts) &&
+         read_count(position, payload_end, approach_count) &&
+         read_plain_column(position, payload_end, approach_count, out.approach_ids) &&
+         read_plain_column(position, payload_end, approach_count, out.queue_lengths) &&
+         read_count(position, payload_end, queued_count) &&
+         read_plain_column(position, payload_end, queued_count, out.queued_vehicle_ids);
+    if (!ok || position != payload_end)
+        return false;
+
+    cursor = payload_end;
+    previous_ = out;
+    has_previous_ = true;
+    return true;
+}
@@ -0,0 +1,177 @@
+#include "trajectory_recorder.hpp"
+#include "varint.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+
+TrajectoryRecorder::TrajectoryRecorder()
+    : is_open_(false),
+      head_(0),
+      tail_(0),
+      stopping_(false),
+      frames_written_(0),
+      frames_dropped_(0),
+      bytes_written_(0),
+      write_error_(false)
+{
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    close();
+}
+
+bool TrajectoryRecorder::open(const std::string &filepath, int keyframe_interval, std::size_t ring_capacity)
+{
+    close();
+    file_.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+        return false;
+
+    slots_.assign(ring_capacity > 0 ? ring_capacity : 1, TrajectoryFrame());
+    head_ = 0;
+    tail_ = 0;
+    stopping_ = false;
+    frames_written_ = 0;
+    frames_dropped_ = 0;
+    bytes_written_ = 0;
+    write_error_ = false;
+    encoder_ = TrajectoryEncoder(keyframe_interval);
+    keyframe_index_.clear();
+
+    output_.clear();
+    output_.insert(output_.end(), TrajectoryFormat::MAGIC, TrajectoryFormat::MAGIC + sizeof(TrajectoryFormat::MAGIC));
+    Varint::append_unsigned(output_, static_cast<std::uint64_t>(encoder_.get_keyframe_interval()));
+
+    is_open_ = true;
+    writer_ = std::thread(&TrajectoryRecorder::writer_loop, this);
+    return true;
+}
+
+bool TrajectoryRecorder::record(const Simulation &simulation)
+{
+    if (!is_open_)
+        return false;
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= slots_.size())
+    {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    TrajectoryFrame &slot = slots_[head % slots_.size()];
+    const TrajectoryFrame *tick_frame = simulation.get_tick_frame();
+    if (tick_frame && tick_frame->tick == simulation.get_current_tick())
+        slot = *tick_frame; // Column copies into the slot's existing capacity
+    else
+        simulation.capture_frame(slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void TrajectoryRecorder::writer_loop()
+{
+    TRACE_THREAD_NAME("trajectory writer");
+    while (true)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+        {
+            if (stopping_.load(std::memory_order_acquire))
+            {
+                // record() is no longer called once stopping_ is set; drain what it published
+                if (tail == head_.load(std::memory_order_acquire))
+                    break;
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        TRACE_SCOPE("write frame");
+        const TrajectoryFrame &frame = slots_[tail % slots_.size()];
+        std::uint64_t frame_offset = bytes_written_.load(std::memory_order_relaxed) + output_.size();
+        if (encoder_.encode(frame, output_))
+        {
+            keyframe_index_.push_back({frame.tick, frame_offset});
+        }
+        tail_.store(tail + 1, std::memory_order_release);
+        frames_written_.fetch_add(1, std::memory_order_relaxed);
+
+        if (output_.size() >= WRITE_BUFFER_BYTES)
+            flush_output();
+    }
+
+    // Index of key frames followed by the fixed-size trailer pointing at it
+    std::uint64_t index_offset = bytes_written_.load(std::memory_order_relaxed) + output_.size();
+    std::vector<std::uint8_t> payload;
+    Varint::append_unsigned(payload, keyframe_index_.size());
+    std::int64_t previous_tick = 0;
+    std::uint64_t previous_offset = 0;
+    for (const auto &entry : keyframe_index_)
+    {
+        Varint::append_signed(payload, static_cast<std::int64_t>(entry.first) - previous_tick);
+        Varint::append_unsigned(payload, entry.second - previous_offset);
+        previous_tick = entry.first;
+        previous_offset = entry.second;
+    }
+    output_.push_back(TrajectoryFormat::FRAME_INDEX);
+    Varint::append_unsigned(output_, payload.size());
+    output_.insert(output_.end(), payload.begin(), payload.end());
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        output_.push_back(static_cast<std::uint8_t>(index_offset >> (8 * byte)));
+    }
+    output_.insert(output_.end(), TrajectoryFormat::TRAILER_MAGIC,
+                   TrajectoryFormat::TRAILER_MAGIC + sizeof(TrajectoryFormat::TRAILER_MAGIC));
+    flush_output();
+}
+
+void TrajectoryRecorder::flush_output()
+{
+    if (output_.empty())
+        return;
+    TRACE_SCOPE_ARG("recorder flush", "bytes", output_.size());
+    file_.write(reinterpret_cast<const char *>(output_.data()), static_cast<std::streamsize>(output_.size()));
+    if (!file_)
+        write_error_ = true;
+    bytes_written_.fetch_add(output_.size(), std::memory_order_relaxed);
+    output_.clear();
+}
+
+void TrajectoryRecorder::close()
+{
+    if (!is_open_)
+        return;
+    stopping_.store(true, std::memory_order_release);
+    if (writer_.joinable())
+        writer_.join();
+    file_.close();
+    if (file_.fail())
+        write_error_ = true;
+    is_open_ = false;
+}
+
+bool TrajectoryRecorder::is_open() const
+{
+    return is_open_;
+}
+
+bool TrajectoryRecorder::has_write_error() const
+{
+    return write_error_;
+}
+
+std::size_t TrajectoryRecorder::get_frames_written() const
+{
+    return frames_written_;
+}
+
+std::size_t TrajectoryRecorder::get_frames_dropped() const
+{
+    return frames_dropped_;
+}
+
+std::size_t TrajectoryRecorder::get_bytes_written() const
+{
+    return static_cast<std::size_t>(bytes_written_);
+}
@@ -0,0 +1,357 @@
+#include "trajectory_replay.hpp"
+#include "varint.hpp"
+
+#include <algorithm> // For std::upper_bound
+#include <cstring>   // For std::memcmp
+#include <utility>   // For std::swap
+
+TrajectoryReplay::TrajectoryReplay()
+    : begin_(nullptr),
+      frames_begin_(nullptr),
+      end_(nullptr),
+      keyframe_interval_(0),
+      has_stored_index_(false),
+      last_tick_(0),
+      cursor_(nullptr),
+      has_lookahead_(false),
+      has_frame_(false),
+      vehicles_valid_(false),
+      intersections_valid_(false)
+{
+}
+
+bool TrajectoryReplay::open(const std::string &filepath)
+{
+    close();
+    if (!file_.open(filepath))
+        return false;
+
+    begin_ = reinterpret_cast<const std::uint8_t *>(file_.data().data());
+    end_ = begin_ + file_.size();
+    const std::size_t magic_size = sizeof(TrajectoryFormat::MAGIC);
+    std::uint64_t interval = 0;
+    frames_begin_ = begin_ + magic_size;
+    if (file_.size() < magic_size || std::memcmp(begin_, TrajectoryFormat::MAGIC, magic_size) != 0 ||
+        !Varint::read_unsigned(frames_begin_, end_, interval) || interval == 0)
+    {
+        close();
+        return false;
+    }
+    keyframe_interval_ = static_cast<int>(interval);
+
+    has_stored_index_ = read_stored_index();
+    if (!has_stored_index_ && !build_index_by_scanning())
+    {
+        close();
+        return false;
+    }
+
+    // The last tick is in the last key-frame interval; decoding it once also proves
+    // the tail of the log is readable
+    if (!restart_at(keyframes_.size() - 1))
+    {
+        close();
+        return false;
+    }
+    while (step())
+    {
+    }
+    last_tick_ = current_.tick;
+
+    if (!restart_at(0))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool TrajectoryReplay::read_stored_index()
+{
+    const std::size_t size = static_cast<std::size_t>(end_ - begin_);
+    const std::size_t header_size = static_cast<std::size_t>(frames_begin_ - begin_);
+    if (size < header_size + TrajectoryFormat::TRAILER_SIZE)
+        return false;
+    const std::uint8_t *trailer = end_ - TrajectoryFormat::TRAILER_SIZE;
+    if (std::memcmp(trailer + 8, TrajectoryFormat::TRAILER_MAGIC, sizeof(TrajectoryFormat::TRAILER_MAGIC)) != 0)
+        return false;
+
+    std::uint64_t index_offset = 0;
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        index_offset |= static_cast<std::uint64_t>(trailer[byte]) << (8 * byte);
+    }
+    if (index_offset < header_size || index_offset >= size - TrajectoryFormat::TRAILER_SIZE)
+        return false;
+
+    const std::uint8_t *cursor = begin_ + index_offset;
+    std::uint64_t payload_size = 0, entries = 0;
+    if (*cursor++ != TrajectoryFormat::FRAME_INDEX || !Varint::read_unsigned(cursor, trailer, payload_size) ||
+        payload_size > static_cast<std::uint64_t>(trailer - cursor))
+        return false;
+    const std::uint8_t *payload_end = cursor + payload_size;
+    if (!Varint::read_unsigned(cursor, payload_end, entries) || entries == 0 ||
+        entries > static_cast<std::uint64_t>(payload_end - cursor))
+        return false;
+
+    std::vector<KeyframeEntry> keyframes;
+    keyframes.reserve(static_cast<std::size_t>(entries));
+    std::int64_t tick = 0;
+    std::uint64_t offset = 0;
+    for (std::uint64_t i = 0; i < entries; ++i)
+    {
+        std::int64_t tick_delta = 0;
+        std::uint64_t offset_delta = 0;
+        if (!Varint::read_signed(cursor, payload_end, tick_delta) ||
+            !Varint::read_unsigned(cursor, payload_end, offset_delta))
+            return false;
+        tick += tick_delta;
+        offset += offset_delta;
+        // Key frames lie between the header and the index, in increasing order
+        if (offset < header_size || offset >= index_offset ||
+            (!keyframes.empty() && (offset <= keyframes.back().offset || tick < keyframes.back().tick)))
+            return false;
+        keyframes.push_back({static_cast<int>(tick), static_cast<std::size_t>(offset)});
+    }
+
+    keyframes_ = std::move(keyframes);
+    end_ = begin_ + index_offset;
+    return true;
+}
+
+bool TrajectoryReplay::build_index_by_scanning()
+{
+    // No usable index: decode the whole log once. A log cut short (e.g. the recording
+    // process died) is readable up to its last complete frame.
+    TrajectoryDecoder decoder;
+    TrajectoryFrame frame;
+    std::uint8_t type = 0;
+    const std::uint8_t *cursor = frames_begin_;
+    keyframes_.clear();
+    while (cursor < end_)
+    {
+        const std::uint8_t *frame_start = cursor;
+        if (!decoder.decode(cursor, end_, frame, type))
+        {
+            end_ = frame_start;
+            break;
+        }
+        if (type == TrajectoryFormat::FRAME_KEY)
+        {
+            keyframes_.push_back({frame.tick, static_cast<std::size_t>(frame_start - begin_)});
+        }
+    }
+    return !keyframes_.empty();
+}
+
+void TrajectoryReplay::close()
+{
+    file_.close();
+    begin_ = frames_begin_ = end_ = cursor_ = nullptr;
+    keyframes_.clear();
+    keyframe_interval_ = 0;
+    has_stored_index_ = false;
+    last_tick_ = 0;
+    decoder_.reset();
+    current_.clear();
+    has_lookahead_ = false;
+    has_frame_ = false;
+    vehicles_valid_ = intersections_valid_ = false;
+    vehicles_.clear();
+    intersections_.clear();
+}
+
+bool TrajectoryReplay::is_open() const
+{
+    return has_frame_;
+}
+
+bool TrajectoryReplay::decode_next(TrajectoryFrame &out)
+{
+    std::uint8_t type = 0;
+    while (cursor_ < end_)
+    {
+        if (!decoder_.decode(cursor_, end_, out, type))
+        {
+            cursor_ = end_; // Nothing past a corrupt frame can be decoded
+            return false;
+        }
+        if (type != TrajectoryFormat::FRAME_INDEX)
+            return true;
+    }
+    return false;
+}
+
+bool TrajectoryReplay::restart_at(std::size_t keyframe)
+{
+    decoder_.reset();
+    cursor_ = begin_ + keyframes_[keyframe].offset;
+    has_lookahead_ = false;
+    vehicles_valid_ = intersections_valid_ = false;
+    has_frame_ = decode_next(current_);
+    return has_frame_;
+}
+
+bool TrajectoryReplay::fill_lookahead()
+{
+    if (!has_lookahead_)
+        has_lookahead_ = decode_next(lookahead_);
+    return has_lookahead_;
+}
+
+bool TrajectoryReplay::seek(int tick)
+{
+    if (!has_frame_)
+        return false;
+
+    // Last key frame at or before `tick`, or the first one
+    auto it = std::upper_bound(keyframes_.begin(), keyframes_.end(), tick,
+                               [](int target, const KeyframeEntry &entry)
+                               { return target < entry.tick; });
+    std::size_t keyframe = it == keyframes_.begin() ? 0 : static_cast<std::size_t>(it - keyframes_.begin()) - 1;
+
+    // Keep decoding forward when the target is ahead of us in the same key-frame interval
+    bool can_continue = current_.tick <= tick && current_.tick >= keyframes_[keyframe].tick;
+    if (!can_continue && !restart_at(keyframe))
+        return false;
+
+    while (fill_lookahead() && lookahead_.tick <= tick)
+    {
+        std::swap(current_, lookahead_);
+        has_lookahead_ = false;
+        vehicles_valid_ = intersections_valid_ = false;
+    }
+    return true;
+}
+
+bool TrajectoryReplay::step()
+{
+    if (!has_frame_ || !fill_lookahead())
+        return false;
+    std::swap(current_, lookahead_);
+    has_lookahead_ = false;
+    vehicles_valid_ = intersections_valid_ = false;
+    return true;
+}
+
+int TrajectoryReplay::get_first_tick() const
+{
+    return keyframes_.empty() ? 0 : keyframes_.front().tick;
+}
+
+int TrajectoryReplay::get_last_tick() const
+{
+    return last_tick_;
+}
+
+int TrajectoryReplay::get_keyframe_interval() const
+{
+    return keyframe_interval_;
+}
+
+std::size_t TrajectoryReplay::get_keyframe_count() const
+{
+    return keyframes_.size();
+}
+
+bool TrajectoryReplay::has_stored_index() const
+{
+    return has_stored_index_;
+}
+
+const TrajectoryFrame &TrajectoryReplay::get_frame() const
+{
+    return current_;
+}
+
+int TrajectoryReplay::get_current_tick() const
+{
+    return current_.tick;
+}
+
+namespace
+{
+    void rebuild_vehicles(const TrajectoryFrame &frame, std::map<int, Vehicle> &vehicles)
+    {
+        vehicles.clear();
+        for (std::size_t i = 0; i < frame.vehicle_ids.size(); ++i)
+        {
+            // The source node isn't recorded; the current node is the best stand-in.
+            // Ids are sorted, so every insertion goes at the end.
+            Vehicle vehicle(frame.vehicle_ids[i], frame.current_nodes[i], frame.destinations[i]);
+            vehicle.set_state(static_cast<VehicleState>(frame.vehicle_states[i]));
+            vehicle.set_current_node_id(frame.current_nodes[i]);
+            vehicle.set_next_node_id(frame.next_nodes[i]);
+            vehicle.set_current_edge_ticks(frame.progress_ticks[i], frame.total_ticks[i]);
+            vehicles.emplace_hint(vehicles.end(), frame.vehicle_ids[i], vehicle);
+        }
+    }
+
+    void rebuild_intersections(const TrajectoryFrame &frame, std::map<int, Intersection> &intersections)
+    {
+        intersections.clear();
+        std::size_t approach = 0, queued = 0;
+        std::vector<int> approach_ids;
+        for (std::size_t i = 0; i < frame.intersection_ids.size(); ++i)
+        {
+            const std::size_t approach_end = approach + static_cast<std::size_t>(frame.approach_counts[i]);
+            approach_ids.assign(frame.approach_ids.begin() + approach, frame.approach_ids.begin() + approach_end);
+            Intersection intersection(frame.intersection_ids[i], approach_ids);
+            intersection.restore_phase(frame.green_indices[i], static_cast<LightState>(frame.phases[i]),
+                                       frame.ticks_in_state[i]);
+            for (; approach < approach_end; ++approach)
+            {
+                for (int n = 0; n < frame.queue_lengths[approach]; ++n)
+                {
+                    intersection.add_vehicle_to_queue(frame.queued_vehicle_ids[queued++], frame.approach_ids[approach]);
+                }
+            }
+            intersections.emplace_hint(intersections.end(), frame.intersection_ids[i], intersection);
+        }
+    }
+
+    // Column lengths are consistent in frames written by TrajectoryRecorder; a corrupt
+    // log could still decode into inconsistent ones, which must not be indexed blindly
+    bool intersection_columns_consistent(const TrajectoryFrame &frame)
+    {
+        std::size_t approaches = 0, queued = 0;
+        for (int count : frame.approach_counts)
+        {
+            if (count < 0)
+                return false;
+            approaches += static_cast<std::size_t>(count);
+        }
+        if (approaches != frame.approach_ids.size() || approaches != frame.queue_lengths.size())
+            return false;
+        for (int length : frame.queue_lengths)
+        {
+            if (length < 0)
+                return false;
+            queued += static_cast<std::size_t>(length);
+        }
+        return queued == frame.queued_vehicle_ids.size();
+    }
+}
+
+const std::map<int, Vehicle> &TrajectoryReplay::get_vehicles() const
+{
+    if (!vehicles_valid_)
+    {
+        rebuild_vehicles(current_, vehicles_);
+        vehicles_valid_ = true;
+    }
+    return vehicles_;
+}
+
+const std::map<int, Intersection> &TrajectoryReplay::get_intersections() const
+{
+    if (!intersections_valid_)
+    {
+        if (intersection_columns_consistent(current_))
+            rebuild_intersections(current_, intersections_);
+        else
+            intersections_.clear();
+        intersections_valid_ = true;
+    }
+    return intersections_;
+}
@@ -2,6 +2,26 @@
 #include <algorithm> // For std::remove_if for trim_whitespace, std::stoi, std::stod
 #include <cctype>    // For std::isspace
 #include <iostream>  // For potential error messages (optional)
+#include <charconv>  // For std::from_chars
+#include <utility>   // For std::swap
+#include <mutex>
+#include <cstring>   // For std::memmove
+#include <climits>   // For INT_MAX
+#include <memory>    // For std::unique_ptr
+#include <zlib.h>
+#ifdef TRAFFICSIM_HAVE_ZSTD
+#include <cstdio>
+#include <zstd.h>
+#endif
+#include "thread_pool.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define UTILS_HAVE_MMAP 1
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#endif
 
 namespace Utils {
 
@@ -20,27 +40,21 @@ std::string trim_whitespace(const std::string& str) {
 
 std::vector<CsvRow> parse_csv(const std::string& filepath, char delimiter) {
     std::vector<CsvRow> data;
-    std::ifstream file(filepath);
-
-    if (!file.is_open()) {
-        // Handle error: file could not be opened
-        // std::cerr << "Error: Could not open CSV file: " << filepath << std::endl;
-        return data; // Return empty data
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
+    // Splits the way the original std::getline loop did: every line is a row (blank lines
+    // give empty rows, '#' lines are data) and a trailing delimiter adds no empty field.
+    for_each_line(filepath, [&data, delimiter](std::string_view line) {
         CsvRow row;
-        std::stringstream line_stream(line);
-        std::string field;
-
-        while (std::getline(line_stream, field, delimiter)) {
-            row.fields.push_back(trim_whitespace(field));
+        std::size_t start = 0;
+        while (start < line.size()) {
+            std::size_t end = line.find(delimiter, start);
+            if (end == std::string_view::npos) {
+                end = line.size();
+            }
+            row.fields.emplace_back(trim_view(line.substr(start, end - start)));
+            start = end + 1;
         }
-        data.push_back(row);
-    }
-
-    file.close();
+        data.push_back(std::move(row));
+    });
     return data;
 }
 
@@ -70,4 +84,428 @@ bool string_to_double(const std::string& str, double& out_value) {
     }
 }
 
+// --- MappedFile ---
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), is_open_(false), is_mapped_(false) {}
+
+MappedFile::MappedFile(const std::string& filepath) : MappedFile() {
+    open(filepath);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(is_open_, other.is_open_);
+        std::swap(is_mapped_, other.is_mapped_);
+        fallback_buffer_.swap(other.fallback_buffer_);
+        if (!is_mapped_) {
+            data_ = fallback_buffer_.data();
+        }
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& filepath) {
+    close();
+#ifdef UTILS_HAVE_MMAP
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+        size_ = static_cast<std::size_t>(file_stat.st_size);
+        if (size_ == 0) {
+            is_open_ = true; // Nothing to map
+            ::close(fd);
+            return true;
+        }
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapping);
+            is_mapped_ = true;
+            is_open_ = true;
+            ::close(fd); // The mapping stays valid after the descriptor is closed
+            return true;
+        }
+    }
+    ::close(fd);
+    size_ = 0;
+#endif
+    // Fallback: read the whole file into memory
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    fallback_buffer_ = contents.str();
+    data_ = fallback_buffer_.data();
+    size_ = fallback_buffer_.size();
+    is_open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef UTILS_HAVE_MMAP
+    if (is_mapped_ && data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    fallback_buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+    is_mapped_ = false;
+}
+
+bool MappedFile::is_open() const { return is_open_; }
+std::string_view MappedFile::data() const { return std::string_view(data_ ? data_ : "", size_); }
+std::size_t MappedFile::size() const { return size_; }
+
+// --- Compressed input ---
+
+Compression detect_compression(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    unsigned char magic[4] = {0, 0, 0, 0};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    std::streamsize bytes = file.gcount();
+    if (bytes >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return Compression::GZIP;
+    }
+    if (bytes >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+namespace {
+// Reads up to `capacity` decompressed bytes into `out`. Returns the number of bytes read,
+// 0 at the end of the stream, or -1 on error.
+using DecompressRead = std::function<long(char* out, std::size_t capacity)>;
+
+// Pulls decompressed data into a reusable block and hands out everything up to the last
+// complete line; the partial line is moved to the front and completed by the next read.
+bool pump_line_blocks(const DecompressRead& read, const LineBlockCallback& on_block) {
+    std::vector<char> block(DECOMPRESS_BLOCK_BYTES);
+    std::size_t filled = 0;
+    while (true) {
+        if (filled == block.size()) {
+            block.resize(block.size() * 2); // A single line longer than the block
+        }
+        std::size_t capacity = std::min<std::size_t>(block.size() - filled, INT_MAX);
+        long bytes = read(block.data() + filled, capacity);
+        if (bytes < 0) {
+            return false;
+        }
+        if (bytes == 0) {
+            if (filled > 0) {
+                on_block(std::string_view(block.data(), filled));
+            }
+            return true;
+        }
+        filled += static_cast<std::size_t>(bytes);
+
+        std::size_t complete = filled;
+        while (complete > 0 && block[complete - 1] != '\n') complete--;
+        if (complete == 0) {
+            continue; // No complete line yet
+        }
+        on_block(std::string_view(block.data(), complete));
+        std::memmove(block.data(), block.data() + complete, filled - complete);
+        filled -= complete;
+    }
+}
+
+bool pump_gzip(const std::string& filepath, const LineBlockCallback& on_block) {
+    std::unique_ptr<gzFile_s, int (*)(gzFile)> file(gzopen(filepath.c_str(), "rb"), gzclose);
+    if (!file) {
+        return false;
+    }
+    gzbuffer(file.get(), 1 << 18); // Larger zlib input buffer than the 8 KB default
+    return pump_line_blocks([&file](char* out, std::size_t capacity) -> long {
+        int bytes = gzread(file.get(), out, static_cast<unsigned>(capacity));
+        if (bytes == 0) {
+            int error = Z_OK;
+            gzerror(file.get(), &error);
+            if (error != Z_OK) {
+                return -1; // e.g. Z_BUF_ERROR for a truncated archive
+            }
+        }
+        return bytes;
+    }, on_block);
+}
+
+#ifdef TRAFFICSIM_HAVE_ZSTD
+bool pump_zstd(const std::string& filepath, const LineBlockCallback& on_block) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(filepath.c_str(), "rb"), std::fclose);
+    std::unique_ptr<ZSTD_DCtx, std::size_t (*)(ZSTD_DCtx*)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (!file || !context) {
+        return false;
+    }
+    std::vector<char> input(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in = {input.data(), 0, 0};
+    std::size_t last_result = 0;
+    bool end_of_file = false;
+
+    return pump_line_blocks([&](char* out_data, std::size_t capacity) -> long {
+        ZSTD_outBuffer out = {out_data, capacity, 0};
+        while (out.pos == 0) {
+            if (in.pos == in.size) {
+                if (end_of_file) {
+                    // The decoder can still hold decoded data after consuming all input;
+                    // drain it with empty input until it has nothing left to give
+                    while (last_result != 0 && out.pos < out.size) {
+                        std::size_t before = out.pos;
+                        last_result = ZSTD_decompressStream(context.get(), &out, &in);
+                        if (ZSTD_isError(last_result)) {
+                            return -1;
+                        }
+                        if (out.pos == before) {
+                            break;
+                        }
+                    }
+                    if (out.pos > 0) {
+                        return static_cast<long>(out.pos);
+                    }
+                    return last_result == 0 ? 0 : -1; // Non-zero with no progress: truncated frame
+                }
+                in.size = std::fread(input.data(), 1, input.size(), file.get());
+                in.pos = 0;
+                if (in.size == 0) {
+                    end_of_file = true;
+                    continue;
+                }
+            }
+            last_result = ZSTD_decompressStream(context.get(), &out, &in);
+            if (ZSTD_isError(last_result)) {
+                return -1;
+            }
+        }
+        return static_cast<long>(out.pos);
+    }, on_block);
+}
+#endif
+} // namespace
+
+bool for_each_line_block(const std::string& filepath, const LineBlockCallback& on_block) {
+    switch (detect_compression(filepath)) {
+    case Compression::GZIP:
+        return pump_gzip(filepath, on_block);
+    case Compression::ZSTD:
+#ifdef TRAFFICSIM_HAVE_ZSTD
+        return pump_zstd(filepath, on_block);
+#else
+        std::cerr << "Error: " << filepath << " is zstd-compressed but zstd support was not built in "
+                  << "(build with TRAFFICSIM_HAVE_ZSTD)." << std::endl;
+        return false;
+#endif
+    case Compression::NONE:
+        break;
+    }
+
+    MappedFile file;
+    if (!file.open(filepath)) {
+        return false;
+    }
+    if (file.size() > 0) {
+        on_block(file.data());
+    }
+    return true;
+}
+
+bool for_each_line(const std::string& filepath, const std::function<void(std::string_view)>& on_line) {
+    return for_each_line_block(filepath, [&on_line](std::string_view block) {
+        std::size_t start = 0;
+        while (start < block.size()) {
+            std::size_t end = block.find('\n', start);
+            if (end == std::string_view::npos) {
+                end = block.size();
+            }
+            on_line(block.substr(start, end - start));
+            start = end + 1;
+        }
+    });
+}
+
+// --- CsvCursor ---
+
+CsvCursor::CsvCursor(std::string_view buffer, char delimiter)
+    : buffer_(buffer), position_(0), delimiter_(delimiter) {}
+
+bool CsvCursor::next(CsvFields& fields) {
+    while (position_ < buffer_.size()) {
+        std::size_t line_end = buffer_.find('\n', position_);
+        if (line_end == std::string_view::npos) {
+            line_end = buffer_.size();
+        }
+        std::string_view line = buffer_.substr(position_, line_end - position_);
+        position_ = line_end < buffer_.size() ? line_end + 1 : buffer_.size();
+
+        std::string_view trimmed = trim_view(line);
+        if (trimmed.empty() || trimmed.front() == '#') {
+            continue; // Blank or comment line
+        }
+
+        fields.clear();
+        std::size_t field_start = 0;
+        while (true) {
+            std::size_t field_end = line.find(delimiter_, field_start);
+            if (field_end == std::string_view::npos) {
+                fields.push_back(trim_view(line.substr(field_start)));
+                break;
+            }
+            fields.push_back(trim_view(line.substr(field_start, field_end - field_start)));
+            field_start = field_end + 1;
+        }
+        return true;
+    }
+    return false;
+}
+
+std::size_t CsvCursor::position() const { return position_; }
+
+void parse_csv_buffer(std::string_view buffer, const CsvRowCallback& on_row, char delimiter) {
+    CsvCursor cursor(buffer, delimiter);
+    CsvFields fields;
+    while (cursor.next(fields)) {
+        on_row(fields);
+    }
+}
+
+bool for_each_csv_row(const std::string& filepath, const CsvRowCallback& on_row, char delimiter) {
+    return for_each_line_block(filepath, [&](std::string_view block) {
+        parse_csv_buffer(block, on_row, delimiter);
+    });
+}
+
+std::string_view trim_view(std::string_view str) {
+    std::size_t begin = 0;
+    std::size_t end = str.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(str[begin]))) begin++;
+    while (end > begin && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
+    return str.substr(begin, end - begin);
+}
+
+bool parse_int(std::string_view str, int& out_value) {
+    str = trim_view(str);
+    const char* end = str.data() + str.size();
+    auto result = std::from_chars(str.data(), end, out_value);
+    return result.ec == std::errc() && result.ptr == end && !str.empty();
+}
+
+bool parse_double(std::string_view str, double& out_value) {
+    str = trim_view(str);
+    const char* end = str.data() + str.size();
+    auto result = std::from_chars(str.data(), end, out_value);
+    return result.ec == std::errc() && result.ptr == end && !str.empty();
+}
+
+bool parse_traffic_row(const CsvFields& fields, TrafficDataPoint& out_point) {
+    return fields.size() >= 5 &&
+           parse_int(fields[0], out_point.timestamp) &&
+           parse_int(fields[1], out_point.edge_id) &&
+           parse_double(fields[2], out_point.density) &&
+           parse_double(fields[3], out_point.average_speed) &&
+           parse_int(fields[4], out_point.vehicles_passed);
+}
+
+// --- Parallel traffic data ingestion ---
+
+namespace {
+// Chunks smaller than this are not worth a task of their own.
+const std::size_t MIN_CHUNK_BYTES = 1 << 20;
+// Chunks per worker in flight at once; bounds the memory held by parsed batches.
+const std::size_t CHUNKS_PER_WORKER = 4;
+// Rough bytes per row, used to pre-size the column vectors of a chunk.
+const std::size_t ESTIMATED_ROW_BYTES = 24;
+}
+
+std::vector<std::string_view> split_line_chunks(std::string_view buffer, std::size_t max_chunks) {
+    std::vector<std::string_view> chunks;
+    if (buffer.empty()) return chunks;
+    if (max_chunks == 0) max_chunks = 1;
+
+    const std::size_t target = (buffer.size() + max_chunks - 1) / max_chunks;
+    std::size_t start = 0;
+    while (start < buffer.size()) {
+        std::size_t end = start + target;
+        if (end >= buffer.size()) {
+            end = buffer.size();
+        } else {
+            std::size_t newline = buffer.find('\n', end - 1);
+            end = newline == std::string_view::npos ? buffer.size() : newline + 1;
+        }
+        chunks.push_back(buffer.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+void parse_traffic_columns(std::string_view buffer, TrafficDataColumns& out, char delimiter) {
+    out.reserve(out.size() + buffer.size() / ESTIMATED_ROW_BYTES);
+    CsvCursor cursor(buffer, delimiter);
+    CsvFields fields;
+    TrafficDataPoint point;
+    while (cursor.next(fields)) {
+        if (parse_traffic_row(fields, point)) {
+            out.push_back(point);
+        }
+    }
+}
+
+bool for_each_traffic_batch(const std::string& filepath, const TrafficBatchCallback& on_batch,
+                            bool ordered, std::size_t num_threads, char delimiter) {
+    ThreadPool pool(num_threads);
+    const std::size_t wave_size = pool.size() * CHUNKS_PER_WORKER;
+    std::vector<TrafficDataColumns> batches(wave_size);
+    std::mutex callback_mutex;
+
+    // Plain files arrive as one mapped block, compressed files as decompressed blocks;
+    // either way each block is cut into line-aligned chunks parsed across the pool.
+    return for_each_line_block(filepath, [&](std::string_view block) {
+        std::size_t max_chunks = block.size() / MIN_CHUNK_BYTES + 1;
+        std::vector<std::string_view> chunks = split_line_chunks(block, max_chunks);
+
+        // Chunks are processed in waves of wave_size so that at most one wave of parsed
+        // batches is alive at a time.
+        for (std::size_t wave_start = 0; wave_start < chunks.size(); wave_start += wave_size) {
+            const std::size_t wave_count = std::min(wave_size, chunks.size() - wave_start);
+            pool.parallel_for(wave_count, [&](std::size_t i) {
+                TrafficDataColumns& batch = batches[i];
+                batch.clear();
+                parse_traffic_columns(chunks[wave_start + i], batch, delimiter);
+                if (!ordered && !batch.empty()) {
+                    std::lock_guard<std::mutex> lock(callback_mutex);
+                    on_batch(batch);
+                }
+            });
+            if (ordered) {
+                for (std::size_t i = 0; i < wave_count; ++i) {
+                    if (!batches[i].empty()) on_batch(batches[i]);
+                }
+            }
+        }
+    });
+}
+
+bool load_traffic_columns(const std::string& filepath, TrafficDataColumns& out,
+                          std::size_t num_threads, char delimiter) {
+    out.clear();
+    return for_each_traffic_batch(filepath, [&out](const TrafficDataColumns& batch) {
+        out.append(batch);
+    }, true, num_threads, delimiter);
+}
+
 } // namespace Utils
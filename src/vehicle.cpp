@@ -20,44 +20,47 @@ Vehicle::Vehicle(int id, int source_node_id, int destination_node_id)
       current_node_id_(source_node_id_), // Initially at source
       next_node_id_(-1), // Unknown until path is planned and journey started
       current_edge_progress_ticks_(0),
-      current_edge_total_ticks_(0) {
+      current_edge_total_ticks_(0),
+      current_edge_id_(-1),
+      departure_tick_(-1),
+      queue_entry_tick_(0),
+      delay_ticks_(0) {
 }
 
 void Vehicle::plan_route(const Graph& graph) {
-    current_path_ = graph.find_shortest_path(source_node_id_, destination_node_id_);
+    set_route(std::make_shared<const std::vector<int>>(graph.find_shortest_path(source_node_id_, destination_node_id_)));
     // After planning, call start_journey to set initial movement vars
 }
 
 void Vehicle::start_journey(const Graph& graph) {
     current_edge_progress_ticks_ = 0;
     current_edge_total_ticks_ = 0;
+    current_edge_id_ = -1;
 
     if (source_node_id_ == destination_node_id_) {
         state_ = VehicleState::ARRIVED;
         current_node_id_ = destination_node_id_;
         next_node_id_ = -1; // No next node
-        current_path_.clear(); // Path is trivial
-        if (!current_path_.empty() && current_path_.front() == source_node_id_) {
-            // if path was planned and only contains source, that's fine
-        } else {
-             current_path_ = {source_node_id_}; // Path is just the node itself
-        }
+        // Path is trivial: just the node itself
+        current_path_ = std::make_shared<const std::vector<int>>(1, source_node_id_);
         return;
     }
 
-    if (!current_path_.empty()) {
+    const std::vector<int>& path = get_current_path();
+    if (!path.empty()) {
         // Ensure path starts with the source node if it's not empty
         // This could happen if plan_route was called, then source_node_id_ was changed, then start_journey was called.
         // Or if path planning itself had an issue.
         // For robustness, we could re-align or error. Here, we assume current_path_[0] is the true start if path exists.
-        current_node_id_ = current_path_.front();
+        current_node_id_ = path.front();
 
-        if (current_path_.size() > 1) {
-            next_node_id_ = current_path_[1];
+        if (path.size() > 1) {
+            next_node_id_ = path[1];
             const Edge* edge = graph.get_edge_between(current_node_id_, next_node_id_);
             if (edge) {
                 // Using edge weight directly as ticks. Could be scaled or calculated differently.
                 current_edge_total_ticks_ = static_cast<int>(edge->weight);
+                current_edge_id_ = edge->id;
                 if (current_edge_total_ticks_ < 1) current_edge_total_ticks_ = 1; // Minimum 1 tick per edge
                 state_ = VehicleState::EN_ROUTE;
             } else {
@@ -91,14 +94,28 @@ void Vehicle::start_journey(const Graph& graph) {
 int Vehicle::get_id() const { return id_; }
 int Vehicle::get_source_node_id() const { return source_node_id_; }
 int Vehicle::get_destination_node_id() const { return destination_node_id_; }
-const std::vector<int>& Vehicle::get_current_path() const { return current_path_; }
+const std::vector<int>& Vehicle::get_current_path() const {
+    static const std::vector<int> empty_path;
+    return current_path_ ? *current_path_ : empty_path;
+}
+const std::shared_ptr<const std::vector<int>>& Vehicle::get_shared_path() const { return current_path_; }
 VehicleState Vehicle::get_state() const { return state_; }
 int Vehicle::get_current_node_id() const { return current_node_id_; }
 int Vehicle::get_next_node_id() const { return next_node_id_; }
 int Vehicle::get_current_edge_progress_ticks() const { return current_edge_progress_ticks_; }
 int Vehicle::get_current_edge_total_ticks() const { return current_edge_total_ticks_; }
+int Vehicle::get_current_edge_id() const { return current_edge_id_; }
+int Vehicle::get_departure_tick() const { return departure_tick_; }
+int Vehicle::get_queue_entry_tick() const { return queue_entry_tick_; }
+int Vehicle::get_delay_ticks() const { return delay_ticks_; }
 
 // Mutators
+void Vehicle::set_route(std::shared_ptr<const std::vector<int>> path) {
+    if (path && path->empty()) {
+        path.reset(); // Keep "no route" as a null pointer so it costs nothing to copy
+    }
+    current_path_ = std::move(path);
+}
 void Vehicle::set_state(VehicleState new_state) { state_ = new_state; }
 void Vehicle::set_current_node_id(int node_id) { current_node_id_ = node_id; }
 void Vehicle::set_next_node_id(int node_id) { next_node_id_ = node_id; }
@@ -109,8 +126,12 @@ void Vehicle::set_current_edge_ticks(int progress, int total) {
         current_edge_total_ticks_ = 1;
     }
 }
+void Vehicle::set_current_edge_id(int edge_id) { current_edge_id_ = edge_id; }
 void Vehicle::increment_edge_progress_ticks() {
     if (state_ == VehicleState::EN_ROUTE) {
         current_edge_progress_ticks_++;
     }
 }
+void Vehicle::set_departure_tick(int tick) { departure_tick_ = tick; }
+void Vehicle::set_queue_entry_tick(int tick) { queue_entry_tick_ = tick; }
+void Vehicle::add_delay_ticks(int ticks) { delay_ticks_ += ticks; }
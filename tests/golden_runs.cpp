@@ -0,0 +1,360 @@
+// Golden-run regression gate.
+// Usage: golden_runs [--golden path] [--baseline path] [--tolerance fraction] [--no-perf]
+//                    [--update] [--record-baseline]
+// Runs fixed-seed scenarios (the networks of test_simulation.cpp plus generated grid
+// and geometric networks), hashes the full state after every tick (the columns of
+// Simulation::capture_frame) and compares the hash of each trajectory with its golden
+// value, so an optimisation that changes behaviour in any way is caught.
+//
+// Speeds depend on the machine and the build flags, so they are never committed: they
+// are checked only against a local baseline file (--baseline; `make regress` keeps one
+// per build directory). Timed scenarios listed there fail when slower than
+// baseline * (1 - tolerance); without the file only the hashes are checked. Exits 1 on
+// any mismatch or regression.
+//
+// --update rewrites the golden file with the hashes measured now, after an intended
+// behaviour change. --record-baseline checks the hashes as usual and writes the speeds
+// measured now to the --baseline file.
+#include <algorithm> // For std::max
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "network_generator.hpp"
+#include "simulation.hpp"
+#include "trajectory.hpp"
+
+namespace
+{
+    // FNV-1a over little-endian 32-bit values, independent of the host byte order
+    class TrajectoryHash
+    {
+    public:
+        void add(std::uint32_t value)
+        {
+            for (int byte = 0; byte < 4; ++byte)
+            {
+                hash_ ^= (value >> (8 * byte)) & 0xFF;
+                hash_ *= 0x100000001B3ULL;
+            }
+        }
+        template <typename T>
+        void add_column(const std::vector<T> &column)
+        {
+            add(static_cast<std::uint32_t>(column.size()));
+            for (T value : column)
+                add(static_cast<std::uint32_t>(value));
+        }
+        void add_frame(const TrajectoryFrame &frame)
+        {
+            add(static_cast<std::uint32_t>(frame.tick));
+            add_column(frame.vehicle_ids);
+            add_column(frame.vehicle_states);
+            add_column(frame.current_nodes);
+            add_column(frame.next_nodes);
+            add_column(frame.progress_ticks);
+            add_column(frame.total_ticks);
+            add_column(frame.destinations);
+            add_column(frame.intersection_ids);
+            add_column(frame.green_indices);
+            add_column(frame.phases);
+            add_column(frame.ticks_in_state);
+            add_column(frame.approach_counts);
+            add_column(frame.approach_ids);
+            add_column(frame.queue_lengths);
+            add_column(frame.queued_vehicle_ids);
+        }
+        std::string hex() const
+        {
+            std::ostringstream out;
+            out << std::hex << std::setw(16) << std::setfill('0') << hash_;
+            return out.str();
+        }
+
+    private:
+        std::uint64_t hash_ = 0xCBF29CE484222325ULL;
+    };
+
+    struct Scenario
+    {
+        std::string name;
+        int ticks;
+        std::function<void(Simulation &)> setup; // Called on Simulation(seed)
+        unsigned int seed;
+        bool timed; // Big enough for a stable ticks/sec figure
+    };
+
+    void add_routed_vehicle(Simulation &sim, int id, int from, int to)
+    {
+        Vehicle vehicle(id, from, to);
+        vehicle.plan_route(sim.get_graph());
+        sim.add_vehicle(vehicle);
+    }
+
+    // Network of test_single_vehicle_full_journey
+    void setup_line(Simulation &sim)
+    {
+        Graph g;
+        g.add_node(1, 100, 100);
+        g.add_node(2, 200, 100);
+        g.add_node(3, 300, 100);
+        g.add_edge(12, 1, 2, 3);
+        g.add_edge(23, 2, 3, 4);
+        sim.set_graph(g);
+        sim.add_intersection(Intersection(1, {12}));
+        sim.add_intersection(Intersection(2, {23}));
+        for (int id = 1; id <= 3; ++id)
+            add_routed_vehicle(sim, id, 1, 3);
+    }
+
+    // Two-way corridor of test_fork_shares_graph_and_diverges (also the spawning test)
+    void setup_corridor(Simulation &sim)
+    {
+        Graph g;
+        g.add_node(1, 0, 0);
+        g.add_node(2, 0, 0);
+        g.add_node(3, 0, 0);
+        g.add_edge(12, 1, 2, 5);
+        g.add_edge(21, 2, 1, 5);
+        g.add_edge(23, 2, 3, 5);
+        g.add_edge(32, 3, 2, 5);
+        sim.set_graph(g);
+        sim.add_intersection(Intersection(2, {21, 23}));
+        add_routed_vehicle(sim, 500, 1, 3);
+    }
+
+    std::vector<Scenario> scenarios()
+    {
+        return {
+            {"line_journey", 400, setup_line, 1, false},
+            {"corridor_spawning", 2000, setup_corridor, 42, false},
+            {"grid_20x20_5k", 200, [](Simulation &sim)
+             {
+                 NetworkGenerator::install(sim, NetworkGenerator::make_grid(20, 20));
+                 NetworkGenerator::add_vehicles(sim, 5000, 1, 1000000, 1024);
+             },
+             7, true},
+            {"geometric_500_2k", 200, [](Simulation &sim)
+             {
+                 NetworkGenerator::install(sim, NetworkGenerator::make_random_geometric(500, 6.0, 3));
+                 NetworkGenerator::add_vehicles(sim, 2000, 3, 1000000, 512);
+             },
+             11, true},
+        };
+    }
+
+    // `base` is the scenario's initial state; runs tick forks of it, which start out
+    // identical (graph, vehicles, signals and random engine state)
+    std::string run_hashed(const Scenario &scenario, const Simulation &base)
+    {
+        Simulation sim = base.fork();
+        TrajectoryHash hash;
+        TrajectoryFrame frame;
+        sim.capture_frame(frame);
+        hash.add_frame(frame);
+        for (int t = 0; t < scenario.ticks; ++t)
+        {
+            sim.tick();
+            sim.capture_frame(frame);
+            hash.add_frame(frame);
+        }
+        // A fork must replay the same future as the original
+        Simulation branch = sim.fork();
+        branch.tick();
+        sim.tick();
+        TrajectoryFrame branch_frame;
+        branch.capture_frame(branch_frame);
+        sim.capture_frame(frame);
+        TrajectoryHash a, b;
+        a.add_frame(frame);
+        b.add_frame(branch_frame);
+        if (a.hex() != b.hex())
+            return "fork-diverged";
+        hash.add_frame(frame);
+        return hash.hex();
+    }
+
+    // Best of three runs, to be robust against machine noise
+    double measure_ticks_per_second(const Scenario &scenario, const Simulation &base)
+    {
+        double best = 0.0;
+        for (int run = 0; run < 3; ++run)
+        {
+            Simulation sim = base.fork();
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < scenario.ticks; ++t)
+                sim.tick();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::max(best, scenario.ticks / std::max(seconds, 1e-9));
+        }
+        return best;
+    }
+
+    // Lines: <scenario> <value>; '#' starts a comment. Golden files hold hashes, baseline
+    // files ticks/sec. Values after the first are ignored (older golden files had speeds).
+    template <typename Value>
+    std::map<std::string, Value> load_values(const std::string &path)
+    {
+        std::map<std::string, Value> values;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream fields(line);
+            std::string name;
+            Value value;
+            if (fields >> name >> value)
+                values[name] = value;
+        }
+        return values;
+    }
+
+    template <typename Value>
+    bool save_values(const std::string &path, const std::string &header, const std::map<std::string, Value> &values)
+    {
+        std::ofstream file(path);
+        file << header;
+        for (const auto &pair : values)
+            file << pair.first << " " << std::fixed << std::setprecision(1) << pair.second << "\n";
+        return static_cast<bool>(file);
+    }
+
+    const char *GOLDEN_HEADER =
+        "# Golden runs: <scenario> <trajectory hash>\n"
+        "# Written by `golden_runs --update`; hashes change only with simulation behaviour.\n"
+        "# Speed baselines are machine-specific and kept out of this file (see --baseline).\n";
+    const char *BASELINE_HEADER =
+        "# Local golden-run speed baselines: <scenario> <ticks/sec>\n"
+        "# Written by `golden_runs --record-baseline` for this machine and build.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string golden_path = "tests/golden/golden_runs.txt";
+    std::string baseline_path;
+    double tolerance = 0.25;
+    bool check_perf = true;
+    bool update = false;
+    bool record_baseline = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--golden" && i + 1 < argc)
+            golden_path = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = std::atof(argv[++i]);
+        else if (arg == "--no-perf")
+            check_perf = false;
+        else if (arg == "--update")
+            update = true;
+        else if (arg == "--record-baseline")
+            record_baseline = true;
+        else
+        {
+            std::cerr << "Usage: golden_runs [--golden path] [--baseline path] [--tolerance fraction] [--no-perf]\n"
+                      << "                   [--update] [--record-baseline]" << std::endl;
+            return 2;
+        }
+    }
+    if (record_baseline && baseline_path.empty())
+    {
+        std::cerr << "Error: --record-baseline needs --baseline path." << std::endl;
+        return 2;
+    }
+
+    const std::map<std::string, std::string> golden = load_values<std::string>(golden_path);
+    const std::map<std::string, double> baseline =
+        baseline_path.empty() ? std::map<std::string, double>() : load_values<double>(baseline_path);
+    if (check_perf && !record_baseline && !update && baseline.empty())
+        std::cout << "No local speed baseline" << (baseline_path.empty() ? "" : " in " + baseline_path)
+                  << "; checking hashes only (record one with --record-baseline)." << std::endl;
+
+    std::map<std::string, std::string> hashes;
+    std::map<std::string, double> speeds;
+    int failures = 0;
+    for (const Scenario &scenario : scenarios())
+    {
+        Simulation base(scenario.seed);
+        scenario.setup(base);
+        const std::string hash = run_hashed(scenario, base);
+        hashes[scenario.name] = hash;
+        auto expected = golden.find(scenario.name);
+        auto expected_speed = baseline.find(scenario.name);
+        bool timed = scenario.timed && (record_baseline || (check_perf && !update && expected_speed != baseline.end() &&
+                                                            expected_speed->second > 0));
+        double ticks_per_second = 0.0;
+        if (timed)
+        {
+            ticks_per_second = measure_ticks_per_second(scenario, base);
+            speeds[scenario.name] = ticks_per_second;
+        }
+
+        std::cout << std::left << std::setw(20) << scenario.name << " hash " << hash;
+        if (timed)
+            std::cout << "  " << std::fixed << std::setprecision(1) << ticks_per_second << " ticks/s";
+        if (update)
+        {
+            std::cout << "  (recorded)" << std::endl;
+            continue;
+        }
+        if (expected == golden.end())
+        {
+            std::cout << "  FAIL: no golden value" << std::endl;
+            failures++;
+            continue;
+        }
+        if (hash != expected->second)
+        {
+            std::cout << "  FAIL: trajectory differs from golden " << expected->second << std::endl;
+            failures++;
+            continue;
+        }
+        if (timed && !record_baseline && ticks_per_second < expected_speed->second * (1.0 - tolerance))
+        {
+            std::cout << "  FAIL: slower than baseline " << expected_speed->second << " ticks/s by more than "
+                      << tolerance * 100 << "%" << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << "  ok" << std::endl;
+    }
+
+    if (update)
+    {
+        if (!save_values(golden_path, GOLDEN_HEADER, hashes))
+        {
+            std::cerr << "Error: Could not write '" << golden_path << "'." << std::endl;
+            return 1;
+        }
+        std::cout << "Golden values written to " << golden_path << std::endl;
+        return 0;
+    }
+    if (failures)
+    {
+        std::cout << "Golden runs FAILED: " << failures << " scenario(s)." << std::endl;
+        return 1;
+    }
+    if (record_baseline)
+    {
+        if (!save_values(baseline_path, BASELINE_HEADER, speeds))
+        {
+            std::cerr << "Error: Could not write '" << baseline_path << "'." << std::endl;
+            return 1;
+        }
+        std::cout << "Speed baselines written to " << baseline_path << std::endl;
+        return 0;
+    }
+    std::cout << "All golden runs passed." << std::endl;
+    return 0;
+}
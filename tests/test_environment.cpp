@@ -0,0 +1,143 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include "environment.hpp"
+#include "simulation.hpp"
+#include "graph.hpp"
+#include "intersection.hpp"
+
+// Line of three nodes with signals on both interior approaches
+void setup_line_network(Simulation &sim)
+{
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 0, 0);
+    g.add_node(3, 0, 0);
+    g.add_edge(12, 1, 2, 4);
+    g.add_edge(21, 2, 1, 4);
+    g.add_edge(23, 2, 3, 4);
+    g.add_edge(32, 3, 2, 4);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(1, {12}));
+    sim.add_intersection(Intersection(2, {21, 23}));
+}
+
+void test_observation_layout_and_actions()
+{
+    std::cout << "Running test_observation_layout_and_actions..." << std::endl;
+    Simulation prototype(3);
+    setup_line_network(prototype);
+
+    TrafficEnvironment env(prototype);
+    assert(env.max_approaches() == 2);
+    assert(env.action_size() == 2);
+    assert(env.observation_size() == 2 * (2 + 3));
+
+    std::vector<float> obs(env.observation_size(), -1.0f);
+    env.reset(11, obs.data());
+    // Before the first tick every signal is in the "not started" phase
+    assert(obs[2 + 1] == 0.0f && obs[5 + 2 + 1] == 0.0f);
+    assert(obs[1] == 0.0f); // Padding slot of the one-approach intersection
+
+    std::vector<int> keep = {0, 0};
+    float reward = env.step(keep.data(), obs.data());
+    assert(reward <= 0.0f);
+    assert(obs[5 + 2] == 0.0f);     // Intersection 2: approach 21 is green
+    assert(obs[5 + 2 + 1] == 1.0f); // GREEN
+    assert(obs[5 + 2 + 2] == 0.0f);
+
+    env.step(keep.data(), obs.data());
+    assert(obs[5 + 2 + 2] == 1.0f);
+
+    // Switching ends intersection 2's green immediately
+    std::vector<int> switch_second = {0, 1};
+    env.step(switch_second.data(), obs.data());
+    assert(obs[5 + 2 + 1] == 2.0f); // YELLOW
+    assert(obs[5 + 2 + 2] == 1.0f);
+    assert(obs[2 + 1] == 1.0f); // Intersection 1 is unaffected
+    std::cout << "test_observation_layout_and_actions PASSED." << std::endl;
+}
+
+void test_copied_environment_steps_independently()
+{
+    std::cout << "Running test_copied_environment_steps_independently..." << std::endl;
+    Simulation prototype(3);
+    setup_line_network(prototype);
+
+    TrafficEnvironment original(prototype);
+    std::vector<float> obs(original.observation_size());
+    original.reset(11, obs.data());
+    std::vector<int> keep = {0, 0};
+    original.step(keep.data(), obs.data());
+
+    std::vector<float> copy_obs(original.observation_size());
+    {
+        TrafficEnvironment copy(original);
+        // Switching in the copy ends its own green, not the original's
+        std::vector<int> switch_second = {0, 1};
+        copy.step(switch_second.data(), copy_obs.data());
+        assert(copy_obs[5 + 2 + 1] == 2.0f); // YELLOW
+        original.step(keep.data(), obs.data());
+        assert(obs[5 + 2 + 1] == 1.0f && obs[5 + 2 + 2] == 1.0f); // Still GREEN, one tick further
+        assert(copy.get_simulation().get_current_tick() == 2 && original.get_simulation().get_current_tick() == 2);
+    }
+
+    // The original keeps stepping after its copy is gone
+    original.step(keep.data(), obs.data());
+    assert(obs[5 + 2 + 1] == 1.0f && obs[5 + 2 + 2] == 2.0f);
+    TrafficEnvironment copy(original);
+    copy.write_observation(copy_obs.data());
+    assert(copy_obs == obs);
+    std::cout << "test_copied_environment_steps_independently PASSED." << std::endl;
+}
+
+void test_batch_environment_lockstep()
+{
+    std::cout << "Running test_batch_environment_lockstep..." << std::endl;
+    Simulation prototype(3);
+    setup_line_network(prototype);
+
+    const size_t num_envs = 4;
+    BatchEnvironment batch(prototype, num_envs, 5, 2);
+    assert(batch.num_envs() == num_envs);
+    const size_t obs_size = batch.observation_size();
+    const size_t act_size = batch.action_size();
+
+    std::vector<float> observations(num_envs * obs_size);
+    std::vector<float> rewards(num_envs);
+    std::vector<int> actions(num_envs * act_size, 0);
+    batch.reset(100, observations.data());
+
+    // A standalone environment with the same seed must match batch member 2 exactly
+    TrafficEnvironment reference(prototype, 5);
+    std::vector<float> reference_obs(obs_size);
+    reference.reset(102, reference_obs.data());
+
+    for (int step = 0; step < 40; ++step)
+    {
+        actions[2 * act_size + 1] = (step % 7 == 0) ? 1 : 0;
+        batch.step(actions.data(), observations.data(), rewards.data());
+        float reference_reward = reference.step(actions.data() + 2 * act_size, reference_obs.data());
+        assert(rewards[2] == reference_reward);
+        for (size_t i = 0; i < obs_size; ++i)
+        {
+            assert(observations[2 * obs_size + i] == reference_obs[i]);
+        }
+    }
+    assert(batch.get_env(0).get_simulation().get_current_tick() == 200);
+
+    batch.reset_env(1, 7, observations.data());
+    assert(batch.get_env(1).get_simulation().get_current_tick() == 0);
+    assert(batch.get_env(0).get_simulation().get_current_tick() == 200);
+    std::cout << "test_batch_environment_lockstep PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Environment tests (test_environment.cpp)..." << std::endl;
+    test_observation_layout_and_actions();
+    test_copied_environment_steps_independently();
+    test_batch_environment_lockstep();
+    std::cout << "All Environment tests PASSED." << std::endl;
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <algorithm> // For std::equal
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdio> // For std::remove
+#include <zlib.h>
+#include "frame_renderer.hpp"
+#include "network_generator.hpp"
+#include "simulation.hpp"
+#include "trajectory_recorder.hpp"
+#include "trajectory_replay.hpp"
+
+namespace
+{
+    bool same_color(const std::uint8_t *pixel, Rgba color)
+    {
+        return pixel[0] == color.r && pixel[1] == color.g && pixel[2] == color.b;
+    }
+
+    std::string read_file(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    std::uint32_t read_u32(const std::string &bytes, std::size_t at)
+    {
+        return (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[at])) << 24) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[at + 1])) << 16) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[at + 2])) << 8) |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[at + 3]));
+    }
+
+    // One road from (0, 0) to (200, 0), a green signal at node 1 and a vehicle at (60, 0)
+    StateSnapshot line_scene(Graph &graph)
+    {
+        graph.add_node(1, 0.0, 0.0);
+        graph.add_node(2, 200.0, 0.0);
+        graph.add_edge(10, 1, 2, 1.0);
+        StateSnapshot snapshot;
+        snapshot.vehicles.push_back({7, 10, 60.f, 0.f});
+        snapshot.signals.push_back({1, 0.f, 0.f, true, LightState::GREEN});
+        return snapshot;
+    }
+}
+
+void test_renders_the_scene()
+{
+    std::cout << "Running test_renders_the_scene..." << std::endl;
+    Graph graph;
+    StateSnapshot snapshot = line_scene(graph);
+    // 1 pixel per unit: pixel (x, y) covers graph (x - 20 .. x - 19, y - 20 .. y - 19)
+    FrameRenderer renderer(graph, 240, 40, 2);
+    renderer.set_view(BoundingBox{-20.0, -20.0, 220.0, 20.0});
+    const Framebuffer &frame = renderer.render(snapshot);
+    assert(frame.width == 240 && frame.height == 40 && frame.pixels.size() == 240 * 40 * 3);
+
+    assert(same_color(frame.pixel(170, 20), RenderStyle::ROAD_COLOR));
+    assert(same_color(frame.pixel(170, 10), RenderStyle::BACKGROUND_COLOR)); // 10 units off the road
+    assert(same_color(frame.pixel(80, 20), RenderStyle::VEHICLE_COLOR));
+    assert(same_color(frame.pixel(20, 20), RenderStyle::INTERSECTION_COLOR)); // Covers the node
+    assert(same_color(frame.pixel(220, 20), RenderStyle::NODE_COLOR));         // Node 2 has no signal
+    assert(same_color(frame.pixel(239, 0), RenderStyle::BACKGROUND_COLOR));
+    // The ring is the signal's color, blended over what is beneath
+    const std::uint8_t *ring = frame.pixel(20, 36);
+    assert(ring[1] > 150 && ring[0] < 60 && ring[2] < 60);
+
+    // A red light, and the framebuffer is reused
+    snapshot.signals[0].state = LightState::RED;
+    const std::uint8_t *before = frame.pixels.data();
+    renderer.render(snapshot);
+    assert(frame.pixels.data() == before);
+    ring = frame.pixel(20, 36);
+    assert(ring[0] > 150 && ring[1] < 60);
+    std::cout << "test_renders_the_scene PASSED." << std::endl;
+}
+
+void test_image_does_not_depend_on_threads()
+{
+    std::cout << "Running test_image_does_not_depend_on_threads..." << std::endl;
+    Simulation sim(5);
+    NetworkGenerator::install(sim, NetworkGenerator::make_random_geometric(300, 4.0, 5));
+    NetworkGenerator::add_vehicles(sim, 2000, 5);
+    for (int t = 0; t < 30; ++t)
+        sim.tick();
+    StateSnapshot snapshot;
+    snapshot.capture(sim, sim.get_graph());
+    assert(!snapshot.vehicles.empty());
+
+    FrameRenderer single(sim.get_graph(), 333, 211, 1);
+    FrameRenderer several(sim.get_graph(), 333, 211, 4);
+    assert(single.render(snapshot).pixels == several.render(snapshot).pixels);
+    // Zoomed in on a corner (culled) as well
+    single.set_view(BoundingBox{100.0, 100.0, 300.0, 250.0});
+    several.set_view(BoundingBox{100.0, 100.0, 300.0, 250.0});
+    assert(single.render(snapshot).pixels == several.render(snapshot).pixels);
+    std::cout << "test_image_does_not_depend_on_threads PASSED." << std::endl;
+}
+
+void test_density_map_when_zoomed_out()
+{
+    std::cout << "Running test_density_map_when_zoomed_out..." << std::endl;
+    Graph graph;
+    StateSnapshot snapshot = line_scene(graph);
+    // 0.1 pixel per unit: vehicles and nodes are sub-pixel
+    FrameRenderer renderer(graph, 60, 20, 1);
+    renderer.set_view(BoundingBox{-100.0, -100.0, 500.0, 100.0});
+    const Framebuffer &frame = renderer.render(snapshot);
+    int vehicle_pixels = 0, density_pixels = 0;
+    const Rgba light_traffic = RenderStyle::density_color(1.f / (200.f / RenderStyle::JAM_SPACING));
+    for (int y = 0; y < frame.height; ++y)
+    {
+        for (int x = 0; x < frame.width; ++x)
+        {
+            vehicle_pixels += same_color(frame.pixel(x, y), RenderStyle::VEHICLE_COLOR);
+            density_pixels += same_color(frame.pixel(x, y), light_traffic);
+        }
+    }
+    assert(vehicle_pixels == 0);
+    assert(density_pixels >= 15); // The 20-pixel road, at least 2 pixels wide
+    std::cout << "test_density_map_when_zoomed_out PASSED." << std::endl;
+}
+
+void test_replayed_run_has_density()
+{
+    std::cout << "Running test_replayed_run_has_density..." << std::endl;
+    const std::string path = "test_temp_render_replay.bin";
+    Simulation sim(5);
+    NetworkGenerator::install(sim, NetworkGenerator::make_grid(5, 5));
+    NetworkGenerator::add_vehicles(sim, 300, 5);
+    TrajectoryRecorder recorder;
+    assert(recorder.open(path, TrajectoryRecorder::DEFAULT_KEYFRAME_INTERVAL, 32)); // Room for every frame
+    for (int t = 0; t < 20; ++t)
+    {
+        sim.tick();
+        assert(recorder.record(sim));
+    }
+    recorder.close();
+    StateSnapshot live;
+    live.capture(sim, sim.get_graph());
+
+    // The log has no edge ids; capture finds each replayed vehicle's edge from its nodes
+    TrajectoryReplay replay;
+    assert(replay.open(path) && replay.seek(20));
+    StateSnapshot replayed;
+    replayed.capture(replay, sim.get_graph());
+    assert(!live.vehicles.empty() && replayed.vehicles.size() == live.vehicles.size());
+    for (std::size_t i = 0; i < live.vehicles.size(); ++i)
+        assert(replayed.vehicles[i].edge_id == live.vehicles[i].edge_id && live.vehicles[i].edge_id >= 0);
+
+    // Zoomed out, the replay draws the same density map as the live run
+    FrameRenderer renderer(sim.get_graph(), 40, 40, 1);
+    renderer.set_view(BoundingBox{-1000.0, -1000.0, 1200.0, 1200.0}); // The 200-unit grid in ~4 pixels
+    const std::vector<std::uint8_t> live_pixels = renderer.render(live).pixels;
+    const Framebuffer &frame = renderer.render(replayed);
+    assert(frame.pixels == live_pixels);
+    int traffic_pixels = 0;
+    for (int y = 0; y < frame.height; ++y)
+    {
+        for (int x = 0; x < frame.width; ++x)
+            traffic_pixels += !same_color(frame.pixel(x, y), RenderStyle::BACKGROUND_COLOR) &&
+                              !same_color(frame.pixel(x, y), RenderStyle::ROAD_COLOR);
+    }
+    assert(traffic_pixels > 0);
+    std::remove(path.c_str());
+    std::cout << "test_replayed_run_has_density PASSED." << std::endl;
+}
+
+void test_frame_files()
+{
+    std::cout << "Running test_frame_files..." << std::endl;
+    Graph graph;
+    StateSnapshot snapshot = line_scene(graph);
+    FrameRenderer renderer(graph, 97, 31, 2);
+    const Framebuffer &frame = renderer.render(snapshot);
+    const std::string raw(frame.pixels.begin(), frame.pixels.end());
+
+    assert(write_ppm("test_frame.ppm", frame));
+    assert(read_file("test_frame.ppm") == "P6\n97 31\n255\n" + raw);
+
+    // PNG: signature, IHDR, and IDAT inflating back to Sub-filtered rows of the frame
+    assert(write_png("test_frame.png", frame));
+    std::string png = read_file("test_frame.png");
+    assert(png.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0);
+    assert(png.compare(12, 4, "IHDR") == 0 && read_u32(png, 16) == 97 && read_u32(png, 20) == 31);
+    assert(png[24] == 8 && png[25] == 2);
+    std::string idat;
+    for (std::size_t at = 8; at + 8 <= png.size();)
+    {
+        const std::uint32_t length = read_u32(png, at);
+        const std::string type = png.substr(at + 4, 4);
+        const std::string data = png.substr(at + 8, length);
+        const std::uint32_t crc = read_u32(png, at + 8 + length);
+        uLong expected = crc32(0L, Z_NULL, 0);
+        expected = crc32(expected, reinterpret_cast<const Bytef *>(png.data() + at + 4), length + 4);
+        assert(crc == expected);
+        if (type == "IDAT")
+            idat += data;
+        at += 12 + length;
+        if (type == "IEND")
+            assert(at == png.size());
+    }
+    std::vector<std::uint8_t> rows((97 * 3 + 1) * 31);
+    uLongf rows_size = static_cast<uLongf>(rows.size());
+    assert(uncompress(rows.data(), &rows_size, reinterpret_cast<const Bytef *>(idat.data()),
+                      static_cast<uLong>(idat.size())) == Z_OK);
+    assert(rows_size == rows.size());
+    for (int y = 0; y < 31; ++y)
+    {
+        const std::uint8_t *row = rows.data() + (97 * 3 + 1) * y;
+        assert(row[0] == 1); // Sub
+        std::vector<std::uint8_t> decoded(97 * 3);
+        for (int i = 0; i < 97 * 3; ++i)
+            decoded[i] = static_cast<std::uint8_t>(row[1 + i] + (i >= 3 ? decoded[i - 3] : 0));
+        assert(std::equal(decoded.begin(), decoded.end(), frame.pixel(0, y)));
+    }
+
+    // Raw video: frames back to back, one size only
+    RawVideoWriter video;
+    assert(video.open("test_frames.rgb"));
+    assert(video.write(frame) && video.write(frame) && video.write(frame));
+    Framebuffer other;
+    other.resize(10, 10);
+    assert(!video.write(other));
+    assert(video.close() && video.get_frames_written() == 3 && !video.is_open());
+    assert(read_file("test_frames.rgb") == raw + raw + raw);
+
+    std::remove("test_frame.ppm");
+    std::remove("test_frame.png");
+    std::remove("test_frames.rgb");
+    std::cout << "test_frame_files PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Frame Renderer tests (test_frame_renderer.cpp)..." << std::endl;
+    test_renders_the_scene();
+    test_image_does_not_depend_on_threads();
+    test_density_map_when_zoomed_out();
+    test_replayed_run_has_density();
+    test_frame_files();
+    std::cout << "All Frame Renderer tests PASSED." << std::endl;
+    return 0;
+}
@@ -193,6 +193,48 @@ void test_intersection_no_approaches() {
     std::cout << "test_intersection_no_approaches PASSED." << std::endl;
 }
 
+void test_timing_plan_durations_and_offset() {
+    std::cout << "Running test_timing_plan_durations_and_offset..." << std::endl;
+    std::vector<int> approaches = {10, 20};
+    SignalTimingPlan plan;
+    plan.intersection_id = 1;
+    plan.yellow_duration = 2;
+    plan.green_durations[10] = 4;
+    plan.green_durations[20] = 6;
+    plan.green_durations[99] = 8; // Not an approach of this intersection, ignored
+
+    Intersection intersection(1, approaches);
+    intersection.set_timing_plan(plan);
+    assert(intersection.get_green_duration(10) == 4);
+    assert(intersection.get_green_duration(20) == 6);
+    assert(intersection.get_green_duration(99) == Intersection::GREEN_DURATION);
+    assert(intersection.get_yellow_duration() == 2);
+
+    intersection.update_signal_state();
+    for (int i = 0; i < 3; ++i) {
+        intersection.update_signal_state();
+        assert(intersection.get_signal_state(10) == LightState::GREEN);
+    }
+    intersection.update_signal_state();
+    assert(intersection.get_signal_state(10) == LightState::YELLOW);
+    intersection.update_signal_state();
+    assert(intersection.get_signal_state(10) == LightState::YELLOW);
+    intersection.update_signal_state();
+    assert(intersection.get_signal_state(10) == LightState::RED);
+    assert(intersection.get_signal_state(20) == LightState::GREEN);
+
+    // An offset of 5 ticks starts the cycle one tick into the first yellow
+    plan.offset = 5;
+    Intersection shifted(2, approaches);
+    shifted.set_timing_plan(plan);
+    shifted.update_signal_state();
+    assert(shifted.get_signal_state(10) == LightState::YELLOW);
+    shifted.update_signal_state();
+    assert(shifted.get_signal_state(20) == LightState::GREEN);
+
+    std::cout << "test_timing_plan_durations_and_offset PASSED." << std::endl;
+}
+
 
 int main() {
     std::cout << "Starting Intersection tests (test_intersection.cpp)..." << std::endl;
@@ -200,6 +242,7 @@ int main() {
     test_vehicle_queuing();
     test_signal_cycling();
     test_intersection_no_approaches();
+    test_timing_plan_durations_and_offset();
     std::cout << "All Intersection tests PASSED." << std::endl;
     return 0;
 }
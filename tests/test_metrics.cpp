@@ -0,0 +1,253 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <cmath>     // For std::fabs
+#include <algorithm> // For std::shuffle
+#include <random>
+#include "quantile_sketch.hpp"
+#include "metrics.hpp"
+#include "profiler.hpp"
+#include "simulation.hpp"
+
+void test_tdigest_quantiles_are_accurate_and_bounded()
+{
+    std::cout << "Running test_tdigest_quantiles_are_accurate_and_bounded..." << std::endl;
+    TDigest empty;
+    assert(empty.empty() && empty.quantile(0.5) == 0.0);
+
+    const int n = 100000;
+    std::vector<double> values(n);
+    for (int i = 0; i < n; ++i)
+        values[i] = i;
+    std::mt19937 rng(3);
+    std::shuffle(values.begin(), values.end(), rng);
+
+    TDigest digest;
+    for (double value : values)
+        digest.add(value);
+    assert(digest.get_count() == n);
+    assert(digest.get_min() == 0 && digest.get_max() == n - 1);
+    assert(digest.quantile(0.0) == 0 && digest.quantile(1.0) == n - 1);
+    // Rank error shrinks towards the tails
+    assert(std::fabs(digest.quantile(0.5) - 0.5 * n) < 0.01 * n);
+    assert(std::fabs(digest.quantile(0.95) - 0.95 * n) < 0.005 * n);
+    assert(std::fabs(digest.quantile(0.99) - 0.99 * n) < 0.002 * n);
+    // Memory is bounded by the compression, not by the number of values
+    assert(digest.get_centroid_count() <= static_cast<std::size_t>(digest.get_compression()));
+
+    // A handful of values is reproduced exactly at its ranks
+    TDigest few;
+    for (int value : {10, 20, 30})
+        few.add(value);
+    assert(few.quantile(0.5) == 20 && few.get_min() == 10 && few.get_max() == 30);
+    std::cout << "test_tdigest_quantiles_are_accurate_and_bounded PASSED." << std::endl;
+}
+
+void test_tdigest_merge_matches_single_digest()
+{
+    std::cout << "Running test_tdigest_merge_matches_single_digest..." << std::endl;
+    // Skewed data, like travel times: most trips short, a long tail
+    std::mt19937 rng(11);
+    std::exponential_distribution<double> travel(1.0 / 200.0);
+    TDigest whole;
+    std::vector<TDigest> parts(4);
+    for (int i = 0; i < 80000; ++i)
+    {
+        double value = travel(rng);
+        whole.add(value);
+        parts[i % 4].add(value);
+    }
+    TDigest merged;
+    for (const TDigest &part : parts)
+        merged.merge(part);
+    assert(merged.get_count() == whole.get_count());
+    assert(merged.get_min() == whole.get_min() && merged.get_max() == whole.get_max());
+    for (double q : {0.5, 0.95, 0.99})
+    {
+        // Exponential quantile: -mean * ln(1 - q)
+        double exact = -200.0 * std::log(1.0 - q);
+        assert(std::fabs(merged.quantile(q) - exact) < 0.03 * exact);
+        assert(std::fabs(merged.quantile(q) - whole.quantile(q)) < 0.02 * exact);
+    }
+    std::cout << "test_tdigest_merge_matches_single_digest PASSED." << std::endl;
+}
+
+void setup_line_network(Simulation &sim)
+{
+    Graph g;
+    g.add_node(1, 100, 100);
+    g.add_node(2, 200, 100);
+    g.add_node(3, 300, 100);
+    g.add_edge(12, 1, 2, 3);
+    g.add_edge(23, 2, 3, 4);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(1, {12}));
+    sim.add_intersection(Intersection(2, {23}));
+}
+
+void test_simulation_distributions_by_od_and_approach()
+{
+    std::cout << "Running test_simulation_distributions_by_od_and_approach..." << std::endl;
+    TripDistributions combined;
+    for (int replica = 0; replica < 2; ++replica)
+    {
+        Simulation sim(replica);
+        setup_line_network(sim);
+        sim.set_metrics_enabled(true);
+        for (int id : {1, 2})
+        {
+            Vehicle car(id, 1, 3);
+            car.plan_route(sim.get_graph());
+            sim.add_vehicle(car);
+        }
+        Vehicle short_trip(3, 2, 3);
+        short_trip.plan_route(sim.get_graph());
+        sim.add_vehicle(short_trip);
+
+        for (int t = 0; t < 12; ++t)
+            sim.tick();
+        TripDistributions distributions = sim.get_metrics()->get_distributions();
+        const TDigest &long_trips = distributions.travel_time_by_od.at({1, 3});
+        assert(long_trips.get_count() == 2 && long_trips.quantile(0.5) == 7);
+        assert(distributions.travel_time_by_od.at({2, 3}).get_count() == 1);
+        // Only vehicles queued at node 2 contribute approach delays
+        assert(distributions.delay_by_approach.size() == 1);
+        assert(distributions.delay_by_approach.at(23).get_count() == 2);
+        assert(distributions.delay_by_approach.at(23).get_max() == 1);
+        assert(distributions.get_network_travel_time().get_count() == 3);
+        combined.merge(distributions);
+    }
+    assert(combined.travel_time_by_od.at({1, 3}).get_count() == 4);
+    assert(combined.get_network_travel_time().get_count() == 6);
+    std::cout << "test_simulation_distributions_by_od_and_approach PASSED." << std::endl;
+}
+
+void test_metrics_enabled_mid_run_count_vehicles_under_way()
+{
+    std::cout << "Running test_metrics_enabled_mid_run_count_vehicles_under_way..." << std::endl;
+    // Enabled after tick 1 both cars are on edge 12; after tick 3 both are queued for edge 23
+    for (int enable_tick : {1, 3})
+    {
+        Simulation sim(1);
+        setup_line_network(sim);
+        sim.set_spawn_interval(0);
+        for (int id : {1, 2})
+        {
+            Vehicle car(id, 1, 3);
+            car.plan_route(sim.get_graph());
+            sim.add_vehicle(car);
+        }
+        for (int t = 0; t < enable_tick; ++t)
+            sim.tick();
+        sim.set_metrics_enabled(true);
+        MetricsSnapshot snapshot = sim.get_metrics()->snapshot();
+        const EdgeMetrics *start_edge = snapshot.find_edge(12);
+        const EdgeMetrics *approach = snapshot.find_edge(23);
+        if (enable_tick == 1)
+            assert(start_edge->occupancy == 2 && start_edge->max_occupancy == 2 && approach->queue_length == 0);
+        else
+            assert(start_edge->occupancy == 0 && approach->queue_length == 2 && approach->max_queue_length == 2);
+
+        for (int t = enable_tick; t < 12; ++t)
+        {
+            sim.tick();
+            snapshot = sim.get_metrics()->snapshot();
+            for (const EdgeMetrics &edge : snapshot.edges)
+                assert(edge.occupancy >= 0 && edge.queue_length >= 0 && edge.mean_occupancy >= 0.0);
+        }
+        assert(sim.get_vehicles().empty() && snapshot.trips_completed == 2);
+        for (const EdgeMetrics &edge : snapshot.edges)
+            assert(edge.occupancy == 0 && edge.queue_length == 0 && edge.max_occupancy <= 2);
+        assert(snapshot.find_edge(23)->vehicles_discharged == 2 && snapshot.find_edge(23)->vehicles_exited == 2);
+    }
+    std::cout << "test_metrics_enabled_mid_run_count_vehicles_under_way PASSED." << std::endl;
+}
+
+void test_latency_histogram_percentiles_within_precision()
+{
+    std::cout << "Running test_latency_histogram_percentiles_within_precision..." << std::endl;
+    LatencyHistogram empty;
+    assert(empty.get_count() == 0 && empty.percentile(0.99) == 0);
+
+    // 1 .. 100000 ns: every percentile lands within the 1/32 bucket precision
+    LatencyHistogram histogram;
+    const std::uint64_t n = 100000;
+    for (std::uint64_t value = 1; value <= n; ++value)
+        histogram.record(value);
+    assert(histogram.get_count() == n && histogram.get_min() == 1 && histogram.get_max() == n);
+    assert(histogram.get_total() == n * (n + 1) / 2);
+    for (double q : {0.5, 0.9, 0.99, 0.999})
+    {
+        double exact = q * n;
+        assert(std::fabs(static_cast<double>(histogram.percentile(q)) - exact) <= exact / 32.0);
+    }
+    assert(histogram.percentile(0.0) == 1 && histogram.percentile(1.0) == n);
+    // Small values are exact, huge ones are clamped into the top bucket but max stays exact
+    LatencyHistogram small;
+    for (std::uint64_t value : {3, 5, 7})
+        small.record(value);
+    assert(small.percentile(0.5) == 5);
+    small.record(std::uint64_t(1) << 50);
+    assert(small.get_max() == std::uint64_t(1) << 50 && small.percentile(1.0) == small.get_max());
+
+    LatencyHistogram merged(small);
+    merged.merge(histogram);
+    assert(merged.get_count() == n + 4 && merged.get_min() == 1 && merged.get_max() == small.get_max());
+    std::cout << "test_latency_histogram_percentiles_within_precision PASSED." << std::endl;
+}
+
+void test_simulation_profile_covers_every_phase()
+{
+    std::cout << "Running test_simulation_profile_covers_every_phase..." << std::endl;
+    Simulation sim(1);
+    setup_line_network(sim);
+    for (int id : {1, 2, 3})
+    {
+        Vehicle car(id, 1, 3);
+        car.plan_route(sim.get_graph());
+        sim.add_vehicle(car);
+    }
+    sim.set_profiling_enabled(true);
+    for (int t = 0; t < 40; ++t)
+        sim.tick();
+    ProfileReport report = sim.get_profiler()->report();
+    assert(report.phases.size() == static_cast<std::size_t>(TickPhase::COUNT));
+    assert(report.counters.size() == static_cast<std::size_t>(ProfileCounter::COUNT));
+#ifdef TRAFFICSIM_PROFILING
+    assert(report.ticks == 40);
+    std::uint64_t phase_total = 0;
+    for (const PhaseProfile &phase : report.phases)
+    {
+        assert(phase.samples == 40);
+        assert(phase.min_ns <= phase.p50_ns && phase.p50_ns <= phase.p99_ns && phase.p99_ns <= phase.max_ns);
+        phase_total += phase.total_ns;
+    }
+    assert(phase_total <= report.tick.total_ns);
+    // Spawning every 20 ticks plans one route each time
+    assert(report.counters[static_cast<int>(ProfileCounter::ROUTES_COMPUTED)].second == 2);
+    assert(report.counters[static_cast<int>(ProfileCounter::QUEUE_OPERATIONS)].second > 0);
+    assert(report.counters[static_cast<int>(ProfileCounter::MAP_LOOKUPS)].second > 0);
+    assert(report.to_string().find("movement") != std::string::npos);
+#else
+    // Instrumentation compiled out: the profile stays empty
+    assert(report.ticks == 0);
+#endif
+    // Forks don't profile into the parent's profiler
+    assert(!sim.fork().get_profiler());
+    sim.set_profiling_enabled(false);
+    assert(!sim.get_profiler());
+    std::cout << "test_simulation_profile_covers_every_phase PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Metrics tests (test_metrics.cpp)..." << std::endl;
+    test_tdigest_quantiles_are_accurate_and_bounded();
+    test_tdigest_merge_matches_single_digest();
+    test_simulation_distributions_by_od_and_approach();
+    test_metrics_enabled_mid_run_count_vehicles_under_way();
+    test_latency_histogram_percentiles_within_precision();
+    test_simulation_profile_covers_every_phase();
+    std::cout << "All Metrics tests PASSED." << std::endl;
+    return 0;
+}
@@ -0,0 +1,479 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cassert>
+#include <fstream> // For temporary data files
+#include <cstdio>  // For std::remove
+#include <cmath>   // For std::fabs
+#include <chrono>
+#include <thread>  // For std::this_thread::sleep_for
+#include "optimizer.hpp"
+#include "intersection.hpp"
+#include "timing_plan.hpp"
+#include "simulation.hpp"
+
+void test_webster_plan_for_single_intersection()
+{
+    std::cout << "Running test_webster_plan_for_single_intersection..." << std::endl;
+    Intersection intersection(1, {10, 20});
+
+    // Approach 10 carries three times the flow of approach 20
+    std::map<int, ApproachFlow> flows;
+    flows[10].vehicles_passed = 30;
+    flows[10].samples = 100;
+    flows[20].vehicles_passed = 10;
+    flows[20].samples = 100;
+
+    WebsterParameters params;
+    SignalTimingPlan plan = TrafficOptimizer::compute_webster_plan(intersection, flows, params);
+
+    assert(plan.intersection_id == 1);
+    assert(plan.green_durations.size() == 2);
+    assert(plan.green_durations.at(10) > plan.green_durations.at(20));
+    assert(plan.green_durations.at(20) >= params.min_green);
+    assert(plan.cycle_length() >= params.min_cycle);
+    assert(plan.cycle_length() <= params.max_cycle);
+
+    // Oversaturated demand is capped at max_cycle rather than diverging
+    flows[10].vehicles_passed = 500;
+    flows[20].vehicles_passed = 500;
+    SignalTimingPlan saturated = TrafficOptimizer::compute_webster_plan(intersection, flows, params);
+    assert(saturated.cycle_length() == params.max_cycle);
+
+    // No data at all splits the minimum cycle evenly
+    SignalTimingPlan empty = TrafficOptimizer::compute_webster_plan(intersection, {}, params);
+    assert(empty.green_durations.at(10) == empty.green_durations.at(20));
+
+    // Greens raised to min_green are paid for by the busiest approach, keeping the cycle
+    Intersection four_way(2, {10, 20, 30, 40});
+    std::map<int, ApproachFlow> skewed;
+    skewed[10].vehicles_passed = 90;
+    skewed[10].samples = 100;
+    for (int approach_id : {20, 30, 40})
+    {
+        skewed[approach_id].vehicles_passed = 1;
+        skewed[approach_id].samples = 100;
+    }
+    SignalTimingPlan skewed_plan = TrafficOptimizer::compute_webster_plan(four_way, skewed, params);
+    assert(skewed_plan.cycle_length() == params.max_cycle);
+    assert(skewed_plan.green_durations.at(10) == params.max_cycle - 4 * params.yellow_duration - 3 * params.min_green);
+    for (int approach_id : {20, 30, 40})
+        assert(skewed_plan.green_durations.at(approach_id) == params.min_green);
+
+    // Rounding shortfalls are given back: 16 green ticks over three equal phases
+    Intersection three_way(3, {10, 20, 30});
+    WebsterParameters longer_cycle = params;
+    longer_cycle.min_cycle = 25;
+    SignalTimingPlan even = TrafficOptimizer::compute_webster_plan(three_way, {}, longer_cycle);
+    assert(even.cycle_length() == 25);
+    for (const auto &pair : even.green_durations)
+        assert(pair.second == 5 || pair.second == 6);
+    std::cout << "test_webster_plan_for_single_intersection PASSED." << std::endl;
+}
+
+void test_streaming_load_and_parallel_timings()
+{
+    std::cout << "Running test_streaming_load_and_parallel_timings..." << std::endl;
+    std::string csv_path = "test_temp_traffic.csv";
+    std::ofstream outfile(csv_path);
+    outfile << "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+    outfile << "1,12,0.2,50.5,10\n";
+    outfile << "1,14,0.1,60.0,2\n";
+    outfile << "\n";
+    outfile << "2,12,0.3,45.0,20\n";
+    outfile << "not,a,valid,row,at all\n";
+    outfile << "2,14,0.1,60.0,4\n";
+    outfile.close();
+
+    TrafficOptimizer optimizer;
+    assert(optimizer.load_traffic_data_file(csv_path));
+    std::remove(csv_path.c_str());
+
+    // Rows are folded into totals, never stored
+    assert(optimizer.get_traffic_data().empty());
+    const auto &flows = optimizer.get_approach_flows();
+    assert(flows.size() == 2);
+    assert(flows.at(12).vehicles_passed == 30 && flows.at(12).samples == 2);
+    assert(flows.at(14).vehicles_passed == 6 && flows.at(14).samples == 2);
+    assert(!optimizer.load_traffic_data_file("does_not_exist.csv"));
+
+    std::map<int, Intersection> intersections;
+    intersections.emplace(1, Intersection(1, {12, 14}));
+    intersections.emplace(2, Intersection(2, {21, 23, 25}));
+    intersections.emplace(3, Intersection(3, {}));
+
+    WebsterParameters params;
+    params.ticks_per_sample = 60.0; // Each row covers a minute of ticks
+    params.num_threads = 2;
+    std::map<int, SignalTimingPlan> plans = optimizer.compute_webster_timings(intersections, params);
+    assert(plans.size() == 3);
+    assert(plans.at(1).green_durations.at(12) > plans.at(1).green_durations.at(14));
+    assert(plans.at(2).green_durations.size() == 3);
+    assert(plans.at(3).green_durations.empty());
+    std::cout << "test_streaming_load_and_parallel_timings PASSED." << std::endl;
+}
+
+void test_timing_plan_file_round_trip()
+{
+    std::cout << "Running test_timing_plan_file_round_trip..." << std::endl;
+    std::map<int, SignalTimingPlan> plans;
+    SignalTimingPlan plan;
+    plan.intersection_id = 2;
+    plan.offset = 7;
+    plan.yellow_duration = 4;
+    plan.green_durations[21] = 12;
+    plan.green_durations[23] = 9;
+    plans[2] = plan;
+
+    std::string plan_path = "test_temp_plans.txt";
+    assert(save_timing_plans(plan_path, plans));
+
+    std::map<int, SignalTimingPlan> loaded;
+    assert(load_timing_plans(plan_path, loaded));
+    assert(loaded.size() == 1);
+    assert(loaded.at(2).offset == 7 && loaded.at(2).yellow_duration == 4);
+    assert(loaded.at(2).green_durations == plan.green_durations);
+
+    // The simulation applies the loaded set to its intersections
+    Simulation sim;
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 0, 0);
+    g.add_node(3, 0, 0);
+    g.add_edge(21, 2, 1, 5);
+    g.add_edge(23, 2, 3, 5);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(2, {21, 23}));
+    assert(sim.load_timing_plans(plan_path));
+    std::remove(plan_path.c_str());
+
+    const Intersection &intersection = sim.get_intersections().at(2);
+    assert(intersection.get_green_duration(21) == 12);
+    assert(intersection.get_green_duration(23) == 9);
+    assert(intersection.get_yellow_duration() == 4);
+
+    std::ofstream bad_file(plan_path);
+    bad_file << "G 21 12\n"; // Green line without a preceding plan
+    bad_file.close();
+    assert(!load_timing_plans(plan_path, loaded));
+    std::remove(plan_path.c_str());
+    std::cout << "test_timing_plan_file_round_trip PASSED." << std::endl;
+}
+
+void test_history_store_queries()
+{
+    std::cout << "Running test_history_store_queries..." << std::endl;
+    TrafficHistoryStore store;
+    // Three blocks' worth of 5-tick samples on edge 12, plus a little data on edge 13
+    const int rows = 2500;
+    for (int i = 0; i < rows; ++i)
+    {
+        store.append({i * 5, 12, (i % 4) * 0.25, 40.0 + (i % 3), i % 7});
+    }
+    store.append({30, 13, 0.5, 30.0, 3});
+    store.append({10, 13, 0.1, 50.0, 1}); // Out of order
+    store.append({20, 13, 0.3, 40.0, 2});
+
+    assert(store.size() == rows + 3);
+    assert(store.get_row_count(12) == static_cast<size_t>(rows));
+    assert(store.get_edge_ids() == std::vector<int>({12, 13}));
+    // Delta/varint encoding of the integer columns beats storing the raw structs
+    assert(store.memory_bytes() < (rows + 3) * sizeof(TrafficDataPoint) * 2 / 3);
+
+    // Range queries decode only what they need and return rows in time order
+    std::vector<TrafficDataPoint> range = store.query_range(12, 5100, 5200);
+    assert(range.size() == 21);
+    assert(range.front().timestamp == 5100 && range.back().timestamp == 5200);
+    assert(range[3].vehicles_passed == (1020 + 3) % 7);
+    assert(std::fabs(range[1].density - ((1021 % 4) * 0.25)) < 1e-6);
+    assert(store.query_range(12, -100, -1).empty());
+    assert(store.query_range(99, 0, 100).empty());
+
+    std::vector<TrafficDataPoint> unordered = store.query_range(13, 0, 100);
+    assert(unordered.size() == 3);
+    assert(unordered[0].timestamp == 10 && unordered[1].timestamp == 20 && unordered[2].timestamp == 30);
+
+    // Rolling mean over a 20-tick window (four samples), including lookback before the range
+    std::vector<TrafficSeriesPoint> rolling = store.rolling_mean(12, TrafficMetric::DENSITY, 20, 100, 115);
+    assert(rolling.size() == 4);
+    for (const TrafficSeriesPoint &point : rolling)
+    {
+        assert(std::fabs(point.value - 0.375) < 1e-6); // Mean of 0, .25, .5, .75
+    }
+
+    double median = 0.0;
+    assert(store.percentile(13, TrafficMetric::AVERAGE_SPEED, 50.0, 0, 100, median) && median == 40.0);
+    double max_count = 0.0;
+    assert(store.percentile(12, TrafficMetric::VEHICLES_PASSED, 100.0, 0, 100000, max_count) && max_count == 6.0);
+    assert(!store.percentile(12, TrafficMetric::DENSITY, 50.0, -10, -1, median));
+
+    // 100-tick buckets hold 20 samples each
+    std::vector<TrafficBucket> buckets = store.downsample(12, 100, 0, 999);
+    assert(buckets.size() == 10);
+    assert(buckets[0].start_timestamp == 0 && buckets[9].start_timestamp == 900);
+    assert(buckets[0].sample_count == 20);
+    assert(std::fabs(buckets[0].mean_density - 0.375) < 1e-6);
+
+    // The optimizer keeps loaded data in the store
+    TrafficOptimizer optimizer;
+    optimizer.load_traffic_data({{1, 12, 0.2, 50.0, 10}, {2, 12, 0.4, 45.0, 12}, {1, 21, 0.1, 60.0, 5}});
+    assert(optimizer.get_history().size() == 3);
+    assert(optimizer.get_traffic_data().size() == 3);
+    assert(optimizer.get_history().query_range(12, 2, 2).size() == 1);
+
+    // Loaded values come back exactly, including ones float32 can't represent
+    std::vector<TrafficDataPoint> loaded = {{1, 12, 0.1, 1.0 / 3.0, 10},
+                                            {2, 12, 0.123456789012345, 47.000000001, 12},
+                                            {1, 21, 1e-12, 88.8, 5}};
+    optimizer.load_traffic_data(loaded);
+    std::vector<TrafficDataPoint> returned = optimizer.get_traffic_data();
+    assert(returned.size() == loaded.size());
+    for (std::size_t i = 0; i < loaded.size(); ++i)
+    {
+        assert(returned[i].timestamp == loaded[i].timestamp && returned[i].edge_id == loaded[i].edge_id);
+        assert(returned[i].density == loaded[i].density && returned[i].average_speed == loaded[i].average_speed);
+        assert(returned[i].vehicles_passed == loaded[i].vehicles_passed);
+    }
+    std::cout << "test_history_store_queries PASSED." << std::endl;
+}
+
+// Two-by-two grid of two-way roads with a signal at every node
+void setup_square_network(Simulation &sim)
+{
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 100, 0);
+    g.add_node(3, 0, 100);
+    g.add_node(4, 100, 100);
+    g.add_edge(12, 1, 2, 8);
+    g.add_edge(21, 2, 1, 8);
+    g.add_edge(13, 1, 3, 6);
+    g.add_edge(31, 3, 1, 6);
+    g.add_edge(24, 2, 4, 6);
+    g.add_edge(42, 4, 2, 6);
+    g.add_edge(34, 3, 4, 8);
+    g.add_edge(43, 4, 3, 8);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(1, {12, 13}));
+    sim.add_intersection(Intersection(2, {21, 24}));
+    sim.add_intersection(Intersection(3, {31, 34}));
+    sim.add_intersection(Intersection(4, {42, 43}));
+}
+
+void test_genetic_signal_timing_search()
+{
+    std::cout << "Running test_genetic_signal_timing_search..." << std::endl;
+    Simulation base(7);
+    setup_square_network(base);
+
+    TimingSearchParameters params;
+    params.population_size = 6;
+    params.generations = 3;
+    params.rollout_ticks = 200;
+    params.rollout_seeds = {1, 2};
+    params.num_threads = 2;
+
+    SignalTimingSearch search(base, params);
+    TimingSearchResult result = search.run();
+    assert(result.best_plans.size() == 4);
+    assert(result.best_fitness_per_generation.size() == 3);
+    for (size_t i = 1; i < result.best_fitness_per_generation.size(); ++i)
+    {
+        assert(result.best_fitness_per_generation[i] <= result.best_fitness_per_generation[i - 1]);
+    }
+    assert(result.cache_hits > 0); // Elites are never re-simulated
+    for (const auto &pair : result.best_plans)
+    {
+        for (const auto &green : pair.second.green_durations)
+        {
+            assert(green.second >= params.min_green && green.second <= params.max_green);
+        }
+    }
+
+    // Re-evaluating the best plan is served from the cache
+    size_t cached = search.cache_size();
+    assert(search.evaluate(result.best_plans) == result.best_fitness);
+    assert(search.cache_size() == cached);
+
+    // Fixed seeds make the search reproducible
+    SignalTimingSearch repeat(base, params);
+    assert(repeat.run().best_fitness == result.best_fitness);
+
+    // The optimizer keeps the winning plan for per-intersection suggestions
+    TrafficOptimizer optimizer;
+    assert(optimizer.suggest_new_signal_timings(1).empty());
+    optimizer.search_signal_timings(base, params);
+    std::map<int, int> timings = optimizer.suggest_new_signal_timings(1);
+    assert(timings.size() == 2 && timings.count(12) && timings.count(13));
+    assert(optimizer.get_suggested_plans().size() == 4);
+    std::cout << "test_genetic_signal_timing_search PASSED." << std::endl;
+}
+
+void test_signal_search_offsets()
+{
+    std::cout << "Running test_signal_search_offsets..." << std::endl;
+    TimingSearchParameters params;
+    params.population_size = 4;
+    params.generations = 2;
+    params.rollout_ticks = 200;
+    params.rollout_seeds = {1, 2};
+    params.num_threads = 2;
+
+    Simulation base(7);
+    setup_square_network(base);
+    std::map<int, SignalTimingPlan> aligned;
+    for (const auto &pair : base.get_intersections())
+    {
+        SignalTimingPlan &plan = aligned[pair.first];
+        plan.intersection_id = pair.first;
+        plan.yellow_duration = params.yellow_duration;
+        for (int approach_id : pair.second.get_approach_ids())
+            plan.green_durations[approach_id] = 12;
+    }
+    std::map<int, SignalTimingPlan> staggered = aligned;
+    staggered[2].offset = 7;
+    staggered[3].offset = 14;
+    staggered[4].offset = 21;
+
+    // From tick 0, offsets shift the signals and change the outcome
+    SignalTimingSearch fresh(base, params);
+    assert(fresh.evaluate(staggered) != fresh.evaluate(aligned));
+    assert(fresh.run().offsets_searched);
+
+    // Once the base has ticked they would change nothing, so they are not searched
+    for (int t = 0; t < 50; ++t)
+        base.tick();
+    SignalTimingSearch running(base, params);
+    assert(running.evaluate(staggered) == running.evaluate(aligned));
+    TimingSearchResult result = running.run({staggered});
+    assert(!result.offsets_searched);
+    for (const auto &pair : result.best_plans)
+        assert(pair.second.offset == 0);
+    std::cout << "test_signal_search_offsets PASSED." << std::endl;
+}
+
+void test_live_feed_follower()
+{
+    std::cout << "Running test_live_feed_follower..." << std::endl;
+    const std::string path = "test_temp_live_feed.csv";
+    std::remove(path.c_str());
+
+    TrafficFeedFollower feed(path, 3);
+    TrafficOptimizer optimizer;
+    optimizer.follow_feed(feed);
+    assert(feed.poll() == 0); // File does not exist yet
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+        out << "1,10,0.1,50,2\n2,10,0.2,40,4\n3,10,0.3"; // Last row is still being written
+    }
+    assert(feed.poll() == 2);
+    EdgeWindowStats stats;
+    assert(feed.get_stats(10, stats) && stats.count == 2);
+    assert(std::fabs(stats.mean_density - 0.15) < 1e-9);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << ",30,6\n4,10,0.4,20,8\n5,20,0.9,10,1\n";
+    }
+    assert(feed.poll() == 3);
+    assert(feed.poll() == 0); // Nothing new
+
+    // Window of 3: edge 10 now holds rows 2..4
+    assert(feed.get_stats(10, stats) && stats.count == 3);
+    assert(std::fabs(stats.mean_density - 0.3) < 1e-9);
+    assert(std::fabs(stats.mean_speed - 30.0) < 1e-9);
+    assert(stats.vehicles_passed == 18 && stats.last_timestamp == 4);
+    assert(feed.get_rows_ingested() == 5);
+
+    // Updates reached the optimizer without it keeping any history
+    assert(optimizer.get_live_conditions().size() == 2);
+    assert(optimizer.get_live_conditions().at(20).count == 1);
+    assert(optimizer.get_approach_flows().at(10).vehicles_passed == 20);
+    assert(optimizer.get_history().size() == 0);
+
+    // A truncated file is followed again from its start
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "6,30,0.5,25,3\n";
+    }
+    assert(feed.poll() == 1);
+    assert(feed.get_all_stats().count(30) == 1);
+
+    // start_at_end skips rows already present, including a half-written one
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "7,30,0.5";
+    }
+    TrafficFeedFollower tail(path, 3, true);
+    assert(tail.poll() == 0);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << ",25,3\n8,40,0.5,25,3\n";
+    }
+    assert(tail.poll() == 1);
+    assert(tail.get_all_stats().count(40) == 1 && tail.get_all_stats().count(30) == 0);
+
+    // Background polling picks up appended rows
+    tail.start(5);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "9,40,0.7,25,3\n";
+    }
+    for (int attempt = 0; attempt < 400 && tail.get_rows_ingested() < 2; ++attempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    tail.stop();
+    assert(!tail.is_running());
+    assert(tail.get_rows_ingested() == 2);
+
+    std::remove(path.c_str());
+    std::cout << "test_live_feed_follower PASSED." << std::endl;
+}
+
+void test_sliding_window_sums_do_not_drift()
+{
+    std::cout << "Running test_sliding_window_sums_do_not_drift..." << std::endl;
+    SlidingWindowAggregator aggregator(3);
+    TrafficDataPoint point;
+    point.edge_id = 7;
+    // Mixed magnitudes make the running += / -= round on almost every sample
+    const double values[] = {1e8 + 0.1, 0.3, 1e-3, 7.7, 1e6 + 0.01};
+    for (int i = 0; i < 10000; ++i)
+    {
+        point.timestamp = i;
+        point.density = values[i % 5];
+        point.average_speed = values[(i + 2) % 5];
+        aggregator.add(point);
+    }
+
+    // After a pass of the ring over zeros the means are exactly zero, not rounding residue
+    point.density = 0.0;
+    point.average_speed = 0.0;
+    for (int i = 0; i < 6; ++i)
+    {
+        aggregator.add(point);
+    }
+    EdgeWindowStats stats;
+    assert(aggregator.get_stats(7, stats) && stats.count == 3);
+    assert(stats.mean_density == 0.0 && stats.mean_speed == 0.0);
+    std::cout << "test_sliding_window_sums_do_not_drift PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Optimizer tests (test_optimizer.cpp)..." << std::endl;
+    test_webster_plan_for_single_intersection();
+    test_streaming_load_and_parallel_timings();
+    test_timing_plan_file_round_trip();
+    test_history_store_queries();
+    test_genetic_signal_timing_search();
+    test_signal_search_offsets();
+    test_live_feed_follower();
+    test_sliding_window_sums_do_not_drift();
+    std::cout << "All Optimizer tests PASSED." << std::endl;
+    return 0;
+}
@@ -2,10 +2,22 @@
 #include <vector>
 #include <cassert>
 #include <map> // For checking vehicle map directly
+#include <memory>
+#include <fstream>
+#include <string>
+#include <cstdio> // For std::remove
+#include <cmath>  // For std::abs
 #include "simulation.hpp"
 #include "graph.hpp"
 #include "vehicle.hpp"
 #include "intersection.hpp"
+#include "network_generator.hpp"
+#include "scenario.hpp"
+#include "ensemble.hpp"
+#include "simulation_thread.hpp"
+#include "triple_buffer.hpp"
+#include <chrono>
+#include <thread>
 
 void test_simulation_creation_and_setup()
 {
@@ -142,12 +154,410 @@ void test_vehicle_spawning_and_despawning()
     std::cout << "test_vehicle_spawning_and_despawning PASSED." << std::endl;
 }
 
+void test_fork_shares_graph_and_diverges()
+{
+    std::cout << "Running test_fork_shares_graph_and_diverges..." << std::endl;
+    Simulation sim(42);
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 0, 0);
+    g.add_node(3, 0, 0);
+    g.add_edge(12, 1, 2, 5);
+    g.add_edge(21, 2, 1, 5);
+    g.add_edge(23, 2, 3, 5);
+    g.add_edge(32, 3, 2, 5);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(2, {21, 23}));
+
+    Vehicle car(500, 1, 3);
+    car.plan_route(sim.get_graph());
+    sim.add_vehicle(car);
+    sim.tick();
+
+    Simulation branch = sim.fork();
+    // Immutable data is shared, not copied
+    assert(&branch.get_graph() == &sim.get_graph());
+    assert(branch.get_vehicle_by_id(500)->get_shared_path() == sim.get_vehicle_by_id(500)->get_shared_path());
+    assert(branch.get_current_tick() == sim.get_current_tick());
+
+    // Ticking the branch leaves the original untouched
+    for (int i = 0; i < 30; ++i)
+        branch.tick();
+    assert(sim.get_current_tick() == 1);
+    assert(sim.get_vehicle_by_id(500)->get_current_edge_progress_ticks() == 1);
+    assert(branch.get_vehicle_by_id(500) == nullptr); // Arrived and despawned in the branch
+
+    // With the same random engine state, original and branch evolve identically
+    for (int i = 0; i < 30; ++i)
+        sim.tick();
+    assert(sim.get_vehicles().size() == branch.get_vehicles().size());
+    for (const auto &pair : sim.get_vehicles())
+    {
+        const Vehicle *other = branch.get_vehicle_by_id(pair.first);
+        assert(other != nullptr);
+        assert(other->get_current_node_id() == pair.second.get_current_node_id());
+        assert(other->get_state() == pair.second.get_state());
+    }
+
+    // A reseeded fork still shares the graph
+    Simulation reseeded = sim.fork(7);
+    assert(&reseeded.get_graph() == &sim.get_graph());
+    std::cout << "test_fork_shares_graph_and_diverges PASSED." << std::endl;
+}
+
+void test_metrics_follow_vehicles_through_network()
+{
+    std::cout << "Running test_metrics_follow_vehicles_through_network..." << std::endl;
+    Simulation sim;
+    Graph g;
+    g.add_node(1, 100, 100);
+    g.add_node(2, 200, 100);
+    g.add_node(3, 300, 100);
+    g.add_edge(12, 1, 2, 3);
+    g.add_edge(23, 2, 3, 4);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(1, {12}));
+    sim.add_intersection(Intersection(2, {23}));
+    assert(sim.get_metrics() == nullptr);
+    sim.set_metrics_enabled(true);
+
+    for (int id : {1, 2})
+    {
+        Vehicle car(id, 1, 3);
+        car.plan_route(sim.get_graph());
+        sim.add_vehicle(car);
+    }
+    std::shared_ptr<const SimulationMetrics> metrics = sim.get_metrics();
+    assert(metrics != nullptr && metrics->snapshot().vehicles_spawned == 2);
+
+    // Both cars start on edge 12 and queue for edge 23 once they reach node 2
+    sim.tick();
+    MetricsSnapshot snapshot = metrics->snapshot();
+    assert(snapshot.tick == 1 && snapshot.ticks_observed == 1);
+    assert(snapshot.find_edge(12)->vehicles_entered == 2 && snapshot.find_edge(12)->occupancy == 2);
+    sim.tick();
+    sim.tick();
+    snapshot = metrics->snapshot();
+    assert(snapshot.find_edge(12)->vehicles_exited == 2 && snapshot.find_edge(12)->occupancy == 0);
+    assert(snapshot.find_edge(23)->queue_length == 2 && snapshot.find_edge(23)->max_queue_length == 2);
+
+    for (int i = 0; i < 7; ++i)
+        sim.tick();
+    snapshot = metrics->snapshot();
+    assert(sim.get_vehicles().empty());
+    assert(snapshot.trips_completed == 2 && snapshot.trips_aborted == 0);
+    assert(snapshot.travel_time_sum == 14 && snapshot.max_travel_time == 7 && snapshot.mean_travel_time == 7.0);
+    assert(snapshot.trip_delay_sum == 2 && snapshot.mean_trip_delay == 1.0);
+    const EdgeMetrics *approach = snapshot.find_edge(23);
+    assert(approach->vehicles_discharged == 2 && approach->queue_length == 0);
+    assert(approach->delay_sum == 2 && approach->max_delay == 1 && approach->mean_delay == 1.0);
+    assert(approach->vehicles_entered == 2 && approach->vehicles_exited == 2 && approach->max_occupancy == 2);
+    // Two vehicles on edge 12 from tick 1 to tick 3, over 10 observed ticks
+    assert(snapshot.find_edge(12)->mean_occupancy == 0.4);
+    assert(snapshot.find_edge(99) == nullptr);
+
+    // Forks and plain copies don't count towards the run; disabling leaves handed-out
+    // metrics readable
+    assert(sim.fork().get_metrics() == nullptr);
+    Simulation copy(sim);
+    assert(copy.get_metrics() == nullptr && copy.get_profiler() == nullptr);
+    Vehicle late(3, 1, 3);
+    late.plan_route(copy.get_graph());
+    copy.add_vehicle(late);
+    copy.tick();
+    Simulation assigned;
+    assigned = sim;
+    assert(assigned.get_metrics() == nullptr && assigned.get_vehicles().empty());
+    assert(metrics->snapshot().vehicles_spawned == 2 && metrics->snapshot().find_edge(12)->vehicles_entered == 2);
+    sim.set_metrics_enabled(false);
+    assert(sim.get_metrics() == nullptr && metrics->snapshot().trips_completed == 2);
+    std::cout << "test_metrics_follow_vehicles_through_network PASSED." << std::endl;
+}
+
+void test_generated_networks_are_routable()
+{
+    std::cout << "Running test_generated_networks_are_routable..." << std::endl;
+    GeneratedNetwork grid = NetworkGenerator::make_grid(4, 5);
+    assert(grid.graph.get_all_nodes().size() == 20);
+    // (rows * (cols - 1) + (rows - 1) * cols) streets, two edges each
+    assert(grid.graph.get_all_edges().size() == 2 * (4 * 4 + 3 * 5));
+    assert(grid.intersections.size() == 20);
+    assert(grid.graph.find_shortest_path(1, 20).size() == 8); // Manhattan distance 7
+
+    GeneratedNetwork geometric = NetworkGenerator::make_random_geometric(300, 8.0, 5);
+    GeneratedNetwork same_seed = NetworkGenerator::make_random_geometric(300, 8.0, 5);
+    assert(geometric.graph.get_all_nodes().size() == 300);
+    assert(geometric.graph.get_all_edges().size() == same_seed.graph.get_all_edges().size());
+    double mean_degree = static_cast<double>(geometric.graph.get_all_edges().size()) / 300;
+    assert(mean_degree > 5.0 && mean_degree < 9.0); // Boundary nodes have fewer neighbours
+    for (const auto &pair : geometric.graph.get_all_edges())
+        assert(geometric.graph.get_edge_between(pair.second.to_node_id, pair.second.from_node_id)); // Two-way
+
+    Simulation sim(1);
+    NetworkGenerator::install(sim, geometric);
+    assert(NetworkGenerator::add_vehicles(sim, 500, 9) == 500);
+    assert(sim.get_vehicles().size() == 500 && sim.get_vehicles().begin()->first == 1000000);
+    for (int t = 0; t < 50; ++t)
+        sim.tick();
+    assert(sim.get_vehicles().size() < 500 + 50 / 20); // Some trips completed
+    std::cout << "test_generated_networks_are_routable PASSED." << std::endl;
+}
+
+void test_demand_profile_controls_spawning()
+{
+    std::cout << "Running test_demand_profile_controls_spawning..." << std::endl;
+    Simulation sim(3);
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 0, 0);
+    g.add_node(3, 0, 0);
+    g.add_edge(12, 1, 2, 1000); // Long enough that no spawned vehicle arrives
+    g.add_edge(21, 2, 1, 1000);
+    g.add_edge(23, 2, 3, 1000);
+    g.add_edge(32, 3, 2, 1000);
+    sim.set_graph(g);
+    assert(sim.get_spawn_interval() == Simulation::DEFAULT_SPAWN_INTERVAL);
+
+    // Given out of order: every 5 ticks, then a pause, then every 50 ticks
+    sim.set_demand_profile({{100, 0}, {0, 5}, {200, 50}});
+    auto run_until = [&](int tick)
+    {
+        while (sim.get_current_tick() < tick)
+            sim.tick();
+        return sim.get_vehicles().size();
+    };
+    assert(run_until(100) == 20 && sim.get_spawn_interval() == 5);
+    assert(run_until(200) == 20 && sim.get_spawn_interval() == 0);
+    assert(run_until(249) == 20 && run_until(250) == 21 && run_until(300) == 22);
+
+    sim.set_spawn_interval(0);
+    assert(run_until(400) == 22);
+    std::cout << "test_demand_profile_controls_spawning PASSED." << std::endl;
+}
+
+void test_scenario_file_builds_simulation()
+{
+    std::cout << "Running test_scenario_file_builds_simulation..." << std::endl;
+    const std::string map_path = "test_temp_scenario_map.txt";
+    const std::string plans_path = "test_temp_scenario_plans.txt";
+    const std::string scenario_path = "test_temp_scenario.scn";
+    {
+        std::ofstream map(map_path);
+        map << "N 1 0 0\nN 2 100 0\nN 3 200 0\nN 4 100 100\n"
+            << "E 12 1 2 5\nE 21 2 1 5\nE 23 2 3 5\nE 32 3 2 5\nE 24 2 4 5\n";
+        std::ofstream plans(plans_path);
+        plans << "P 2 0 2\nG 21 7\nG 23 9\nG 24 11\n";
+        std::ofstream scenario(scenario_path);
+        scenario << "# Test scenario\nmap " << map_path << "\nplans " << plans_path << "\n"
+                 << "demand 0 4\ndemand 40 0\nvehicles 10 3\nseed 5\nticks 60\n";
+    }
+
+    Scenario scenario;
+    assert(load_scenario(scenario_path, scenario));
+    assert(scenario.name == "test_temp_scenario" && scenario.seed == 5 && scenario.ticks == 60);
+    assert(scenario.graph->get_all_nodes().size() == 4 && scenario.demand.size() == 2);
+    // Derived from outgoing edges: node 4 has none, so it gets no signal
+    assert(scenario.intersections.size() == 3);
+    const Intersection &middle = scenario.intersections[1];
+    assert(middle.get_id() == 2 && middle.get_approach_ids() == std::vector<int>({21, 23, 24}));
+    assert(middle.get_green_duration(24) == 11);
+
+    Simulation first, second;
+    apply_scenario(first, scenario);
+    apply_scenario(second, scenario);
+    assert(&first.get_graph() == &second.get_graph()); // Shared, not copied
+    assert(first.get_intersections().size() == 3 && first.get_vehicles().size() == 10);
+    for (int t = 0; t < scenario.ticks; ++t)
+    {
+        first.tick();
+        second.tick();
+    }
+    assert(first.get_vehicles().size() == second.get_vehicles().size()); // Seeded from the scenario
+    assert(first.get_spawn_interval() == 0);
+
+    // Explicit intersections replace the derived ones; a generated network needs no map
+    {
+        std::ofstream out(scenario_path);
+        out << "grid 3 4\nintersection 1 1 2\n";
+    }
+    assert(load_scenario(scenario_path, scenario));
+    assert(scenario.graph->get_all_nodes().size() == 12 && scenario.intersections.size() == 1);
+    assert(scenario.ticks == 1000 && scenario.demand.empty());
+
+    // Broken files are rejected and leave the output untouched
+    for (const char *broken : {"ticks 10\n",                          // No network
+                               "grid 2 2\ngeometric 10 4 1\n",      // Two networks
+                               "grid 2 2\nspeed 3\n",               // Unknown directive
+                               "grid 2 2\nticks ten\n",             // Malformed number
+                               "grid 2 2\nintersection 1 999\n",    // Unknown approach
+                               "map missing_map.txt\n"})
+    {
+        {
+            std::ofstream out(scenario_path);
+            out << broken;
+        }
+        assert(!load_scenario(scenario_path, scenario));
+        assert(scenario.graph->get_all_nodes().size() == 12);
+    }
+    std::remove(map_path.c_str());
+    std::remove(plans_path.c_str());
+    std::remove(scenario_path.c_str());
+    std::cout << "test_scenario_file_builds_simulation PASSED." << std::endl;
+}
+
+void test_ensemble_replicas_match_independent_runs()
+{
+    std::cout << "Running test_ensemble_replicas_match_independent_runs..." << std::endl;
+    Simulation prototype(1);
+    NetworkGenerator::install(prototype, NetworkGenerator::make_grid(6, 6));
+    NetworkGenerator::add_vehicles(prototype, 300, 4);
+    prototype.set_spawn_interval(2);
+    const int TICKS = 150;
+
+    EnsembleRunner runner(prototype, 3);
+    EnsembleResult result = runner.run(5, TICKS, 10);
+    assert(result.replicas.size() == 5 && result.replicas[4].seed == 14);
+    // The shared route cache changes nothing: every replica matches a fork ticked alone
+    for (const ReplicaResult &replica : result.replicas)
+    {
+        Simulation alone = prototype.fork(replica.seed);
+        alone.set_metrics_enabled(true);
+        for (int t = 0; t < TICKS; ++t)
+            alone.tick();
+        MetricsSnapshot expected = alone.get_metrics()->snapshot();
+        assert(replica.metrics.vehicles_spawned == expected.vehicles_spawned);
+        assert(replica.metrics.trips_completed == expected.trips_completed);
+        assert(replica.metrics.travel_time_sum == expected.travel_time_sum);
+        assert(replica.vehicles_at_end == alone.get_vehicles().size());
+    }
+    assert(runner.get_route_cache().get_hits() > 0 && runner.get_route_cache().size() > 0);
+    assert(&runner.get_route_cache().get_graph() == &prototype.get_graph()); // Not copied
+
+    const EnsembleStatistic *trips = result.find("trips_completed");
+    assert(trips && trips->samples == 5 && trips->min <= trips->mean && trips->mean <= trips->max);
+    assert(trips->ci_half_width > 0.0 && trips->stddev > 0.0); // Seeds differ in spawning
+    double sum = 0.0;
+    for (const ReplicaResult &replica : result.replicas)
+        sum += static_cast<double>(replica.metrics.trips_completed);
+    assert(std::abs(trips->mean - sum / 5) < 1e-9);
+    assert(result.find("no_such_outcome") == nullptr);
+    assert(result.distributions.get_network_travel_time().get_count() == sum);
+
+    // Thread count and repetition do not change the outcome
+    EnsembleRunner single(prototype, 1);
+    EnsembleResult again = single.run(5, TICKS, 10);
+    for (std::size_t i = 0; i < result.statistics.size(); ++i)
+        assert(again.statistics[i].mean == result.statistics[i].mean);
+
+    // A cache built for another graph is refused
+    Simulation other(1);
+    other.set_graph(NetworkGenerator::make_grid(2, 2).graph);
+    assert(!other.set_route_cache(std::make_shared<RouteCache>(prototype.get_shared_graph())));
+    assert(other.set_route_cache(std::make_shared<RouteCache>(other.get_shared_graph())));
+    std::cout << "test_ensemble_replicas_match_independent_runs PASSED." << std::endl;
+}
+
+void test_simulation_thread_publishes_snapshots()
+{
+    std::cout << "Running test_simulation_thread_publishes_snapshots..." << std::endl;
+    // The reader only ever sees complete values, in publication order
+    {
+        TripleBuffer<std::vector<int>> buffer;
+        const int VALUES = 20000;
+        std::thread writer([&buffer]()
+                           {
+                               for (int value = 1; value <= VALUES; ++value)
+                               {
+                                   buffer.write_buffer().assign(64, value);
+                                   buffer.publish();
+                               } });
+        int last = 0;
+        while (last < VALUES)
+        {
+            if (!buffer.update())
+                continue;
+            const std::vector<int> &read = buffer.read_buffer();
+            assert(read.size() == 64 && read.front() > last);
+            for (int value : read)
+                assert(value == read.front());
+            last = read.front();
+        }
+        writer.join();
+        assert(!buffer.update()); // Nothing new after the last value was taken
+    }
+
+    Simulation sim(3);
+    NetworkGenerator::install(sim, NetworkGenerator::make_grid(4, 4));
+    NetworkGenerator::add_vehicles(sim, 100, 3);
+    Simulation expected = sim.fork();
+    const int TICKS = 200;
+
+    // Unbounded: ticks as fast as it can, stops at max_ticks with the last snapshot published
+    SimulationThread sim_thread(sim.fork(), TICKS);
+    assert(sim_thread.get_snapshots().update() && sim_thread.get_snapshots().read_buffer().tick == 0);
+    sim_thread.start();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    int last_tick = 0;
+    while (last_tick < TICKS && std::chrono::steady_clock::now() < deadline)
+    {
+        if (sim_thread.get_snapshots().update())
+        {
+            assert(sim_thread.get_snapshots().read_buffer().tick > last_tick);
+            last_tick = sim_thread.get_snapshots().read_buffer().tick;
+        }
+    }
+    sim_thread.stop();
+    assert(last_tick == TICKS && sim_thread.get_simulation().get_current_tick() == TICKS);
+    // Ticking on a thread changes nothing: the snapshot matches the same run ticked here
+    for (int t = 0; t < TICKS; ++t)
+        expected.tick();
+    StateSnapshot direct;
+    direct.capture(expected, expected.get_graph());
+    const StateSnapshot &published = sim_thread.get_snapshots().read_buffer();
+    assert(published.vehicle_count == direct.vehicle_count && !published.vehicles.empty());
+    assert(published.vehicles.size() == direct.vehicles.size() && published.signals.size() == direct.signals.size());
+    for (std::size_t i = 0; i < direct.vehicles.size(); ++i)
+    {
+        assert(published.vehicles[i].vehicle_id == direct.vehicles[i].vehicle_id);
+        assert(published.vehicles[i].edge_id == direct.vehicles[i].edge_id && direct.vehicles[i].edge_id >= 0);
+        assert(published.vehicles[i].x == direct.vehicles[i].x && published.vehicles[i].y == direct.vehicles[i].y);
+        assert(i == 0 || direct.vehicles[i - 1].vehicle_id < direct.vehicles[i].vehicle_id);
+    }
+    for (std::size_t i = 0; i < direct.signals.size(); ++i)
+        assert(published.signals[i].state == direct.signals[i].state);
+
+    // Paced: never faster than the target rate; paused: no ticks at all
+    SimulationThread paced(sim.fork());
+    paced.set_ticks_per_second(200.0);
+    auto start = std::chrono::steady_clock::now();
+    paced.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    paced.set_paused(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Lets a tick in progress finish
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    paced.get_snapshots().update();
+    const int paced_ticks = paced.get_snapshots().read_buffer().tick;
+    assert(paced_ticks > 0 && paced_ticks <= 200.0 * seconds + 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!paced.get_snapshots().update());
+    paced.stop();
+    assert(paced.get_simulation().get_current_tick() == paced_ticks);
+    std::cout << "test_simulation_thread_publishes_snapshots PASSED." << std::endl;
+}
+
 int main()
 {
     std::cout << "Starting Simulation tests (test_simulation.cpp)..." << std::endl;
     test_simulation_creation_and_setup();
     test_single_vehicle_full_journey();
     test_vehicle_spawning_and_despawning();
+    test_fork_shares_graph_and_diverges();
+    test_metrics_follow_vehicles_through_network();
+    test_generated_networks_are_routable();
+    test_demand_profile_controls_spawning();
+    test_scenario_file_builds_simulation();
+    test_ensemble_replicas_match_independent_runs();
+    test_simulation_thread_publishes_snapshots();
     std::cout << "All Simulation tests PASSED." << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <algorithm> // For std::sort
+#include <random>
+#include "spatial_grid.hpp"
+#include "graph.hpp"
+#include "network_generator.hpp"
+
+namespace
+{
+    // What a query must return: every item whose box meets the area, checked one by one
+    std::vector<int> brute_force_edges(const SpatialGrid &grid, const BoundingBox &area)
+    {
+        std::vector<int> expected;
+        for (int i = 0; i < static_cast<int>(grid.edge_count()); ++i)
+        {
+            if (grid.get_edge_bounds(i).intersects(area))
+                expected.push_back(i);
+        }
+        return expected;
+    }
+
+    std::vector<int> brute_force_nodes(const Graph &graph, const SpatialGrid &grid, const BoundingBox &area)
+    {
+        std::vector<int> expected;
+        for (int i = 0; i < static_cast<int>(grid.node_count()); ++i)
+        {
+            const Node *node = graph.get_node(grid.get_node_id(i));
+            if (area.min_x <= node->x && node->x <= area.max_x && area.min_y <= node->y && node->y <= area.max_y)
+                expected.push_back(i);
+        }
+        return expected;
+    }
+
+    std::vector<int> sorted(std::vector<int> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    void check_random_queries(const Graph &graph, int queries, unsigned int seed)
+    {
+        SpatialGrid grid(graph);
+        const BoundingBox &bounds = grid.get_bounds();
+        std::mt19937 rng(seed);
+        // Areas from tiny to larger than the network, partly outside it
+        std::uniform_real_distribution<double> x(bounds.min_x - 100.0, bounds.max_x + 100.0);
+        std::uniform_real_distribution<double> y(bounds.min_y - 100.0, bounds.max_y + 100.0);
+        std::uniform_real_distribution<double> size(0.0, 0.6 * (bounds.max_x - bounds.min_x) + 10.0);
+        std::vector<int> found;
+        for (int q = 0; q < queries; ++q)
+        {
+            BoundingBox area;
+            area.min_x = x(rng);
+            area.min_y = y(rng);
+            area.max_x = area.min_x + size(rng);
+            area.max_y = area.min_y + size(rng);
+
+            grid.query_edges(area, found);
+            assert(sorted(found) == brute_force_edges(grid, area)); // Sorted and equal: no duplicates
+            grid.query_nodes(area, found);
+            assert(sorted(found) == brute_force_nodes(graph, grid, area));
+        }
+    }
+}
+
+void test_queries_match_brute_force()
+{
+    std::cout << "Running test_queries_match_brute_force..." << std::endl;
+    check_random_queries(NetworkGenerator::make_grid(12, 9).graph, 300, 1);
+    check_random_queries(NetworkGenerator::make_random_geometric(800, 4.0, 7).graph, 300, 2);
+
+    // Long edges span many cells and must still come out once
+    Graph spokes;
+    spokes.add_node(0, 500.0, 500.0);
+    for (int i = 1; i <= 40; ++i)
+    {
+        spokes.add_node(i, (i * 97) % 1000, (i * 61) % 1000);
+        spokes.add_edge(i, 0, i, 1.0);
+    }
+    check_random_queries(spokes, 300, 3);
+
+    // Degenerate extents: all nodes on a line, and a single node
+    Graph line;
+    for (int i = 0; i < 50; ++i)
+    {
+        line.add_node(i, i * 10.0, 20.0);
+        if (i > 0)
+            line.add_edge(100 + i, i - 1, i, 1.0);
+    }
+    check_random_queries(line, 200, 4);
+    Graph single;
+    single.add_node(7, 3.0, 4.0);
+    check_random_queries(single, 50, 5);
+    std::cout << "test_queries_match_brute_force PASSED." << std::endl;
+}
+
+void test_indices_bounds_and_empty_graph()
+{
+    std::cout << "Running test_indices_bounds_and_empty_graph..." << std::endl;
+    GeneratedNetwork network = NetworkGenerator::make_grid(4, 5, 50.0);
+    SpatialGrid grid(network.graph);
+    assert(grid.node_count() == network.graph.get_all_nodes().size());
+    assert(grid.edge_count() == network.graph.get_all_edges().size());
+    // Dense indices follow the graph's (ascending id) order and map back to ids
+    int index = 0;
+    for (const auto &pair : network.graph.get_all_edges())
+    {
+        assert(grid.get_edge_id(index) == pair.first && grid.find_edge_index(pair.first) == index);
+        ++index;
+    }
+    assert(grid.find_edge_index(-12345) == -1 && grid.find_node_index(-12345) == -1);
+
+    const BoundingBox &bounds = grid.get_bounds();
+    assert(bounds.min_x == 0.0 && bounds.min_y == 0.0 && bounds.max_x == 4 * 50.0 && bounds.max_y == 3 * 50.0);
+    std::vector<int> found;
+    grid.query_edges(bounds, found);
+    assert(found.size() == grid.edge_count()); // Everything
+    grid.query_edges(BoundingBox{1000.0, 1000.0, 2000.0, 2000.0}, found);
+    assert(found.empty()); // Nothing, and the previous result is cleared
+    assert(bounds.contains(BoundingBox{10.0, 10.0, 20.0, 20.0}) && !bounds.contains(BoundingBox{-1.0, 0.0, 1.0, 1.0}));
+
+    Graph empty;
+    SpatialGrid empty_grid(empty);
+    empty_grid.query_edges(BoundingBox{-1e9, -1e9, 1e9, 1e9}, found);
+    assert(found.empty() && empty_grid.edge_count() == 0);
+    empty_grid.query_nodes(BoundingBox{-1e9, -1e9, 1e9, 1e9}, found);
+    assert(found.empty());
+    std::cout << "test_indices_bounds_and_empty_graph PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Spatial Grid tests (test_spatial_grid.cpp)..." << std::endl;
+    test_queries_match_brute_force();
+    test_indices_bounds_and_empty_graph();
+    std::cout << "All Spatial Grid tests PASSED." << std::endl;
+    return 0;
+}
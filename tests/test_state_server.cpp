@@ -0,0 +1,314 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility> // For std::move
+#include <vector>
+#include "network_generator.hpp"
+#include "simulation.hpp"
+#include "state_server.hpp"
+#include "state_stream.hpp"
+
+namespace
+{
+    const char *SOCKET_PATH = "test_state_server.sock";
+
+    bool same_state(const StateSnapshot &a, const StateSnapshot &b)
+    {
+        if (a.tick != b.tick || a.vehicle_count != b.vehicle_count || a.vehicles.size() != b.vehicles.size() ||
+            a.signals.size() != b.signals.size() || a.queues.size() != b.queues.size())
+            return false;
+        for (std::size_t i = 0; i < a.vehicles.size(); ++i)
+        {
+            const StateSnapshot::VehiclePosition &p = a.vehicles[i], &q = b.vehicles[i];
+            if (p.vehicle_id != q.vehicle_id || p.edge_id != q.edge_id || p.x != q.x || p.y != q.y)
+                return false;
+        }
+        for (std::size_t i = 0; i < a.signals.size(); ++i)
+        {
+            const StateSnapshot::SignalLight &p = a.signals[i], &q = b.signals[i];
+            if (p.intersection_id != q.intersection_id || p.has_approaches != q.has_approaches ||
+                (p.has_approaches && p.state != q.state) || p.x != q.x || p.y != q.y)
+                return false;
+        }
+        for (std::size_t i = 0; i < a.queues.size(); ++i)
+        {
+            if (a.queues[i].approach_id != b.queues[i].approach_id || a.queues[i].length != b.queues[i].length)
+                return false;
+        }
+        return true;
+    }
+
+    StateSnapshot small_state()
+    {
+        StateSnapshot state;
+        state.tick = 7;
+        state.vehicle_count = 4;
+        state.vehicles = {{1, 10, 0.f, 0.f}, {5, 10, 2.5f, -1.f}, {9, 11, 100.f, 40.f}};
+        state.signals = {{1, 0.f, 0.f, true, LightState::GREEN}, {2, 50.f, 0.f, false, LightState::RED}};
+        state.queues = {{10, 0}, {11, 3}, {12, 1}};
+        return state;
+    }
+
+    int connect_client()
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, SOCKET_PATH);
+        int result = connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+        assert(result == 0);
+        (void)result;
+        return fd;
+    }
+
+    // Reads from `fd` into the decoder until it holds `tick`; false on timeout or a bad stream
+    bool read_until_tick(int fd, StateStreamDecoder &decoder, int tick, int timeout_ms = 10000)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::vector<std::uint8_t> buffer(1 << 16);
+        while (!decoder.has_state() || decoder.get_state().tick != tick)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            pollfd entry{fd, POLLIN, 0};
+            if (poll(&entry, 1, 50) <= 0)
+                continue;
+            ssize_t received = recv(fd, buffer.data(), buffer.size(), 0);
+            if (received <= 0 || !decoder.feed(buffer.data(), static_cast<std::size_t>(received)))
+                return false;
+        }
+        return true;
+    }
+}
+
+void test_stream_round_trip()
+{
+    std::cout << "Running test_stream_round_trip..." << std::endl;
+    StateSnapshot empty, first = small_state();
+    std::vector<std::uint8_t> stream(StateStreamFormat::MAGIC, StateStreamFormat::MAGIC + 8);
+    encode_state_update(empty, first, true, stream);
+    const std::size_t key_size = stream.size() - 8;
+
+    // Move one vehicle, remove one, add one, switch a signal and grow a queue
+    StateSnapshot second = first;
+    second.tick = 8;
+    second.vehicles[0].x = 1.f;
+    second.vehicles.erase(second.vehicles.begin() + 1);
+    second.vehicles.push_back({12, 11, 90.f, 40.f});
+    second.signals[0].state = LightState::YELLOW;
+    second.queues[1].length = 4;
+    std::vector<std::uint8_t> delta;
+    encode_state_update(first, second, false, delta);
+    stream.insert(stream.end(), delta.begin(), delta.end());
+    assert(delta.size() < key_size);
+
+    // Nothing changed: only the tick, counts and empty sections
+    StateSnapshot third = second;
+    third.tick = 9;
+    std::vector<std::uint8_t> idle;
+    encode_state_update(second, third, false, idle);
+    assert(idle.size() == 1 + 1 + 1 + 1 + 6);
+    stream.insert(stream.end(), idle.begin(), idle.end());
+
+    // All at once, then one byte at a time, with the state checked after each update
+    StateStreamDecoder decoder;
+    assert(decoder.feed(stream.data(), stream.size()));
+    assert(decoder.get_updates_decoded() == 3 && same_state(decoder.get_state(), third));
+    decoder.reset();
+    assert(!decoder.has_state());
+    for (std::size_t i = 0; i < stream.size(); ++i)
+    {
+        assert(decoder.feed(&stream[i], 1));
+        if (i == 8 + key_size - 1)
+            assert(same_state(decoder.get_state(), first));
+        if (i == 8 + key_size + delta.size() - 1)
+            assert(same_state(decoder.get_state(), second));
+    }
+    assert(same_state(decoder.get_state(), third));
+    std::cout << "test_stream_round_trip PASSED." << std::endl;
+}
+
+void test_decoder_rejects_bad_streams()
+{
+    std::cout << "Running test_decoder_rejects_bad_streams..." << std::endl;
+    StateSnapshot empty, state = small_state();
+    std::vector<std::uint8_t> key, delta;
+    encode_state_update(empty, state, true, key);
+    encode_state_update(state, state, false, delta);
+
+    StateStreamDecoder decoder;
+    std::vector<std::uint8_t> stream(8, 'x');
+    assert(!decoder.feed(stream.data(), stream.size())); // Not the magic
+    assert(!decoder.feed(key.data(), key.size()));        // Stays failed
+
+    decoder.reset();
+    stream.assign(StateStreamFormat::MAGIC, StateStreamFormat::MAGIC + 8);
+    stream.insert(stream.end(), delta.begin(), delta.end());
+    assert(!decoder.feed(stream.data(), stream.size())); // DELTA before any KEY
+
+    decoder.reset();
+    stream.assign(StateStreamFormat::MAGIC, StateStreamFormat::MAGIC + 8);
+    stream.insert(stream.end(), key.begin(), key.end() - 1);
+    assert(decoder.feed(stream.data(), stream.size()) && !decoder.has_state()); // Truncated: waits
+    assert(decoder.feed(&key.back(), 1) && same_state(decoder.get_state(), state));
+
+    decoder.reset();
+    stream.assign(StateStreamFormat::MAGIC, StateStreamFormat::MAGIC + 8);
+    stream.insert(stream.end(), key.begin(), key.end());
+    stream[stream.size() - 3] = 0x7f; // Corrupt the last section
+    assert(!decoder.feed(stream.data(), stream.size()));
+    std::cout << "test_decoder_rejects_bad_streams PASSED." << std::endl;
+}
+
+void test_server_streams_simulation()
+{
+    std::cout << "Running test_server_streams_simulation..." << std::endl;
+    Simulation sim(3);
+    NetworkGenerator::install(sim, NetworkGenerator::make_grid(6, 6));
+    NetworkGenerator::add_vehicles(sim, 300, 3);
+
+    StateServer server;
+    assert(!server.start(std::string(200, 'a'))); // Too long for a socket address
+    assert(server.start(SOCKET_PATH, 200.0));
+    assert(server.is_running());
+    server.publish(sim, sim.get_graph());
+    int fd = connect_client();
+    StateStreamDecoder decoder;
+    assert(read_until_tick(fd, decoder, 0));
+
+    StateSnapshot expected;
+    for (int t = 0; t < 60; ++t)
+    {
+        sim.tick();
+        server.publish(sim, sim.get_graph());
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    expected.capture(sim, sim.get_graph());
+    assert(!expected.vehicles.empty() && !expected.queues.empty());
+    assert(read_until_tick(fd, decoder, expected.tick));
+    assert(same_state(decoder.get_state(), expected));
+    assert(decoder.get_updates_decoded() >= 2);
+    assert(server.get_client_count() == 1 && server.get_updates_sent() >= 2);
+
+    // A second client starts from a KEY update of the latest state
+    int late = connect_client();
+    StateStreamDecoder late_decoder;
+    assert(read_until_tick(late, late_decoder, expected.tick));
+    assert(same_state(late_decoder.get_state(), expected));
+
+    // Hang-ups are noticed; stop() removes the socket file
+    close(fd);
+    for (int wait = 0; wait < 200 && server.get_client_count() != 1; ++wait)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(server.get_client_count() == 1);
+    server.stop();
+    assert(!server.is_running() && access(SOCKET_PATH, F_OK) != 0);
+    close(late);
+    std::cout << "test_server_streams_simulation PASSED." << std::endl;
+}
+
+void test_simulation_thread_feeds_server()
+{
+    std::cout << "Running test_simulation_thread_feeds_server..." << std::endl;
+    Simulation sim(4);
+    NetworkGenerator::install(sim, NetworkGenerator::make_grid(5, 5));
+    NetworkGenerator::add_vehicles(sim, 200, 4);
+    StateServer server;
+    assert(server.start(SOCKET_PATH, 200.0));
+    SimulationThread sim_thread(std::move(sim), 40);
+    sim_thread.set_state_server(&server);
+    int fd = connect_client();
+    sim_thread.start();
+
+    StateStreamDecoder decoder;
+    assert(read_until_tick(fd, decoder, 40));
+    sim_thread.stop();
+    StateSnapshot expected;
+    expected.capture(sim_thread.get_simulation(), sim_thread.get_graph());
+    assert(same_state(decoder.get_state(), expected));
+    server.stop();
+    close(fd);
+    std::cout << "test_simulation_thread_feeds_server PASSED." << std::endl;
+}
+
+void test_slow_client_skips_updates()
+{
+    std::cout << "Running test_slow_client_skips_updates..." << std::endl;
+    // Large enough that a few updates overflow an unread socket's buffer
+    StateSnapshot state;
+    for (int id = 0; id < 50000; ++id)
+        state.vehicles.push_back({id, id % 97, static_cast<float>(id), 0.f});
+    state.vehicle_count = state.vehicles.size();
+
+    StateServer server;
+    assert(server.start(SOCKET_PATH, 100.0));
+    server.publish(state);
+    int slow = connect_client(); // Never reads until the end
+    int fast = connect_client();
+    StateStreamDecoder slow_decoder, fast_decoder;
+    assert(read_until_tick(fast, fast_decoder, 0));
+
+    // The fast client keeps reading on its own thread while every vehicle moves each tick
+    std::atomic<bool> publishing(true);
+    std::atomic<bool> fast_ok(true);
+    std::thread reader([&]()
+    {
+        std::vector<std::uint8_t> buffer(1 << 16);
+        while (publishing.load())
+        {
+            pollfd entry{fast, POLLIN, 0};
+            if (poll(&entry, 1, 20) <= 0)
+                continue;
+            ssize_t received = recv(fast, buffer.data(), buffer.size(), 0);
+            if (received <= 0 || !fast_decoder.feed(buffer.data(), static_cast<std::size_t>(received)))
+                fast_ok.store(false);
+        }
+    });
+    const int ticks = 150;
+    for (int t = 1; t <= ticks; ++t)
+    {
+        state.tick = t;
+        for (auto &vehicle : state.vehicles)
+            vehicle.y += 1.f;
+        server.publish(state); // Must return at once whatever the clients do
+        std::this_thread::sleep_for(std::chrono::milliseconds(4));
+    }
+    publishing.store(false);
+    reader.join();
+    assert(fast_ok.load());
+    assert(server.get_updates_skipped() > 0);
+
+    // Both end up with the final state; the slow one got fewer updates on the way
+    assert(read_until_tick(fast, fast_decoder, ticks));
+    assert(same_state(fast_decoder.get_state(), state));
+    assert(read_until_tick(slow, slow_decoder, ticks));
+    assert(same_state(slow_decoder.get_state(), state));
+    assert(slow_decoder.get_updates_decoded() < fast_decoder.get_updates_decoded());
+    assert(fast_decoder.get_updates_decoded() <= ticks + 1);
+
+    server.stop();
+    close(slow);
+    close(fast);
+    std::cout << "test_slow_client_skips_updates PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting State Server tests (test_state_server.cpp)..." << std::endl;
+    test_stream_round_trip();
+    test_decoder_rejects_bad_streams();
+    test_server_streams_simulation();
+    test_simulation_thread_feeds_server();
+    test_slow_client_skips_updates();
+    std::cout << "All State Server tests PASSED." << std::endl;
+    return 0;
+}
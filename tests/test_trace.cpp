@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cassert>
+#include <cstdio>    // For std::remove
+#include <algorithm> // For std::count
+#include "trace.hpp"
+#include "thread_pool.hpp"
+#include "simulation.hpp"
+
+namespace
+{
+    const char *TRACE_PATH = "test_trace_output.json";
+
+    std::string read_file(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    std::size_t count_occurrences(const std::string &text, const std::string &pattern)
+    {
+        std::size_t count = 0;
+        for (std::size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+            ++count;
+        return count;
+    }
+
+    bool is_balanced(const std::string &json)
+    {
+        return std::count(json.begin(), json.end(), '{') == std::count(json.begin(), json.end(), '}') &&
+               std::count(json.begin(), json.end(), '[') == std::count(json.begin(), json.end(), ']');
+    }
+}
+
+void test_trace_collects_events_from_every_thread()
+{
+    std::cout << "Running test_trace_collects_events_from_every_thread..." << std::endl;
+    {
+        Tracing::Scope before_start("before start"); // Tracing is off: never recorded
+    }
+    assert(!Tracing::is_enabled());
+    assert(Tracing::start(TRACE_PATH));
+    assert(Tracing::is_enabled() && !Tracing::start(TRACE_PATH));
+
+    {
+        ThreadPool pool(3);
+        // More events than one buffer chunk holds, spread over the workers
+        pool.parallel_for(10000, [](std::size_t i)
+                          { Tracing::Scope job("test job", "job", static_cast<std::int64_t>(i)); });
+        // The calling thread may have run every index before a worker woke up; a
+        // submitted task always runs on a worker, so one is sure to appear in the trace
+        pool.submit([]()
+                    { Tracing::Scope job("worker job"); })
+            .get();
+    } // Workers exit before stop(); their events are kept
+
+    Simulation sim(1);
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 100, 0);
+    g.add_edge(12, 1, 2, 3);
+    sim.set_graph(g);
+    for (int t = 0; t < 5; ++t)
+        sim.tick();
+    assert(Tracing::stop());
+    assert(!Tracing::is_enabled() && !Tracing::stop());
+
+    std::string json = read_file(TRACE_PATH);
+    assert(json.find("\"traceEvents\"") != std::string::npos && is_balanced(json));
+    assert(count_occurrences(json, "\"name\":\"test job\"") == 10000);
+    assert(count_occurrences(json, "\"args\":{\"job\":9999}") == 1);
+    assert(json.find("before start") == std::string::npos);
+#ifdef TRAFFICSIM_TRACING
+    assert(count_occurrences(json, "\"name\":\"tick\"") == 5);
+    assert(count_occurrences(json, "\"name\":\"movement\"") == 5);
+    assert(json.find("\"name\":\"pool worker\"") != std::string::npos);
+#endif
+    std::remove(TRACE_PATH);
+    std::cout << "test_trace_collects_events_from_every_thread PASSED." << std::endl;
+}
+
+void test_trace_sessions_are_independent()
+{
+    std::cout << "Running test_trace_sessions_are_independent..." << std::endl;
+    assert(Tracing::start(TRACE_PATH));
+    {
+        Tracing::Scope first("first session");
+    }
+    Tracing::Scope spanning("spanning"); // Opened in the first session, closed in the second
+    assert(Tracing::stop());
+    {
+        Tracing::Scope between("between sessions");
+    }
+
+    assert(Tracing::start(TRACE_PATH));
+    spanning.next("second session");
+    spanning.next("second session");
+    assert(Tracing::stop());
+    std::string json = read_file(TRACE_PATH);
+    assert(is_balanced(json));
+    assert(json.find("first session") == std::string::npos);
+    assert(json.find("between sessions") == std::string::npos);
+    assert(json.find("\"name\":\"spanning\"") == std::string::npos);
+    assert(count_occurrences(json, "\"name\":\"second session\"") == 1); // The other ends after stop()
+    std::remove(TRACE_PATH);
+    std::cout << "test_trace_sessions_are_independent PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Trace tests (test_trace.cpp)..." << std::endl;
+    test_trace_collects_events_from_every_thread();
+    test_trace_sessions_are_independent();
+    std::cout << "All Trace tests PASSED." << std::endl;
+    return 0;
+}
@@ -4,6 +4,11 @@
 #include <cassert> // For assert()
 #include <fstream> // For dummy csv file
 #include <cstdio>  // For std::remove
+#include <iterator> // For std::istreambuf_iterator
+#include <zlib.h>   // For writing gzip fixtures
+#ifdef TRAFFICSIM_HAVE_ZSTD
+#include <zstd.h>   // For writing zstd fixtures
+#endif
 
 // Include headers from the main project
 #include "graph.hpp"
@@ -185,17 +190,24 @@ bool test_utils_csv_parser()
     outfile << "header1,header2,header3\n";
     outfile << "data1,100,val1\n";
     outfile << "data2, 200 , val2 \n";
-    outfile << "data3,300,val3";
+    outfile << "data3,300,val3\n";
+    outfile << "\n";
+    outfile << "#note,,x,\n";
+    outfile << ",last";
     outfile.close();
 
     std::vector<Utils::CsvRow> parsed_data = Utils::parse_csv(test_csv_path);
 
-    assert(parsed_data.size() == 4);
-    if (parsed_data.size() == 4)
+    assert(parsed_data.size() == 7);
+    if (parsed_data.size() == 7)
     {
         assert(parsed_data[1].fields.size() == 3);
         assert(parsed_data[1].fields[1] == "100");
         assert(parsed_data[2].fields[1] == "200");
+        // Blank lines are empty rows, '#' lines are data, a trailing delimiter adds no field
+        assert(parsed_data[4].fields.empty());
+        assert(parsed_data[5].fields == std::vector<std::string>({"#note", "", "x"}));
+        assert(parsed_data[6].fields == std::vector<std::string>({"", "last"}));
     }
 
     std::remove(test_csv_path.c_str());
@@ -210,6 +222,240 @@ bool test_utils_csv_parser()
     return true;
 }
 
+bool test_utils_zero_copy_csv()
+{
+    std::string test_csv_path = "test_temp_traffic_rows.csv";
+    std::ofstream outfile(test_csv_path);
+    outfile << "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+    outfile << "1,12,0.2,50.5,10\r\n";
+    outfile << "\n";
+    outfile << "  # indented comment\n";
+    outfile << "2, 21 , 0.1,60.0,5\n";
+    outfile << "3,13,bad,40.2,12\n";
+    outfile << "4,14,0.3,40.0,7";
+    outfile.close();
+
+    std::vector<TrafficDataPoint> points;
+    int raw_rows = 0;
+    bool opened = Utils::for_each_csv_row(test_csv_path, [&](const Utils::CsvFields &fields)
+                                          {
+        raw_rows++;
+        TrafficDataPoint point;
+        if (Utils::parse_traffic_row(fields, point))
+            points.push_back(point); });
+    assert(opened);
+    assert(raw_rows == 4); // Comments and blank lines never reach the callback
+    assert(points.size() == 3);
+    assert(points[0].edge_id == 12 && points[0].vehicles_passed == 10 && points[0].average_speed == 50.5);
+    assert(points[1].edge_id == 21 && points[1].density == 0.1);
+    assert(points[2].timestamp == 4 && points[2].vehicles_passed == 7);
+
+    // parse_csv keeps every line, comments and blank lines included
+    std::vector<Utils::CsvRow> rows = Utils::parse_csv(test_csv_path);
+    assert(rows.size() == 7);
+    assert(rows[1].fields.size() == 5 && rows[1].fields[4] == "10"); // \r trimmed
+    assert(rows[2].fields.empty() && rows[3].fields[0] == "# indented comment");
+    assert(rows[4].fields[1] == "21");
+    std::remove(test_csv_path.c_str());
+    assert(!Utils::for_each_csv_row(test_csv_path, [](const Utils::CsvFields &) {}));
+
+    int int_val;
+    double double_val;
+    assert(Utils::parse_int(" 42 ", int_val) && int_val == 42);
+    assert(!Utils::parse_int("42abc", int_val));
+    assert(!Utils::parse_int("", int_val));
+    assert(Utils::parse_double("2.5e1", double_val) && double_val == 25.0);
+    assert(!Utils::parse_double("x1", double_val));
+
+    // Pull-style cursor over an in-memory buffer
+    Utils::CsvCursor cursor("a;b\n#skip\nc; d ;e\n", ';');
+    Utils::CsvFields fields;
+    assert(cursor.next(fields) && fields.size() == 2 && fields[1] == "b");
+    assert(cursor.next(fields) && fields.size() == 3 && fields[1] == "d");
+    assert(!cursor.next(fields));
+    return true;
+}
+
+bool test_utils_chunked_traffic_loader()
+{
+    std::string buffer = "# timestamp,edge_id,density,average_speed,vehicles_passed\n";
+    for (int i = 0; i < 500; ++i)
+    {
+        buffer += std::to_string(i) + "," + std::to_string(i % 7) + ",0.5,42.0," + std::to_string(i % 11) + "\n";
+    }
+    buffer += "500,3,0.25,30.0,9"; // No trailing newline
+
+    // Chunks must tile the buffer and end on line boundaries
+    std::vector<std::string_view> chunks = Utils::split_line_chunks(buffer, 7);
+    assert(chunks.size() > 1 && chunks.size() <= 7);
+    std::size_t covered = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        assert(chunks[i].data() == buffer.data() + covered);
+        covered += chunks[i].size();
+        if (i + 1 < chunks.size())
+            assert(chunks[i].back() == '\n');
+    }
+    assert(covered == buffer.size());
+
+    TrafficDataColumns whole;
+    Utils::parse_traffic_columns(buffer, whole);
+    TrafficDataColumns stitched;
+    for (std::string_view chunk : chunks)
+    {
+        Utils::parse_traffic_columns(chunk, stitched);
+    }
+    assert(whole.size() == 501);
+    assert(stitched.timestamp == whole.timestamp && stitched.vehicles_passed == whole.vehicles_passed);
+
+    std::string test_csv_path = "test_temp_traffic_chunks.csv";
+    std::ofstream outfile(test_csv_path);
+    outfile << buffer;
+    outfile.close();
+
+    TrafficDataColumns loaded;
+    assert(Utils::load_traffic_columns(test_csv_path, loaded, 4));
+    assert(loaded.size() == 501 && loaded.edge_id == whole.edge_id);
+    assert(loaded.row(500).timestamp == 500 && loaded.row(500).density == 0.25);
+
+    std::size_t unordered_rows = 0;
+    assert(Utils::for_each_traffic_batch(test_csv_path, [&](const TrafficDataColumns &batch)
+                                         { unordered_rows += batch.size(); }, false, 2));
+    assert(unordered_rows == 501);
+    std::remove(test_csv_path.c_str());
+    assert(!Utils::load_traffic_columns(test_csv_path, loaded));
+    return true;
+}
+
+// Writes `contents` gzip-compressed to `path`
+static void write_gzip_file(const std::string &path, const std::string &contents)
+{
+    gzFile file = gzopen(path.c_str(), "wb");
+    assert(file != nullptr);
+    assert(gzwrite(file, contents.data(), static_cast<unsigned>(contents.size())) == static_cast<int>(contents.size()));
+    gzclose(file);
+}
+
+bool test_compressed_inputs()
+{
+    const std::string map_text = "# Nodes\nN 1 0 0\nN 2 10 0\nN 3\n\n# Edges\nE 12 1 2 10\nE 23 2 3 5.5\n";
+    std::string plain_map = "test_temp_map.txt";
+    std::string gzip_map = "test_temp_map.txt.gz";
+    {
+        std::ofstream out(plain_map);
+        out << map_text;
+    }
+    write_gzip_file(gzip_map, map_text);
+    assert(Utils::detect_compression(plain_map) == Utils::Compression::NONE);
+    assert(Utils::detect_compression(gzip_map) == Utils::Compression::GZIP);
+
+    for (const std::string &path : {plain_map, gzip_map})
+    {
+        Graph graph;
+        assert(graph.load_from_file(path));
+        assert(graph.get_all_nodes().size() == 3 && graph.get_all_edges().size() == 2);
+        assert(graph.get_node(2)->x == 10.0);
+        assert(graph.get_edge(23)->weight == 5.5);
+        assert(graph.find_shortest_path(1, 3).size() == 3);
+    }
+
+    // An edge to an unknown node rejects the whole file
+    {
+        std::ofstream out(plain_map);
+        out << "N 1\nE 12 1 2 10\n";
+    }
+    Graph broken;
+    assert(!broken.load_from_file(plain_map));
+    assert(broken.get_all_nodes().empty());
+    std::remove(plain_map.c_str());
+    std::remove(gzip_map.c_str());
+
+    // Traffic data large enough to span several decompression blocks
+    std::string csv = "timestamp,edge_id,density,average_speed,vehicles_passed\n";
+    long long expected_vehicles = 0;
+    int rows = 0;
+    while (csv.size() < Utils::DECOMPRESS_BLOCK_BYTES * 2 + 1000)
+    {
+        csv += std::to_string(rows) + "," + std::to_string(rows % 13) + ",0.125,37.5," + std::to_string(rows % 9) + "\n";
+        expected_vehicles += rows % 9;
+        rows++;
+    }
+    std::string gzip_csv = "test_temp_traffic.csv.gz";
+    write_gzip_file(gzip_csv, csv);
+
+    int seen_rows = 0;
+    long long seen_vehicles = 0;
+    int last_timestamp = -1;
+    bool in_order = true;
+    TrafficDataPoint point;
+    assert(Utils::for_each_csv_row(gzip_csv, [&](const Utils::CsvFields &fields)
+                                   {
+        if (!Utils::parse_traffic_row(fields, point))
+            return;
+        in_order = in_order && point.timestamp == last_timestamp + 1;
+        last_timestamp = point.timestamp;
+        seen_rows++;
+        seen_vehicles += point.vehicles_passed; }));
+    assert(in_order && seen_rows == rows && seen_vehicles == expected_vehicles);
+
+    TrafficDataColumns columns;
+    assert(Utils::load_traffic_columns(gzip_csv, columns, 2));
+    assert(static_cast<int>(columns.size()) == rows && columns.timestamp.back() == rows - 1);
+
+    // A truncated archive is reported as an error
+    std::string truncated = "test_temp_truncated.csv.gz";
+    {
+        std::ifstream in(gzip_csv, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(truncated, std::ios::binary);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    assert(!Utils::for_each_csv_row(truncated, [](const Utils::CsvFields &) {}));
+    std::remove(gzip_csv.c_str());
+    std::remove(truncated.c_str());
+
+#ifdef TRAFFICSIM_HAVE_ZSTD
+    // zstd, many times ZSTD_DStreamOutSize(). The same few rows over and over compress to
+    // a single read of input, and the reader's second block (shortened by the partial line
+    // the first left behind) ends inside the last zstd block, so the decoder still holds
+    // output when its input runs out. Every byte must still be delivered.
+    const std::string repeated_rows = csv.substr(0, csv.find('\n', 4096) + 1);
+    std::string zstd_csv_text;
+    while (zstd_csv_text.size() < Utils::DECOMPRESS_BLOCK_BYTES * 2)
+        zstd_csv_text += repeated_rows;
+    if (zstd_csv_text[Utils::DECOMPRESS_BLOCK_BYTES - 1] == '\n')
+        zstd_csv_text.insert(zstd_csv_text.begin(), ' '); // Move the first block's end into a line
+    zstd_csv_text.resize(Utils::DECOMPRESS_BLOCK_BYTES * 2 - 1);
+    zstd_csv_text += '\n';
+    assert(zstd_csv_text.size() > ZSTD_DStreamOutSize() && zstd_csv_text[Utils::DECOMPRESS_BLOCK_BYTES - 1] != '\n');
+    std::string compressed(ZSTD_compressBound(zstd_csv_text.size()), '\0');
+    std::size_t compressed_size = ZSTD_compress(&compressed[0], compressed.size(), zstd_csv_text.data(),
+                                                zstd_csv_text.size(), 3);
+    assert(!ZSTD_isError(compressed_size));
+    compressed.resize(compressed_size);
+    std::string zstd_csv = "test_temp_traffic.csv.zst";
+    {
+        std::ofstream out(zstd_csv, std::ios::binary);
+        out.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+    }
+    assert(Utils::detect_compression(zstd_csv) == Utils::Compression::ZSTD);
+    std::string decompressed;
+    assert(Utils::for_each_line_block(zstd_csv, [&](std::string_view block)
+                                      { decompressed.append(block.data(), block.size()); }));
+    assert(decompressed == zstd_csv_text); // Every byte, including the last ones
+
+    std::string zstd_truncated = "test_temp_truncated.csv.zst";
+    {
+        std::ofstream out(zstd_truncated, std::ios::binary);
+        out.write(compressed.data(), static_cast<std::streamsize>(compressed.size() / 2));
+    }
+    assert(!Utils::for_each_csv_row(zstd_truncated, [](const Utils::CsvFields &) {}));
+    std::remove(zstd_csv.c_str());
+    std::remove(zstd_truncated.c_str());
+#endif
+    return true;
+}
+
 int main()
 {
     std::cout << "--- Starting Traffic Flow Tests ---" << std::endl;
@@ -218,6 +464,9 @@ int main()
     RUN_TEST(test_intersection_signal_logic);
     RUN_TEST(test_simulation_tick_and_vehicle_movement);
     RUN_TEST(test_utils_csv_parser);
+    RUN_TEST(test_utils_zero_copy_csv);
+    RUN_TEST(test_utils_chunked_traffic_loader);
+    RUN_TEST(test_compressed_inputs);
     std::cout << "--- Test Summary ---" << std::endl;
     std::cout << "Total tests run: " << tests_run << std::endl;
     std::cout << "Tests passed: " << tests_passed << std::endl;
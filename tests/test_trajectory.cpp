@@ -0,0 +1,314 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cassert>
+#include <cstdio>  // For std::remove
+#include <cstring> // For std::memcmp
+#include <fstream>
+#include <iterator>
+#include "trajectory.hpp"
+#include "trajectory_recorder.hpp"
+#include "trajectory_replay.hpp"
+#include "simulation.hpp"
+#include "varint.hpp"
+
+// Square of four signalised nodes
+void setup_square_network(Simulation &sim)
+{
+    Graph g;
+    g.add_node(1, 0, 0);
+    g.add_node(2, 100, 0);
+    g.add_node(3, 0, 100);
+    g.add_node(4, 100, 100);
+    g.add_edge(12, 1, 2, 10);
+    g.add_edge(21, 2, 1, 10);
+    g.add_edge(13, 1, 3, 10);
+    g.add_edge(31, 3, 1, 10);
+    g.add_edge(24, 2, 4, 8);
+    g.add_edge(42, 4, 2, 8);
+    g.add_edge(34, 3, 4, 8);
+    g.add_edge(43, 4, 3, 8);
+    sim.set_graph(g);
+    sim.add_intersection(Intersection(1, {12, 13}));
+    sim.add_intersection(Intersection(2, {21, 24}));
+    sim.add_intersection(Intersection(3, {31, 34}));
+    sim.add_intersection(Intersection(4, {42, 43}));
+}
+
+bool frames_equal(const TrajectoryFrame &a, const TrajectoryFrame &b)
+{
+    return a.tick == b.tick && a.vehicle_ids == b.vehicle_ids && a.vehicle_states == b.vehicle_states &&
+           a.current_nodes == b.current_nodes && a.next_nodes == b.next_nodes &&
+           a.progress_ticks == b.progress_ticks && a.total_ticks == b.total_ticks &&
+           a.destinations == b.destinations && a.intersection_ids == b.intersection_ids &&
+           a.green_indices == b.green_indices && a.phases == b.phases &&
+           a.ticks_in_state == b.ticks_in_state && a.approach_counts == b.approach_counts &&
+           a.approach_ids == b.approach_ids && a.queue_lengths == b.queue_lengths &&
+           a.queued_vehicle_ids == b.queued_vehicle_ids;
+}
+
+void test_codec_round_trip_with_changing_vehicles()
+{
+    std::cout << "Running test_codec_round_trip_with_changing_vehicles..." << std::endl;
+    TrajectoryFrame first;
+    first.tick = 10;
+    first.vehicle_ids = {1, 2, 5};
+    first.vehicle_states = {1, 2, 1};
+    first.current_nodes = {1, 2, 3};
+    first.next_nodes = {2, 3, 4};
+    first.progress_ticks = {0, 4, 7};
+    first.total_ticks = {10, 10, 8};
+    first.destinations = {4, 4, 1};
+    first.intersection_ids = {1};
+    first.green_indices = {0};
+    first.phases = {1};
+    first.ticks_in_state = {3};
+    first.approach_counts = {2};
+    first.approach_ids = {12, 13};
+    first.queue_lengths = {1, 0};
+    first.queued_vehicle_ids = {2};
+
+    // Vehicle 1 leaves, 5 advances, 7 appears
+    TrajectoryFrame second = first;
+    second.tick = 11;
+    second.vehicle_ids = {2, 5, 7};
+    second.vehicle_states = {2, 1, 1};
+    second.current_nodes = {2, 3, 1};
+    second.next_nodes = {3, 4, 3};
+    second.progress_ticks = {4, 8, 0};
+    second.total_ticks = {10, 8, 10};
+    second.destinations = {4, 1, 3};
+    second.queue_lengths = {0, 0};
+    second.queued_vehicle_ids.clear();
+
+    TrajectoryEncoder encoder(2);
+    std::vector<std::uint8_t> bytes;
+    assert(encoder.encode(first, bytes));   // First frame is always a key frame
+    assert(!encoder.encode(second, bytes)); // Then deltas until the interval is reached
+    std::size_t delta_end = bytes.size();
+    assert(encoder.encode(first, bytes));
+
+    TrajectoryDecoder decoder;
+    TrajectoryFrame decoded;
+    std::uint8_t type = 0;
+    const std::uint8_t *cursor = bytes.data();
+    const std::uint8_t *end = bytes.data() + bytes.size();
+    assert(decoder.decode(cursor, end, decoded, type) && type == TrajectoryFormat::FRAME_KEY);
+    assert(frames_equal(decoded, first));
+    assert(decoder.decode(cursor, end, decoded, type) && type == TrajectoryFormat::FRAME_DELTA);
+    assert(frames_equal(decoded, second));
+    assert(cursor == bytes.data() + delta_end);
+    assert(decoder.decode(cursor, end, decoded, type) && frames_equal(decoded, first));
+    assert(cursor == end);
+
+    // A delta frame cannot be decoded without the frame it is relative to
+    TrajectoryDecoder fresh;
+    cursor = bytes.data();
+    assert(fresh.decode(cursor, end, decoded, type)); // Skip the key frame...
+    fresh.reset();
+    assert(!fresh.decode(cursor, end, decoded, type)); // ...then forget it
+    std::cout << "test_codec_round_trip_with_changing_vehicles PASSED." << std::endl;
+}
+
+void test_recorder_writes_decodable_log()
+{
+    std::cout << "Running test_recorder_writes_decodable_log..." << std::endl;
+    const std::string path = "test_temp_trajectory.bin";
+    Simulation sim(5);
+    setup_square_network(sim);
+    Vehicle queued(900, 1, 4);
+    sim.add_vehicle(queued);
+
+    std::map<int, TrajectoryFrame> expected; // Key: tick
+    TrajectoryRecorder recorder;
+    assert(recorder.open(path, 16, 512));
+    const int ticks = 300;
+    for (int t = 0; t < ticks; ++t)
+    {
+        // The second half records from the frame tick() captures itself
+        if (t == ticks / 2)
+            sim.set_frame_capture(true);
+        sim.tick();
+        sim.capture_frame(expected[sim.get_current_tick()]);
+        if (t >= ticks / 2)
+            assert(sim.get_tick_frame() && frames_equal(*sim.get_tick_frame(), expected[sim.get_current_tick()]));
+        recorder.record(sim);
+    }
+    assert(sim.fork().get_tick_frame() == nullptr);
+    recorder.close();
+    assert(!recorder.is_open() && !recorder.has_write_error());
+    assert(recorder.get_frames_written() + recorder.get_frames_dropped() == static_cast<std::size_t>(ticks));
+    assert(recorder.get_frames_written() > 0);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(log.size() == recorder.get_bytes_written());
+    assert(std::memcmp(log.data(), TrajectoryFormat::MAGIC, 8) == 0);
+    assert(std::memcmp(log.data() + log.size() - 8, TrajectoryFormat::TRAILER_MAGIC, 8) == 0);
+
+    const std::uint8_t *cursor = log.data() + 8;
+    const std::uint8_t *end = log.data() + log.size() - TrajectoryFormat::TRAILER_SIZE;
+    std::uint64_t keyframe_interval = 0;
+    assert(Varint::read_unsigned(cursor, end, keyframe_interval) && keyframe_interval == 16);
+
+    TrajectoryDecoder decoder;
+    TrajectoryFrame frame;
+    std::uint8_t type = 0;
+    std::size_t frames = 0, key_frames = 0;
+    bool saw_queue = false;
+    std::vector<std::size_t> key_offsets;
+    while (cursor < end)
+    {
+        std::size_t offset = static_cast<std::size_t>(cursor - log.data());
+        assert(decoder.decode(cursor, end, frame, type));
+        if (type == TrajectoryFormat::FRAME_INDEX)
+            break;
+        frames++;
+        if (type == TrajectoryFormat::FRAME_KEY)
+        {
+            key_frames++;
+            key_offsets.push_back(offset);
+        }
+        assert(frames_equal(frame, expected.at(frame.tick)));
+        saw_queue = saw_queue || !frame.queued_vehicle_ids.empty();
+    }
+    assert(frames == recorder.get_frames_written());
+    assert(key_frames >= frames / 16);
+    assert(saw_queue);
+
+    // The trailer points at the index, which lists every key frame
+    std::uint64_t index_offset = 0;
+    for (int byte = 0; byte < 8; ++byte)
+        index_offset |= static_cast<std::uint64_t>(log[log.size() - 16 + byte]) << (8 * byte);
+    const std::uint8_t *index = log.data() + index_offset;
+    assert(*index++ == TrajectoryFormat::FRAME_INDEX);
+    std::uint64_t payload_size = 0, entries = 0;
+    assert(Varint::read_unsigned(index, end, payload_size));
+    assert(Varint::read_unsigned(index, end, entries) && entries == key_offsets.size());
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < entries; ++i)
+    {
+        std::int64_t tick_delta = 0;
+        std::uint64_t offset_delta = 0;
+        assert(Varint::read_signed(index, end, tick_delta) && Varint::read_unsigned(index, end, offset_delta));
+        offset += offset_delta;
+        assert(offset == key_offsets[i]);
+    }
+
+    // A full ring drops frames instead of blocking the caller
+    TrajectoryRecorder tiny;
+    assert(tiny.open(path, 16, 1));
+    for (int i = 0; i < 200; ++i)
+        tiny.record(sim);
+    tiny.close();
+    assert(tiny.get_frames_written() + tiny.get_frames_dropped() == 200);
+
+    std::remove(path.c_str());
+    std::cout << "test_recorder_writes_decodable_log PASSED." << std::endl;
+}
+
+void test_replay_seeks_recorded_run()
+{
+    std::cout << "Running test_replay_seeks_recorded_run..." << std::endl;
+    const std::string path = "test_temp_replay.bin";
+    Simulation sim(9);
+    setup_square_network(sim);
+    sim.add_vehicle(Vehicle(900, 1, 4));
+
+    std::map<int, TrajectoryFrame> expected; // Key: tick
+    std::map<int, std::map<int, Vehicle>> expected_vehicles;
+    TrajectoryRecorder recorder;
+    assert(recorder.open(path, 10, 512));
+    for (int t = 0; t < 250; ++t)
+    {
+        sim.tick();
+        sim.capture_frame(expected[sim.get_current_tick()]);
+        if (sim.get_current_tick() % 50 == 7)
+            expected_vehicles[sim.get_current_tick()] = sim.get_vehicles();
+        assert(recorder.record(sim));
+    }
+    recorder.close();
+    assert(recorder.get_frames_dropped() == 0);
+
+    TrajectoryReplay replay;
+    assert(replay.open(path) && replay.has_stored_index());
+    assert(replay.get_first_tick() == 1 && replay.get_last_tick() == 250);
+    assert(replay.get_keyframe_interval() == 10 && replay.get_keyframe_count() == 25);
+    assert(replay.get_current_tick() == 1 && frames_equal(replay.get_frame(), expected.at(1)));
+
+    // Backwards, forwards within a key-frame interval, across intervals, and out of range
+    for (int tick : {200, 37, 39, 38, 120, 250, 1, 999, -5})
+    {
+        assert(replay.seek(tick));
+        int clamped = tick < 1 ? 1 : (tick > 250 ? 250 : tick);
+        assert(replay.get_current_tick() == clamped);
+        assert(frames_equal(replay.get_frame(), expected.at(clamped)));
+    }
+    assert(replay.step() && replay.get_current_tick() == 2);
+    assert(replay.seek(250) && !replay.step() && replay.get_current_tick() == 250);
+
+    // The Simulation-style accessors reproduce what the simulation held at that tick
+    const SimulationView &view = replay;
+    for (const auto &entry : expected_vehicles)
+    {
+        assert(replay.seek(entry.first));
+        const std::map<int, Vehicle> &vehicles = view.get_vehicles();
+        assert(vehicles.size() == entry.second.size());
+        for (const auto &pair : entry.second)
+        {
+            const Vehicle &replayed = vehicles.at(pair.first);
+            assert(replayed.get_state() == pair.second.get_state());
+            assert(replayed.get_current_node_id() == pair.second.get_current_node_id());
+            assert(replayed.get_next_node_id() == pair.second.get_next_node_id());
+            assert(replayed.get_current_edge_progress_ticks() == pair.second.get_current_edge_progress_ticks());
+            assert(replayed.get_destination_node_id() == pair.second.get_destination_node_id());
+        }
+        TrajectoryFrame from_views;
+        const TrajectoryFrame &recorded = expected.at(entry.first);
+        for (const auto &pair : view.get_intersections())
+        {
+            const Intersection &intersection = pair.second;
+            from_views.green_indices.push_back(intersection.get_current_green_approach_index());
+            from_views.phases.push_back(static_cast<std::uint8_t>(intersection.get_phase_state()));
+            for (int approach_id : intersection.get_approach_ids())
+                intersection.append_queued_vehicle_ids(approach_id, from_views.queued_vehicle_ids);
+            if (intersection.get_phase_state() != LightState::RED)
+            {
+                int green = intersection.get_approach_ids()[intersection.get_current_green_approach_index()];
+                assert(intersection.get_signal_state(green) == intersection.get_phase_state());
+            }
+        }
+        assert(from_views.green_indices == recorded.green_indices && from_views.phases == recorded.phases);
+        assert(from_views.queued_vehicle_ids == recorded.queued_vehicle_ids);
+    }
+
+    // Without the index and trailer (recording cut short) the index is rebuilt by scanning
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+    truncated.write(log.data(), static_cast<std::streamsize>(log.size() * 2 / 3)); // Ends mid-frame
+    truncated.close();
+    assert(replay.open(path) && !replay.has_stored_index());
+    int last = replay.get_last_tick();
+    assert(replay.get_keyframe_count() > 0 && last > 20 && last < 250);
+    assert(replay.seek(last - 15) && frames_equal(replay.get_frame(), expected.at(last - 15)));
+    assert(replay.seek(last + 15) && frames_equal(replay.get_frame(), expected.at(last)));
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a log";
+    assert(!replay.open(path) && !replay.is_open());
+
+    std::remove(path.c_str());
+    std::cout << "test_replay_seeks_recorded_run PASSED." << std::endl;
+}
+
+int main()
+{
+    std::cout << "Starting Trajectory tests (test_trajectory.cpp)..." << std::endl;
+    test_codec_round_trip_with_changing_vehicles();
+    test_recorder_writes_decodable_log();
+    test_replay_seeks_recorded_run();
+    std::cout << "All Trajectory tests PASSED." << std::endl;
+    return 0;
+}
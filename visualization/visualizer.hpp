@@ -2,24 +2,76 @@
 #define VISUALIZER_HPP
 
 #include <SFML/Graphics.hpp>
-#include "simulation.hpp"
+#include <vector>
+#include "render_style.hpp"
+#include "simulation_thread.hpp"
+#include "simulation_view.hpp"
+#include "spatial_grid.hpp"
+#include "triple_buffer.hpp"
 
+// Draws the network, signals and vehicles in a pannable, zoomable view. Only what is on
+// screen is drawn (found through a SpatialGrid), and detail too small to see is
+// replaced: nodes and signals are dropped, and vehicles give way to a per-edge density
+// heat map. Frame cost follows the visible content, not the size of the network.
 class Visualizer
 {
 public:
     Visualizer(const Graph &graph);
-    void draw(sf::RenderWindow &window, const Simulation &sim);
+    // Draws the state exactly as it is (used for replays)
+    void draw(sf::RenderWindow &window, const SimulationView &sim);
+    // Draws the latest snapshot published by a SimulationThread, without ever waiting for
+    // it. Vehicles are interpolated between the two latest snapshots, so motion stays
+    // smooth when the simulation ticks slower than the frame rate.
+    void draw(sf::RenderWindow &window, TripleBuffer<StateSnapshot> &snapshots);
+
+    // Camera controls: drag with the left mouse button to pan, scroll to zoom around the
+    // cursor, Home to show the whole network again. Other events are ignored.
+    void handle_event(sf::RenderWindow &window, const sf::Event &event);
+    // Shows the whole network in the window
+    void fit_view(sf::RenderWindow &window);
 
 private:
-    void draw_edges(sf::RenderWindow &window);
-    void draw_nodes(sf::RenderWindow &window);
-    void draw_vehicles(sf::RenderWindow &window, const Simulation &sim);
-    void draw_intersections(sf::RenderWindow &window, const Simulation &sim);
-    void draw_hud(sf::RenderWindow &window, const Simulation &sim);
+    // Fills static_vertices_ (roads, then nodes) and uploads it to static_buffer_
+    void build_static_geometry();
+    // Part of the map in the view, widened by the largest shape radius
+    BoundingBox visible_area() const;
+    // Draws the roads (and nodes when `with_nodes`) in `area`; whole_network uses the static buffer
+    void draw_roads_and_nodes(sf::RenderWindow &window, const BoundingBox &area, bool whole_network, bool with_nodes);
+    // Append to dynamic_vertices_; `previous` is nullptr when positions are not interpolated
+    void append_vehicles(const StateSnapshot &current, const StateSnapshot *previous, float alpha,
+                         const BoundingBox &area);
+    void append_density(const StateSnapshot &snapshot, const BoundingBox &area, float pixels_per_unit);
+    void append_intersections(const StateSnapshot &snapshot, bool whole_network);
+    // Everything except the HUD, in a few draw calls
+    void draw_snapshot(sf::RenderWindow &window, const StateSnapshot &current, const StateSnapshot *previous,
+                       float alpha);
+    void draw_hud(sf::RenderWindow &window, const StateSnapshot &snapshot);
 
     const Graph &graph_;
+    SpatialGrid grid_;
     sf::Font font_;
-    std::vector<sf::CircleShape> node_shapes_;
+    // Roads and nodes never change: built once, kept on the GPU when vertex buffers are
+    // available (static_vertices_ is drawn from the CPU otherwise). Edge i's road is
+    // vertices [i * ROAD_VERTICES, ...), then node j's disk follows all the roads.
+    std::vector<sf::Vertex> static_vertices_;
+    sf::VertexBuffer static_buffer_;
+    bool use_static_buffer_;
+    std::vector<sf::Vector2f> road_ends_; // Start and end of edge i at 2i and 2i + 1
+    // Signals and vehicles (and culled roads), rewritten every frame into the same storage
+    std::vector<sf::Vertex> dynamic_vertices_;
+    std::vector<int> visible_edges_;
+    std::vector<int> visible_nodes_;
+    std::vector<int> edge_loads_; // Vehicles per edge index for the density map; all zero between frames
+
+    sf::View view_;     // Map camera
+    sf::View hud_view_; // Window pixels
+    bool view_ready_;   // fit_view() has run
+    bool dragging_;
+    sf::Vector2i drag_last_; // Pixel
+
+    StateSnapshot scratch_;  // Capture of a SimulationView being drawn
+    StateSnapshot current_;  // Latest snapshot taken from a SimulationThread
+    StateSnapshot previous_; // The one before it, for interpolation
 };
 
 #endif // VISUALIZER_HPP
\ No newline at end of file